@@ -0,0 +1,502 @@
+//>=------------------------------------------------------------------------=<//
+// file:    AllocationProfiler.cpp
+// author:  Tristan Baskerville
+// course:  CS280
+// brief:
+//   This file contains the implementation for the AllocationProfiler class
+//   and the HeapSnapshot reports it produces.
+//
+// Copyright © 2020 DigiPen, All rights reserved.
+//>=------------------------------------------------------------------------=<//
+
+#include "AllocationProfiler.h"
+#include <algorithm> // std::sort
+#include <cstdlib>   // std::free
+#include <iomanip>   // std::setw
+#include <thread>    // std::this_thread
+
+#if defined(_WIN32)
+  #include <windows.h>
+#else
+  #include <execinfo.h>
+#endif
+
+namespace
+{
+  //  source of the profiler ids, 0 is never handed out
+  std::atomic<unsigned long long> profilerIds{ 0 };
+
+  //  fills frames with return addresses, returns how many were captured
+  unsigned captureStack(void** frames, unsigned maxFrames)
+  {
+    //  this function and sampleAllocate are never interesting
+    const unsigned skip = 2;
+    void* buffer[AllocationProfiler::MAX_FRAMES + skip];
+
+#if defined(_WIN32)
+    unsigned depth = RtlCaptureStackBackTrace(0, maxFrames + skip,
+                                              buffer, nullptr);
+#else
+    int captured = backtrace(buffer, static_cast<int>(maxFrames + skip));
+    unsigned depth = captured > 0 ? static_cast<unsigned>(captured) : 0;
+#endif
+
+    if (depth <= skip) return 0;
+    depth -= skip;
+    std::copy(buffer + skip, buffer + skip + depth, frames);
+    return depth;
+  }
+
+  //  FNV-1a over the return addresses
+  size_t hashFrames(void* const* frames, unsigned depth)
+  {
+    unsigned long long hash = 14695981039346656037ull;
+    for (unsigned i = 0; i < depth; ++i)
+    {
+      hash ^= reinterpret_cast<std::uintptr_t>(frames[i]);
+      hash *= 1099511628211ull;
+    }
+    return static_cast<size_t>(hash);
+  }
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      ctor for an AllocationProfiler instance
+    \param _sampleInterval
+      mean number of allocations between two samples
+    \param _ringSize
+      events each thread can buffer between snapshots
+*/
+//>=------------------------------------------------------------------------=<//
+AllocationProfiler::AllocationProfiler(unsigned _sampleInterval,
+  unsigned _ringSize) :
+  id_(++profilerIds),
+  interval_(_sampleInterval ? _sampleInterval : 1),
+  ringMask_([_ringSize]()
+  {
+    size_t size = 2;
+    while (size < _ringSize) size <<= 1;
+    return size - 1;
+  }()),
+  start_(std::chrono::steady_clock::now()),
+  filter_(new std::atomic<std::uint16_t>[FILTER_SIZE])
+{
+  for (unsigned i = 0; i < FILTER_SIZE; ++i)
+    filter_[i].store(0, std::memory_order_relaxed);
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      destructor for an AllocationProfiler instance
+*/
+//>=------------------------------------------------------------------------=<//
+AllocationProfiler::~AllocationProfiler() = default;
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Drains the events of every thread and aggregates them per call site.
+      Events are applied in the order they happened across threads. A free
+      that arrives before its allocation was drained is kept for one more
+      snapshot before being dropped as a false positive of the filter.
+    \return
+      Current heap profile
+*/
+//>=------------------------------------------------------------------------=<//
+HeapSnapshot AllocationProfiler::Snapshot()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  HeapSnapshot snapshot;
+  snapshot.SampleInterval_ = interval_;
+  snapshot.Seconds_ = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start_).count();
+
+  //  frees that were orphaned last time get one more chance
+  std::vector<Event> events;
+  events.swap(orphans_);
+  const size_t retries = events.size();
+  std::vector<const void*> retried;
+  retried.reserve(retries);
+  for (const Event& ev : events)
+    retried.push_back(ev.Block);
+
+  for (auto& buffer : buffers_)
+  {
+    snapshot.Allocations_ += buffer->Allocations.load(std::memory_order_relaxed);
+    snapshot.Frees_ += buffer->Frees.load(std::memory_order_relaxed);
+    snapshot.BytesAllocated_ += buffer->Bytes.load(std::memory_order_relaxed);
+    snapshot.Dropped_ += buffer->Dropped.load(std::memory_order_relaxed);
+
+    //  the acquire pairs with the release in the producer's publish
+    size_t tail = buffer->Tail.load(std::memory_order_relaxed);
+    size_t head = buffer->Head.load(std::memory_order_acquire);
+    for (; tail != head; ++tail)
+      events.push_back(buffer->Ring[tail & ringMask_]);
+    buffer->Tail.store(tail, std::memory_order_release);
+  }
+
+  std::sort(events.begin(), events.end(),
+    [](const Event& lhs, const Event& rhs)
+    {
+      return lhs.Sequence < rhs.Sequence;
+    });
+
+  for (const Event& ev : events)
+  {
+    if (applyEvent(ev)) continue;
+
+    //  drop frees that already waited a whole snapshot
+    bool wasRetried = std::find(retried.begin(), retried.end(), ev.Block)
+                      != retried.end();
+    if (not wasRetried)
+      orphans_.push_back(ev);
+  }
+
+  //  scale the samples back up to estimates
+  for (const auto& [id, record] : sites_)
+  {
+    AllocationSite site;
+    site.Id_ = id;
+    site.Frames_ = record.Frames;
+    site.Allocations_ = record.Samples * interval_;
+    site.LiveObjects_ = static_cast<long long>(record.Live * interval_);
+    site.LiveBytes_ = static_cast<long long>(record.LiveSize * interval_);
+    snapshot.Sites_.push_back(std::move(site));
+  }
+
+  std::sort(snapshot.Sites_.begin(), snapshot.Sites_.end(),
+    [](const AllocationSite& lhs, const AllocationSite& rhs)
+    {
+      return lhs.LiveBytes_ > rhs.LiveBytes_;
+    });
+
+  return snapshot;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Creates a buffer for the calling thread, or finds the one it was
+      given before switching to another profiler
+    \return
+      buffer owned by this profiler for the calling thread
+*/
+//>=------------------------------------------------------------------------=<//
+AllocationProfiler::ThreadBuffer& AllocationProfiler::registerThread()
+{
+  //  a thread only registers once per profiler, so a linear search over the
+  //  owners is fine here
+  static thread_local std::vector<std::pair<unsigned long long,
+                                            ThreadBuffer*>> owned;
+  for (auto& [owner, buffer] : owned)
+    if (owner == id_)
+      return *buffer;
+
+  auto buffer = std::make_unique<ThreadBuffer>();
+  buffer->Ring.reset(new Event[ringMask_ + 1]);
+  buffer->Random = static_cast<std::uint32_t>(
+    std::hash<std::thread::id>()(std::this_thread::get_id())) | 1u;
+  buffer->Countdown = nextCountdown(*buffer);
+
+  ThreadBuffer* result = buffer.get();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffers_.push_back(std::move(buffer));
+  }
+
+  owned.emplace_back(id_, result);
+  return *result;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Captures the call stack of a sampled allocation and pushes it onto the
+      thread's ring. The block is added to the free filter so its free will
+      be recorded too.
+    \param _buffer
+      calling thread's buffer
+    \param _block
+      block given to the client
+    \param _size
+      size of the block
+*/
+//>=------------------------------------------------------------------------=<//
+void AllocationProfiler::sampleAllocate(ThreadBuffer& _buffer,
+  const void* _block, size_t _size)
+{
+  _buffer.Countdown = nextCountdown(_buffer);
+
+  Event* ev = reserveEvent(_buffer);
+  if (ev == nullptr) return;
+
+  ev->Block = _block;
+  ev->Size = _size;
+  ev->Type = Event::evAllocate;
+  ev->Depth = captureStack(ev->Frames, MAX_FRAMES);
+  ev->Sequence = sequence_.fetch_add(1, std::memory_order_relaxed);
+  filter_[filterIndex(_block)].fetch_add(1, std::memory_order_relaxed);
+
+  //  publish the slot to Snapshot
+  _buffer.Head.store(_buffer.Head.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_release);
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Pushes a free event onto the thread's ring. Snapshot ignores it if the
+      block turns out to not have been sampled.
+    \param _buffer
+      calling thread's buffer
+    \param _block
+      block returned by the client
+    \param _size
+      size of the block
+*/
+//>=------------------------------------------------------------------------=<//
+void AllocationProfiler::recordFree(ThreadBuffer& _buffer,
+  const void* _block, size_t _size)
+{
+  Event* ev = reserveEvent(_buffer);
+  if (ev == nullptr) return;
+
+  ev->Block = _block;
+  ev->Size = _size;
+  ev->Type = Event::evFree;
+  ev->Depth = 0;
+  ev->Sequence = sequence_.fetch_add(1, std::memory_order_relaxed);
+
+  //  publish the slot to Snapshot
+  _buffer.Head.store(_buffer.Head.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_release);
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Returns the next free slot of the thread's ring without publishing it
+    \param _buffer
+      calling thread's buffer
+    \return
+      slot to fill in, or null (and counted as dropped) if the ring is full
+*/
+//>=------------------------------------------------------------------------=<//
+AllocationProfiler::Event* AllocationProfiler::reserveEvent(
+  ThreadBuffer& _buffer)
+{
+  size_t head = _buffer.Head.load(std::memory_order_relaxed);
+  size_t tail = _buffer.Tail.load(std::memory_order_acquire);
+
+  //  never block the allocating thread, lose the event instead
+  if (head - tail > ringMask_)
+  {
+    _buffer.Dropped.store(_buffer.Dropped.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  return &_buffer.Ring[head & ringMask_];
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Picks a random number of allocations in [1, 2 * interval) so that the
+      average distance between samples is the interval
+    \param _buffer
+      buffer holding the random state
+    \return
+      allocations until the next sample
+*/
+//>=------------------------------------------------------------------------=<//
+long long AllocationProfiler::nextCountdown(ThreadBuffer& _buffer) const
+{
+  if (interval_ == 1) return 1;
+
+  //  xorshift32
+  std::uint32_t x = _buffer.Random;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  _buffer.Random = x;
+
+  return 1 + static_cast<long long>(x % (2ull * interval_ - 1));
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Applies a drained event to the site and live sample tables
+    \param _ev
+      event to apply
+    \return
+      false for a free of a block that isn't a live sample
+*/
+//>=------------------------------------------------------------------------=<//
+bool AllocationProfiler::applyEvent(const Event& _ev)
+{
+  //  free event
+  if (_ev.Type == Event::evFree)
+  {
+    auto it = live_.find(_ev.Block);
+    if (it == live_.end()) return false;
+
+    SiteRecord& site = sites_[it->second.Site];
+    site.Live -= 1;
+    site.LiveSize -= it->second.Size;
+    live_.erase(it);
+    filter_[filterIndex(_ev.Block)].fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  //  allocation event
+  size_t id = hashFrames(_ev.Frames, _ev.Depth);
+  SiteRecord& site = sites_[id];
+  if (site.Frames.empty())
+    site.Frames.assign(_ev.Frames, _ev.Frames + _ev.Depth);
+  site.Samples += 1;
+  site.Live += 1;
+  site.LiveSize += _ev.Size;
+
+  //  a missed free (dropped event) leaves a stale sample at this address
+  auto [it, inserted] = live_.try_emplace(_ev.Block, LiveSample{ id, _ev.Size });
+  if (not inserted)
+  {
+    SiteRecord& stale = sites_[it->second.Site];
+    stale.Live -= 1;
+    stale.LiveSize -= it->second.Size;
+    filter_[filterIndex(_ev.Block)].fetch_sub(1, std::memory_order_relaxed);
+    it->second = LiveSample{ id, _ev.Size };
+  }
+
+  return true;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Maps a block to a counter of the free filter. The low bits are
+      dropped since blocks are at least pointer aligned.
+    \param _block
+      block address
+    \return
+      index into the filter
+*/
+//>=------------------------------------------------------------------------=<//
+size_t AllocationProfiler::filterIndex(const void* _block)
+{
+  std::uintptr_t value = reinterpret_cast<std::uintptr_t>(_block) >> 3;
+  value ^= value >> 14;
+  return static_cast<size_t>(value & (FILTER_SIZE - 1));
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Computes the change between two snapshots of the same profiler
+    \param _older
+      snapshot taken first
+    \param _newer
+      snapshot taken second
+    \return
+      Snapshot of deltas, sites sorted by growth in live bytes
+*/
+//>=------------------------------------------------------------------------=<//
+HeapSnapshot HeapSnapshot::Diff(const HeapSnapshot& _older,
+  const HeapSnapshot& _newer)
+{
+  HeapSnapshot diff;
+  diff.Seconds_ = _newer.Seconds_ - _older.Seconds_;
+  diff.SampleInterval_ = _newer.SampleInterval_;
+  diff.Allocations_ = _newer.Allocations_ - _older.Allocations_;
+  diff.Frees_ = _newer.Frees_ - _older.Frees_;
+  diff.BytesAllocated_ = _newer.BytesAllocated_ - _older.BytesAllocated_;
+  diff.Dropped_ = _newer.Dropped_ - _older.Dropped_;
+
+  std::unordered_map<size_t, const AllocationSite*> older;
+  for (const AllocationSite& site : _older.Sites_)
+    older.emplace(site.Id_, &site);
+
+  for (const AllocationSite& site : _newer.Sites_)
+  {
+    AllocationSite delta = site;
+    auto it = older.find(site.Id_);
+    if (it != older.end())
+    {
+      delta.Allocations_ -= it->second->Allocations_;
+      delta.LiveObjects_ -= it->second->LiveObjects_;
+      delta.LiveBytes_ -= it->second->LiveBytes_;
+      older.erase(it);
+    }
+    diff.Sites_.push_back(std::move(delta));
+  }
+
+  //  sites that disappeared entirely shrank by everything they had
+  for (const auto& [id, site] : older)
+  {
+    AllocationSite delta = *site;
+    delta.Allocations_ = 0;
+    delta.LiveObjects_ = -site->LiveObjects_;
+    delta.LiveBytes_ = -site->LiveBytes_;
+    diff.Sites_.push_back(std::move(delta));
+  }
+
+  std::sort(diff.Sites_.begin(), diff.Sites_.end(),
+    [](const AllocationSite& lhs, const AllocationSite& rhs)
+    {
+      return lhs.LiveBytes_ > rhs.LiveBytes_;
+    });
+
+  return diff;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Writes the totals followed by the sites with the most live bytes
+    \param _os
+      stream to write to
+    \param _maxSites
+      number of sites to write
+*/
+//>=------------------------------------------------------------------------=<//
+void HeapSnapshot::Write(std::ostream& _os, unsigned _maxSites) const
+{
+  double rate = Seconds_ > 0 ? Allocations_ / Seconds_ : 0;
+
+  _os << "heap snapshot @ " << Seconds_ << "s (1 in " << SampleInterval_
+      << " sampled)\n"
+      << "  allocations " << Allocations_ << ", frees " << Frees_
+      << ", bytes " << BytesAllocated_ << ", " << rate << " allocs/s\n";
+  if (Dropped_)
+    _os << "  dropped events " << Dropped_ << "\n";
+
+  unsigned count = 0;
+  for (const AllocationSite& site : Sites_)
+  {
+    if (count++ == _maxSites) break;
+
+    _os << std::setw(12) << site.LiveBytes_ << " bytes live in "
+        << site.LiveObjects_ << " objects ("
+        << site.Allocations_ << " allocations)\n";
+
+#if defined(_WIN32)
+    for (void* frame : site.Frames_)
+      _os << "      " << frame << "\n";
+#else
+    char** symbols = backtrace_symbols(site.Frames_.data(),
+                                       static_cast<int>(site.Frames_.size()));
+    for (size_t i = 0; i < site.Frames_.size(); ++i)
+    {
+      if (symbols) _os << "      " << symbols[i] << "\n";
+      else         _os << "      " << site.Frames_[i] << "\n";
+    }
+    std::free(symbols);
+#endif
+  }
+}
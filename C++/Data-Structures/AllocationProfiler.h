@@ -0,0 +1,272 @@
+//>=------------------------------------------------------------------------=<//
+// file:    AllocationProfiler.h
+// author:  Tristan Baskerville
+// course:  CS280
+// brief:
+//   This file contains the interface for the AllocationProfiler class, a
+//   low overhead sampling profiler that can be attached to an allocator.
+//
+//   Every thread reporting to the profiler gets its own buffer:
+//     + allocation/free/byte counters, written only by that thread
+//     + a single-producer ring of sampled events, drained by Snapshot()
+//
+//   Roughly 1 in SampleInterval allocations (randomized to avoid aliasing
+//   with allocation patterns) captures a call stack. Frees are only
+//   recorded when a counting filter says the block may have been sampled,
+//   so the common case on both paths is a few thread-local increments.
+//
+//   Snapshot() aggregates the samples into live bytes per call site.
+//   Snapshots can be diffed to find sites that keep growing.
+//
+// Copyright © 2020 DigiPen, All rights reserved.
+//>=------------------------------------------------------------------------=<//
+
+#ifndef ALLOCATIONPROFILERH
+#define ALLOCATIONPROFILERH
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+/*!
+  Statistics of a single call site, scaled from the samples taken there
+*/
+struct AllocationSite
+{
+  size_t Id_;                            //!< hash of the call stack
+  std::vector<void*> Frames_;            //!< return addresses, innermost first
+  unsigned long long Allocations_;       //!< estimated allocations made here
+  long long LiveObjects_;                //!< estimated objects still live
+  long long LiveBytes_;                  //!< estimated bytes still live
+};
+
+/*!
+  Heap profile at a point in time
+*/
+struct HeapSnapshot
+{
+  //! Default constructor
+  HeapSnapshot() : Seconds_(0), SampleInterval_(0), Allocations_(0),
+    Frees_(0), BytesAllocated_(0), Dropped_(0) {}
+
+  double Seconds_;                  //!< time since the profiler was created
+  unsigned SampleInterval_;         //!< mean allocations between samples
+  unsigned long long Allocations_;  //!< exact allocations, all threads
+  unsigned long long Frees_;        //!< exact frees, all threads
+  unsigned long long BytesAllocated_; //!< exact bytes allocated, all threads
+  unsigned long long Dropped_;      //!< events lost because a ring was full
+  std::vector<AllocationSite> Sites_; //!< sorted by live bytes, largest first
+
+  // Changes from Older to Newer. Counters and live values become deltas,
+  // Seconds_ becomes the time between the two snapshots.
+  static HeapSnapshot Diff(const HeapSnapshot& Older,
+                           const HeapSnapshot& Newer);
+
+  // Writes a human readable report, symbolized where the platform allows
+  void Write(std::ostream& os, unsigned MaxSites = 20) const;
+};
+
+/*!
+  Sampling allocation profiler
+*/
+class AllocationProfiler
+{
+public:
+  //! deepest call stack captured for a sample
+  static const unsigned MAX_FRAMES = 16;
+
+  // SampleInterval is the mean number of allocations between two samples.
+  // RingSize is the number of events each thread can buffer between two
+  // calls to Snapshot, rounded up to a power of two.
+  AllocationProfiler(unsigned SampleInterval = 4096, unsigned RingSize = 1024);
+
+  // Frees every thread buffer. Allocators must stop reporting first.
+  ~AllocationProfiler();
+
+  // Called by an allocator after each successful allocation
+  inline void OnAllocate(const void* Block, size_t Size);
+
+  // Called by an allocator before each free
+  inline void OnFree(const void* Block, size_t Size);
+
+  // Drains every thread buffer and returns the current profile
+  HeapSnapshot Snapshot();
+
+  //! Do not implement!
+  AllocationProfiler(const AllocationProfiler&) = delete;
+  //! Do not implement!
+  AllocationProfiler& operator=(const AllocationProfiler&) = delete;
+
+private:
+  //! number of counters in the free filter
+  static const unsigned FILTER_SIZE = 1u << 14;
+
+  /*!
+    Sampled allocation, or free of a block that may have been sampled
+  */
+  struct Event
+  {
+    //! what happened to the block, a stack can be empty either way
+    enum EVENT_TYPE { evAllocate, evFree };
+
+    const void* Block;           //!< address of the block
+    size_t Size;                 //!< size of the block
+    unsigned long long Sequence; //!< orders events across threads
+    EVENT_TYPE Type;             //!< allocation or free
+    unsigned Depth;              //!< frames captured by an allocation
+    void* Frames[MAX_FRAMES];    //!< call stack of an allocation
+  };
+
+  /*!
+    Written by one thread, read by whoever calls Snapshot
+  */
+  struct ThreadBuffer
+  {
+    std::atomic<unsigned long long> Allocations{ 0 }; //!< exact count
+    std::atomic<unsigned long long> Frees{ 0 };       //!< exact count
+    std::atomic<unsigned long long> Bytes{ 0 };       //!< exact bytes
+    std::atomic<unsigned long long> Dropped{ 0 };     //!< ring was full
+    std::atomic<size_t> Head{ 0 };  //!< next slot written by the thread
+    std::atomic<size_t> Tail{ 0 };  //!< next slot read by Snapshot
+    std::unique_ptr<Event[]> Ring;  //!< event storage
+    long long Countdown{ 0 };       //!< allocations until the next sample
+    std::uint32_t Random{ 0 };      //!< xorshift state for the countdown
+  };
+
+  /*!
+    Sample still live at the last Snapshot
+  */
+  struct LiveSample
+  {
+    size_t Site;                 //!< id of the site it was allocated at
+    size_t Size;                 //!< size of the block
+  };
+
+  /*!
+    Aggregated samples of a call site
+  */
+  struct SiteRecord
+  {
+    std::vector<void*> Frames;   //!< call stack
+    unsigned long long Samples;  //!< allocations sampled here
+    unsigned long long Live;     //!< samples still live
+    unsigned long long LiveSize; //!< bytes of the live samples
+  };
+
+  const unsigned long long id_; //!< unique id, used to find thread buffers
+  const unsigned interval_;     //!< mean allocations between samples
+  const size_t ringMask_;       //!< ring size - 1
+  const std::chrono::steady_clock::time_point start_; //!< creation time
+
+  std::atomic<unsigned long long> sequence_{ 0 };    //!< event ordering
+  std::unique_ptr<std::atomic<std::uint16_t>[]> filter_; //!< sampled blocks
+
+  std::mutex mutex_; //!< guards everything below, never taken on hot path
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+  std::unordered_map<size_t, SiteRecord> sites_;
+  std::unordered_map<const void*, LiveSample> live_;
+  std::vector<Event> orphans_; //!< frees seen before their allocation
+
+  //>=------------------------=<//
+  //>=--  Helper functions  --=<//
+  //>=------------------------=<//
+
+  // Returns the calling thread's buffer, registering it if needed
+  inline ThreadBuffer& threadBuffer();
+  // Creates and registers a buffer for the calling thread
+  ThreadBuffer& registerThread();
+  // Captures the stack and pushes an allocation event
+  void sampleAllocate(ThreadBuffer& Buffer, const void* Block, size_t Size);
+  // Pushes a free event for a block that may have been sampled
+  void recordFree(ThreadBuffer& Buffer, const void* Block, size_t Size);
+  // Reserves the next ring slot, or null if the ring is full
+  Event* reserveEvent(ThreadBuffer& Buffer);
+  // Picks the number of allocations until the next sample
+  long long nextCountdown(ThreadBuffer& Buffer) const;
+  // Applies one drained event to the aggregated tables
+  bool applyEvent(const Event& Ev);
+
+  // Counter in the free filter a block maps to
+  static size_t filterIndex(const void* Block);
+};
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Counts an allocation, sampling it once the thread's countdown ends
+    \param _block
+      block given to the client
+    \param _size
+      size of the block
+*/
+//>=------------------------------------------------------------------------=<//
+inline void AllocationProfiler::OnAllocate(const void* _block, size_t _size)
+{
+  ThreadBuffer& buffer = threadBuffer();
+
+  //  only this thread writes these, so a relaxed load/store is enough
+  buffer.Allocations.store(
+    buffer.Allocations.load(std::memory_order_relaxed) + 1,
+    std::memory_order_relaxed);
+  buffer.Bytes.store(
+    buffer.Bytes.load(std::memory_order_relaxed) + _size,
+    std::memory_order_relaxed);
+
+  if (--buffer.Countdown <= 0)
+    sampleAllocate(buffer, _block, _size);
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Counts a free, recording it if the block may have been sampled
+    \param _block
+      block returned by the client
+    \param _size
+      size of the block
+*/
+//>=------------------------------------------------------------------------=<//
+inline void AllocationProfiler::OnFree(const void* _block, size_t _size)
+{
+  ThreadBuffer& buffer = threadBuffer();
+
+  buffer.Frees.store(buffer.Frees.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_relaxed);
+
+  if (filter_[filterIndex(_block)].load(std::memory_order_relaxed) != 0)
+    recordFree(buffer, _block, _size);
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Returns the calling thread's buffer. The last profiler used by the
+      thread is cached, so the lookup is two thread-local loads.
+    \return
+      buffer owned by this profiler for the calling thread
+*/
+//>=------------------------------------------------------------------------=<//
+inline AllocationProfiler::ThreadBuffer& AllocationProfiler::threadBuffer()
+{
+  struct Cache
+  {
+    unsigned long long owner; //!< id of the profiler the buffer belongs to
+    ThreadBuffer* buffer;     //!< buffer of the calling thread
+  };
+  static thread_local Cache cache = { 0, nullptr };
+
+  if (cache.owner != id_)
+  {
+    cache.buffer = &registerThread();
+    cache.owner = id_;
+  }
+
+  return *cache.buffer;
+}
+
+#endif
@@ -0,0 +1,449 @@
+//>=------------------------------------------------------------------------=<//
+// file:    ConcurrentObjectAllocator.cpp
+// author:  Tristan Baskerville
+// course:  CS280
+// brief:
+//   This file contains the implementation for the ConcurrentObjectAllocator
+//   class.
+//
+// Copyright © 2020 DigiPen, All rights reserved.
+//>=------------------------------------------------------------------------=<//
+
+#include "ConcurrentObjectAllocator.h"
+#include "PageSource.h"
+#include <new>    // std::bad_alloc
+#include <thread> // std::this_thread::yield
+
+namespace
+{
+  // const value for sizeof(void*);
+  constexpr size_t ptrSize = sizeof(void*);
+  //  user space addresses fit in 48 bits on 64-bit targets, the rest of
+  //  the word holds the counter. 32-bit targets get a 32-bit counter.
+  constexpr unsigned pointerBits = ptrSize == 8 ? 48 : 32;
+  constexpr std::uint64_t pointerMask = (std::uint64_t(1) << pointerBits) - 1;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      ctor for a ConcurrentObjectAllocator instance
+    \param _objectSize
+      size of the objects to allocate
+    \param _config
+      configuration to use, only the page settings and DebugOn_ are used
+*/
+//>=------------------------------------------------------------------------=<//
+ConcurrentObjectAllocator::ConcurrentObjectAllocator(size_t _objectSize,
+  const OAConfig& _config) :
+  freelist_(0),
+  pagelist_(nullptr),
+  pages_(0),
+  growing_(false),
+  mostObjects_(0),
+  config_(_config),
+  objectSize_(_objectSize),
+  blockOffset_(0),
+  pageSize_(0),
+  pageSource_(config_.PageSource_ ? config_.PageSource_ : PageSource::Heap()),
+  slots_()
+{
+  //  every block holds a freelist pointer, so blocks keep its alignment
+  size_t align = alignof(GenericObject);
+  blockOffset_ = _objectSize < sizeof(GenericObject) ? sizeof(GenericObject)
+               : (_objectSize + align - 1) / align * align;
+  pageSize_ = ptrSize + config_.ObjectsPerPage_ * blockOffset_;
+
+  //  only allocate page if not using new/delete
+  if (not config_.UseCPPMemManager_)
+  {
+    if (not pageSource_->Reserve(pageSize_, config_.MaxPages_))
+      throw OAException(OAException::E_NO_MEMORY, "Page source unavailable");
+
+    GenericObject* first = allocatePage();
+    pushFreelist(first, first);
+  }
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      destructor for a ConcurrentObjectAllocator instance
+*/
+//>=------------------------------------------------------------------------=<//
+ConcurrentObjectAllocator::~ConcurrentObjectAllocator()
+{
+  GenericObject* page = pagelist_.load(std::memory_order_acquire);
+  while (page)
+  {
+    GenericObject* next = page->Next;
+    pageSource_->ReleasePage(page, pageSize_);
+    page = next;
+  }
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Allocates an object and returns to client. When the freelist is empty
+      one thread adds a page while the others wait for it.
+    \return
+      allocated memory for client
+*/
+//>=------------------------------------------------------------------------=<//
+void* ConcurrentObjectAllocator::Allocate()
+{
+  GenericObject* obj;
+
+  if (config_.UseCPPMemManager_)
+  {
+    try
+    {
+      obj = reinterpret_cast<GenericObject*>(new BYTE[objectSize_]);
+    }
+    catch (std::bad_alloc&)
+    {
+      throw OAException(OAException::E_NO_MEMORY, "No system memory free");
+    }
+  }
+  else
+  {
+    for (;;)
+    {
+      if ((obj = popFreelist()) != nullptr)
+        break;
+
+      if (not growing_.exchange(true, std::memory_order_acquire))
+      {
+        //  whoever grew last may have refilled it in the meantime
+        obj = popFreelist();
+
+        try
+        {
+          if (obj == nullptr)
+            obj = allocatePage();
+        }
+        catch (OAException&)
+        {
+          growing_.store(false, std::memory_order_release);
+          throw;
+        }
+
+        growing_.store(false, std::memory_order_release);
+        break;
+      }
+
+      while (growing_.load(std::memory_order_relaxed))
+        std::this_thread::yield();
+    }
+  }
+
+  slot().Allocations.fetch_add(1, std::memory_order_relaxed);
+  return obj;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Takes a pointer from client and "releases" it. May be called from a
+      different thread than the one that allocated it.
+    \param _object
+      Pointer to memory to release
+*/
+//>=------------------------------------------------------------------------=<//
+void ConcurrentObjectAllocator::Free(void* _object)
+{
+  if (config_.UseCPPMemManager_)
+  {
+    delete[] reinterpret_cast<BYTE*>(_object);
+  }
+  else
+  {
+    if (config_.DebugOn_)
+      verifyPointer(_object);
+
+    GenericObject* obj = reinterpret_cast<GenericObject*>(_object);
+    pushFreelist(obj, obj);
+  }
+
+  slot().Deallocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Returns the head of the freelist, only stable while no other thread
+      uses the allocator
+    \return
+      freelist
+*/
+//>=------------------------------------------------------------------------=<//
+const void* ConcurrentObjectAllocator::GetFreeList() const
+{
+  return pointer(freelist_.load(std::memory_order_acquire));
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Returns the newest page. Pages are never removed, so the list can be
+      walked while other threads allocate.
+    \return
+      pagelist
+*/
+//>=------------------------------------------------------------------------=<//
+const void* ConcurrentObjectAllocator::GetPageList() const
+{
+  return pagelist_.load(std::memory_order_acquire);
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Returns the config of the allocator
+    \return
+      Configuration parameters
+*/
+//>=------------------------------------------------------------------------=<//
+OAConfig ConcurrentObjectAllocator::GetConfig() const
+{
+  return config_;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Sums the per-thread counters. Counters are read one at a time, so the
+      result is only exact while no other thread uses the allocator.
+      MostObjects_ is sampled here and whenever a page is added.
+    \return
+      Current statistics
+*/
+//>=------------------------------------------------------------------------=<//
+OAStats ConcurrentObjectAllocator::GetStats() const
+{
+  unsigned long long allocations = 0, deallocations = 0;
+  for (const StatSlot& counters : slots_)
+  {
+    allocations += counters.Allocations.load(std::memory_order_relaxed);
+    deallocations += counters.Deallocations.load(std::memory_order_relaxed);
+  }
+
+  OAStats stats;
+  stats.ObjectSize_ = objectSize_;
+  stats.PageSize_ = config_.UseCPPMemManager_ ? 0 : pageSize_;
+  stats.PagesInUse_ = pages_.load(std::memory_order_relaxed);
+  stats.Allocations_ = static_cast<unsigned>(allocations);
+  stats.Deallocations_ = static_cast<unsigned>(deallocations);
+  stats.ObjectsInUse_ = static_cast<unsigned>(allocations - deallocations);
+  stats.FreeObjects_ = stats.PagesInUse_ * config_.ObjectsPerPage_ -
+    (config_.UseCPPMemManager_ ? 0 : stats.ObjectsInUse_);
+
+  unsigned most = mostObjects_.load(std::memory_order_relaxed);
+  while (most < stats.ObjectsInUse_ &&
+    not mostObjects_.compare_exchange_weak(most, stats.ObjectsInUse_,
+                                           std::memory_order_relaxed))
+  {
+  }
+  stats.MostObjects_ = most < stats.ObjectsInUse_ ? stats.ObjectsInUse_ : most;
+
+  return stats;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Pops the head of the freelist. The head's Next may be read after
+      another thread already took the block, that value is thrown away
+      because the counter in the head will have changed. Pages are never
+      returned while the allocator lives, so the read itself is safe.
+    \return
+      a block, or null if the freelist is empty
+*/
+//>=------------------------------------------------------------------------=<//
+GenericObject* ConcurrentObjectAllocator::popFreelist()
+{
+  Tagged head = freelist_.load(std::memory_order_acquire);
+
+  while (GenericObject* obj = pointer(head))
+  {
+    Tagged next = pack(obj->Next, tag(head) + 1);
+    if (freelist_.compare_exchange_weak(head, next,
+          std::memory_order_acquire, std::memory_order_acquire))
+      return obj;
+  }
+
+  return nullptr;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Pushes a chain of blocks onto the freelist with a single CAS
+    \param _first
+      first block of the chain
+    \param _last
+      last block of the chain, its Next is overwritten
+*/
+//>=------------------------------------------------------------------------=<//
+void ConcurrentObjectAllocator::pushFreelist(GenericObject* _first,
+  GenericObject* _last)
+{
+  Tagged head = freelist_.load(std::memory_order_relaxed);
+  Tagged next;
+
+  do
+  {
+    _last->Next = pointer(head);
+    next = pack(_first, tag(head) + 1);
+  } while (not freelist_.compare_exchange_weak(head, next,
+             std::memory_order_release, std::memory_order_relaxed));
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Gets a page, publishes it on the pagelist and pushes all but its
+      first block onto the freelist. Only one thread grows at a time.
+    \return
+      the page's first block, for the caller
+*/
+//>=------------------------------------------------------------------------=<//
+GenericObject* ConcurrentObjectAllocator::allocatePage()
+{
+  //  a MaxPages_ of 0 means there is no limit on the number of pages
+  unsigned pages = pages_.load(std::memory_order_relaxed);
+  if (config_.MaxPages_ && pages >= config_.MaxPages_)
+    throw OAException(OAException::E_NO_PAGES, "No extra pages available");
+
+  BYTE* page = static_cast<BYTE*>(pageSource_->AcquirePage(pageSize_));
+  if (page == nullptr)
+    throw OAException(OAException::E_NO_MEMORY, "No system memory free");
+
+  //  thread the blocks before anyone else can see them
+  BYTE* first = page + ptrSize;
+  for (unsigned i = 0; i + 1 < config_.ObjectsPerPage_; ++i)
+    reinterpret_cast<GenericObject*>(first + i * blockOffset_)->Next =
+      reinterpret_cast<GenericObject*>(first + (i + 1) * blockOffset_);
+
+  //  readers walking the pagelist see the page only once it's linked
+  GenericObject* pageObj = reinterpret_cast<GenericObject*>(page);
+  GenericObject* head = pagelist_.load(std::memory_order_relaxed);
+  do
+  {
+    pageObj->Next = head;
+  } while (not pagelist_.compare_exchange_weak(head, pageObj,
+             std::memory_order_release, std::memory_order_relaxed));
+  pages_.store(pages + 1, std::memory_order_relaxed);
+
+  //  growing means every block is in use, a good time to sample the peak
+  GetStats();
+
+  if (config_.ObjectsPerPage_ > 1)
+    pushFreelist(reinterpret_cast<GenericObject*>(first + blockOffset_),
+      reinterpret_cast<GenericObject*>(
+        first + (config_.ObjectsPerPage_ - 1) * blockOffset_));
+
+  return reinterpret_cast<GenericObject*>(first);
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Returns the statistic slot of the calling thread. Threads are handed
+      slots round robin, standing in for per-CPU counters.
+    \return
+      slot the calling thread counts in
+*/
+//>=------------------------------------------------------------------------=<//
+ConcurrentObjectAllocator::StatSlot& ConcurrentObjectAllocator::slot()
+{
+  static std::atomic<unsigned> nextSlot{ 0 };
+  static thread_local unsigned index =
+    nextSlot.fetch_add(1, std::memory_order_relaxed) % STAT_SLOTS;
+
+  return slots_[index];
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Checks that a pointer is a block of one of the pages. Double frees
+      can't be found without walking a freelist other threads change.
+    \param _object
+      Object to check
+*/
+//>=------------------------------------------------------------------------=<//
+void ConcurrentObjectAllocator::verifyPointer(const void* _object) const
+{
+  const BYTE* obj = reinterpret_cast<const BYTE*>(_object);
+
+  const GenericObject* page = pagelist_.load(std::memory_order_acquire);
+  while (page)
+  {
+    const BYTE* first = reinterpret_cast<const BYTE*>(page) + ptrSize;
+    const BYTE* end = first + config_.ObjectsPerPage_ * blockOffset_;
+
+    if (obj >= first && obj < end)
+    {
+      if ((obj - first) % blockOffset_)
+        break;
+      return;
+    }
+
+    page = page->Next;
+  }
+
+  throw OAException(OAException::E_BAD_BOUNDARY,
+                    "Pointer not on block boundary");
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Packs a pointer with a counter
+    \param _object
+      pointer to pack
+    \param _tag
+      counter to pack, truncated to the bits left over
+    \return
+      tagged head
+*/
+//>=------------------------------------------------------------------------=<//
+ConcurrentObjectAllocator::Tagged ConcurrentObjectAllocator::pack(
+  GenericObject* _object, Tagged _tag)
+{
+  return (_tag << pointerBits) |
+    (reinterpret_cast<std::uintptr_t>(_object) & pointerMask);
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Unpacks the pointer of a tagged head
+    \param _head
+      tagged head
+    \return
+      pointer
+*/
+//>=------------------------------------------------------------------------=<//
+GenericObject* ConcurrentObjectAllocator::pointer(Tagged _head)
+{
+  return reinterpret_cast<GenericObject*>(
+    static_cast<std::uintptr_t>(_head & pointerMask));
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Unpacks the counter of a tagged head
+    \param _head
+      tagged head
+    \return
+      counter
+*/
+//>=------------------------------------------------------------------------=<//
+ConcurrentObjectAllocator::Tagged ConcurrentObjectAllocator::tag(Tagged _head)
+{
+  return _head >> pointerBits;
+}
@@ -0,0 +1,116 @@
+//>=------------------------------------------------------------------------=<//
+// file:    ConcurrentObjectAllocator.h
+// author:  Tristan Baskerville
+// course:  CS280
+// brief:
+//   This file contains the interface for the ConcurrentObjectAllocator class,
+//   an ObjectAllocator that any number of threads can allocate from and free
+//   to at the same time, without locks.
+//
+//     + the freelist is a Treiber stack, its head is a pointer packed with a
+//       counter that changes on every pop, so a stale head never matches
+//     + pages are published on the pagelist with a compare-and-swap, then
+//       all of their blocks are pushed onto the freelist at once
+//     + statistics are counted in per-thread slots and summed on request
+//
+//   Only the allocator's core is supported: no headers, padding, patterns
+//   or guard pages. Those OAConfig settings are ignored. With DebugOn,
+//   Free still checks that a block is on a page and on a block boundary.
+//
+// Copyright © 2020 DigiPen, All rights reserved.
+//>=------------------------------------------------------------------------=<//
+
+#ifndef CONCURRENTOBJECTALLOCATORH
+#define CONCURRENTOBJECTALLOCATORH
+
+#include "ObjectAllocator.h"
+#include <atomic>  // std::atomic
+#include <cstdint> // std::uint64_t
+
+/*!
+  Lock-free memory manager, safe to share between threads
+*/
+class ConcurrentObjectAllocator
+{
+public:
+  //! number of statistic slots threads are spread over (power of two)
+  static const unsigned STAT_SLOTS = 64;
+
+  // Creates the allocator and its first page (unless using new/delete)
+  // Throws an exception if the construction fails. (Memory alloc problem)
+  ConcurrentObjectAllocator(size_t ObjectSize, const OAConfig& config);
+
+  // Returns every page. No other thread may be using the allocator.
+  ~ConcurrentObjectAllocator();
+
+  // Take an object from the freelist, growing it if it is empty
+  // Throws an exception if the obj can't be allocated. (Memory alloc problem)
+  void* Allocate();
+
+  // Returns an object to the freelist, from any thread
+  // Throws an exception if debugging and the object is invalid
+  void Free(void* Object);
+
+  const void* GetFreeList() const;  // returns a pointer to internal free list
+  const void* GetPageList() const;  // returns a pointer to internal page list
+  OAConfig GetConfig() const;       // returns the configuration parameters
+  OAStats GetStats() const;         // sums the statistics of every slot
+
+    // Prevent copy construction and assignment
+  //! Do not implement!
+  ConcurrentObjectAllocator(const ConcurrentObjectAllocator&) = delete;
+  //! Do not implement!
+  ConcurrentObjectAllocator& operator=(const ConcurrentObjectAllocator&)
+    = delete;
+
+private:
+  //! Redef for ease of use
+  using BYTE = unsigned char;
+  //! Pointer packed with an ABA counter
+  using Tagged = std::uint64_t;
+
+  /*!
+    Counters written by the threads mapped to one slot, on their own line
+  */
+  struct alignas(64) StatSlot
+  {
+    std::atomic<unsigned long long> Allocations{ 0 };   //!< total requests
+    std::atomic<unsigned long long> Deallocations{ 0 }; //!< total frees
+  };
+
+  std::atomic<Tagged> freelist_;          //!< tagged head of the freelist
+  std::atomic<GenericObject*> pagelist_;  //!< newest page, never removed
+  std::atomic<unsigned> pages_;           //!< pages on the pagelist
+  std::atomic<bool> growing_;             //!< a thread is adding a page
+  mutable std::atomic<unsigned> mostObjects_; //!< sampled high-water mark
+  OAConfig config_;                       //!< config settings
+  size_t objectSize_;                     //!< size requested by the client
+  size_t blockOffset_;                    //!< distance between two blocks
+  size_t pageSize_;                       //!< bytes of each page
+  PageSource* pageSource_;                //!< where pages come from
+  StatSlot slots_[STAT_SLOTS];            //!< per-thread statistics
+
+  //>=------------------------=<//
+  //>=--  Helper functions  --=<//
+  //>=------------------------=<//
+
+  // Pops a block, null if the freelist is empty
+  GenericObject* popFreelist();
+  // Pushes a chain of blocks linked through Next
+  void pushFreelist(GenericObject* First, GenericObject* Last);
+  // Publishes a new page and returns its first block. Can throw.
+  GenericObject* allocatePage();
+  // Statistic slot of the calling thread
+  StatSlot& slot();
+  // Throws if a pointer isn't a block of one of the pages
+  void verifyPointer(const void* Object) const;
+
+  // Packs a pointer with a counter
+  static Tagged pack(GenericObject* Object, Tagged Tag);
+  // Unpacks the pointer of a tagged head
+  static GenericObject* pointer(Tagged Head);
+  // Unpacks the counter of a tagged head
+  static Tagged tag(Tagged Head);
+};
+
+#endif
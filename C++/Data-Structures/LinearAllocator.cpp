@@ -0,0 +1,530 @@
+//>=------------------------------------------------------------------------=<//
+// file:    LinearAllocator.cpp
+// author:  Tristan Baskerville
+// course:  CS280
+// brief:
+//   This file contains the implementation for the ArenaAllocator and
+//   FrameAllocator classes.
+//
+// Copyright © 2020 DigiPen, All rights reserved.
+//>=------------------------------------------------------------------------=<//
+
+#include "LinearAllocator.h"
+#include <cstdint> // std::uintptr_t
+#include <cstring>
+
+namespace
+{
+  //  rounds an address up to the given (power of two) alignment
+  inline unsigned char* alignUp(unsigned char* address, size_t alignment)
+  {
+    std::uintptr_t value = reinterpret_cast<std::uintptr_t>(address);
+    value = (value + alignment - 1) & ~(std::uintptr_t(alignment) - 1);
+    return reinterpret_cast<unsigned char*>(value);
+  }
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      ctor for an ArenaAllocator instance
+    \param _config
+      configuration to use with the arena
+*/
+//>=------------------------------------------------------------------------=<//
+ArenaAllocator::ArenaAllocator(const ArenaConfig& _config) :
+  config_(_config),
+  stats_(),
+  pagelist_(nullptr),
+  current_(nullptr),
+  last_(nullptr)
+{
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      destructor for an ArenaAllocator instance
+*/
+//>=------------------------------------------------------------------------=<//
+ArenaAllocator::~ArenaAllocator()
+{
+  while (pagelist_)
+  {
+    BYTE* page = reinterpret_cast<BYTE*>(pagelist_);
+    pagelist_ = pagelist_->Next;
+    delete[] page;
+  }
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Bumps the current page to allocate a block for the client. Moves on
+      to a retained page, or allocates a new one, if the block doesn't fit.
+    \param _size
+      size in bytes of the block
+    \param _alignment
+      alignment of the block, must be a power of two
+    \return
+      allocated memory for client
+*/
+//>=------------------------------------------------------------------------=<//
+void* ArenaAllocator::Allocate(size_t _size, size_t _alignment)
+{
+  BYTE* block = current_ ? bumpPage(current_, _size, _alignment) : nullptr;
+
+  //  move along the retained pages until one fits
+  while (block == nullptr && current_ && current_->Next)
+  {
+    current_ = current_->Next;
+    current_->Used = 0;
+    block = bumpPage(current_, _size, _alignment);
+  }
+
+  if (block == nullptr)
+  {
+    //  worst case the block needs its pads, record and full alignment
+    size_t needed = _size + _alignment + 2 * config_.PadBytes_ +
+                    sizeof(BlockRecord) + alignof(BlockRecord);
+    ArenaPage* page = allocatePage(needed > config_.PageSize_ ?
+                                   needed : config_.PageSize_);
+    current_ = page;
+    block = bumpPage(current_, _size, _alignment);
+  }
+
+  //  update stats
+  stats_.Allocations_ += 1;
+  if ((stats_.BytesInUse_ += _size) > stats_.MostBytes_)
+    stats_.MostBytes_ = stats_.BytesInUse_;
+
+  return block;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Returns the position the next allocation would start from
+    \return
+      Marker that can be passed to RewindTo
+*/
+//>=------------------------------------------------------------------------=<//
+ArenaAllocator::Marker ArenaAllocator::GetMarker() const
+{
+  return Marker{ current_, current_ ? current_->Used : 0, stats_.BytesInUse_ };
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Releases every allocation made after the marker was taken. Pages
+      that were moved onto since are kept for reuse.
+    \param _marker
+      Marker previously returned by GetMarker
+*/
+//>=------------------------------------------------------------------------=<//
+void ArenaAllocator::RewindTo(const Marker& _marker)
+{
+  //  a marker taken before the first page existed is the same as a reset
+  if (_marker.page_ == nullptr)
+  {
+    Reset();
+    return;
+  }
+
+  if (config_.DebugOn_)
+  {
+    //  every page from the marker up to the current one is released
+    ArenaPage* page = _marker.page_;
+    setPatternFreed(page, _marker.used_);
+    while (page != current_)
+    {
+      page = page->Next;
+      setPatternFreed(page, 0);
+    }
+  }
+
+  current_ = _marker.page_;
+  current_->Used = _marker.used_;
+
+  //  update stats
+  stats_.BytesInUse_ = _marker.bytesInUse_;
+  stats_.Resets_ += 1;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Releases every allocation in O(1) (unless debugging). Every page is
+      kept, the next allocation starts from the first page.
+*/
+//>=------------------------------------------------------------------------=<//
+void ArenaAllocator::Reset()
+{
+  if (config_.DebugOn_)
+  {
+    for (ArenaPage* page = pagelist_; page; page = page->Next)
+    {
+      setPatternFreed(page, 0);
+      if (page == current_) break;
+    }
+  }
+
+  current_ = pagelist_;
+  if (current_)
+    current_->Used = 0;
+
+  //  update stats
+  stats_.BytesInUse_ = 0;
+  stats_.Resets_ += 1;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Verifies the pad bytes of every live block. Only available while
+      debugging, as that is when blocks are recorded on the pages.
+    \param _fn
+      Pointer to client defined callback function
+    \return
+      Total count of potentially corrupt memory
+*/
+//>=------------------------------------------------------------------------=<//
+unsigned ArenaAllocator::ValidatePages(VALIDATECALLBACK _fn) const
+{
+  if (not config_.DebugOn_ || current_ == nullptr)
+    return 0;
+
+  unsigned count = 0;
+
+  for (ArenaPage* page = pagelist_; page; page = page->Next)
+  {
+    BYTE* pos = pageData(page);
+    BYTE* end = pos + page->Used;
+
+    //  walk the records laid down by bumpPage
+    while (pos < end)
+    {
+      pos = alignUp(pos, alignof(BlockRecord));
+      const BlockRecord* record = reinterpret_cast<const BlockRecord*>(pos);
+      BYTE* block = pos + sizeof(BlockRecord) + record->Lead;
+
+      if (badPadBytes(block, record->Size))
+      {
+        _fn(block, record->Size);
+        ++count;
+      }
+
+      pos = block + record->Size + config_.PadBytes_;
+    }
+
+    if (page == current_) break;
+  }
+
+  //  total count of bad memory found
+  return count;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Frees every retained page after the current one
+    \return
+      Number of pages freed
+*/
+//>=------------------------------------------------------------------------=<//
+unsigned ArenaAllocator::FreeEmptyPages()
+{
+  //  with no current page, every page is empty
+  ArenaPage* keep = current_;
+  ArenaPage* page = keep ? keep->Next : pagelist_;
+  unsigned count = 0;
+
+  while (page)
+  {
+    BYTE* memory = reinterpret_cast<BYTE*>(page);
+    page = page->Next;
+    delete[] memory;
+    ++count;
+  }
+
+  if (keep)
+    keep->Next = nullptr;
+  else
+    pagelist_ = nullptr;
+
+  last_ = keep;
+
+  //  update stats
+  stats_.PagesInUse_ -= count;
+
+  return count;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Returns a pointer to the internal pagelist
+    \return
+      pagelist
+*/
+//>=------------------------------------------------------------------------=<//
+const void* ArenaAllocator::GetPageList() const
+{
+  return pagelist_;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Returns the configuration settings used
+    \return
+      Configuration settings
+*/
+//>=------------------------------------------------------------------------=<//
+ArenaConfig ArenaAllocator::GetConfig() const
+{
+  return config_;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Returns the currently tracked statistic
+    \return
+      Current statistics
+*/
+//>=------------------------------------------------------------------------=<//
+ArenaStats ArenaAllocator::GetStats() const
+{
+  return stats_;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Tries to fit a block onto a page. With debugging on, a record is
+      placed in front of the block, and the block is surrounded by pad bytes.
+    \param _page
+      page to bump
+    \param _size
+      size in bytes of the block
+    \param _alignment
+      alignment of the block
+    \return
+      the block, or null if it did not fit
+*/
+//>=------------------------------------------------------------------------=<//
+ArenaAllocator::BYTE* ArenaAllocator::bumpPage(ArenaPage* _page,
+  size_t _size, size_t _alignment)
+{
+  BYTE* data = pageData(_page);
+  BYTE* pos = data + _page->Used;
+  BYTE* end = data + _page->Capacity;
+
+  if (not config_.DebugOn_)
+  {
+    BYTE* block = alignUp(pos, _alignment);
+    if (block + _size > end) return nullptr;
+
+    _page->Used = (block + _size) - data;
+    return block;
+  }
+
+  //  record, alignment bytes, left pad, block, right pad
+  BYTE* record = alignUp(pos, alignof(BlockRecord));
+  BYTE* block = alignUp(record + sizeof(BlockRecord) + config_.PadBytes_,
+                        _alignment);
+  BYTE* right_pad = block + _size;
+  if (right_pad + config_.PadBytes_ > end) return nullptr;
+
+  BlockRecord info = { _size, static_cast<size_t>(
+    block - (record + sizeof(BlockRecord))) };
+  std::memcpy(record, &info, sizeof(info));
+
+  BYTE* left_pad = block - config_.PadBytes_;
+  std::memset(record + sizeof(BlockRecord), ObjectAllocator::ALIGN_PATTERN,
+              left_pad - (record + sizeof(BlockRecord)));
+  std::memset(left_pad, ObjectAllocator::PAD_PATTERN, config_.PadBytes_);
+  std::memset(block, ObjectAllocator::ALLOCATED_PATTERN, _size);
+  std::memset(right_pad, ObjectAllocator::PAD_PATTERN, config_.PadBytes_);
+
+  _page->Used = (right_pad + config_.PadBytes_) - data;
+  return block;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Allocates a new page and links it at the end of the pagelist
+    \param _capacity
+      usable bytes on the page
+    \return
+      the new page
+*/
+//>=------------------------------------------------------------------------=<//
+ArenaAllocator::ArenaPage* ArenaAllocator::allocatePage(size_t _capacity)
+{
+  //  a MaxPages_ of 0 means there is no limit on the number of pages
+  if (config_.MaxPages_ && stats_.PagesInUse_ >= config_.MaxPages_)
+    throw OAException(OAException::E_NO_PAGES, "No extra pages available");
+
+  BYTE* memory;
+
+  try
+  {
+    //  left uninitialized, the page is only touched as it is bumped
+    memory = new BYTE[sizeof(ArenaPage) + _capacity];
+  }
+  catch (std::bad_alloc&)
+  {
+    throw OAException(OAException::E_NO_MEMORY, "No system memory free");
+  }
+
+  ArenaPage* page = reinterpret_cast<ArenaPage*>(memory);
+  page->Next = nullptr;
+  page->Capacity = _capacity;
+  page->Used = 0;
+
+  if (last_)
+    last_->Next = page;
+  else
+    pagelist_ = page;
+  last_ = page;
+
+  if (config_.DebugOn_)
+    std::memset(pageData(page), ObjectAllocator::UNALLOCATED_PATTERN,
+                _capacity);
+
+  //  update stats
+  stats_.PagesInUse_ += 1;
+
+  return page;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Returns the start of the usable bytes on a page
+    \param _page
+      page header
+    \return
+      first byte after the header
+*/
+//>=------------------------------------------------------------------------=<//
+ArenaAllocator::BYTE* ArenaAllocator::pageData(ArenaPage* _page)
+{
+  return reinterpret_cast<BYTE*>(_page) + sizeof(ArenaPage);
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Sets the pattern used for freed memory on a range of a page
+    \param _page
+      page being released
+    \param _from
+      offset on the page to start from
+*/
+//>=------------------------------------------------------------------------=<//
+void ArenaAllocator::setPatternFreed(ArenaPage* _page, size_t _from)
+{
+  if (_page->Used > _from)
+    std::memset(pageData(_page) + _from, ObjectAllocator::FREED_PATTERN,
+                _page->Used - _from);
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Verifies the pad bytes next to a block
+    \param _block
+      Pointer to block to check pad bytes
+    \param _size
+      size of the block
+    \return
+      Health of pad bytes
+*/
+//>=------------------------------------------------------------------------=<//
+bool ArenaAllocator::badPadBytes(const BYTE* _block, size_t _size) const
+{
+  const BYTE* left_pad = _block - config_.PadBytes_;
+  const BYTE* right_pad = _block + _size;
+
+  for (unsigned i = 0; i < config_.PadBytes_; ++i)
+    if (left_pad[i] != ObjectAllocator::PAD_PATTERN ||
+        right_pad[i] != ObjectAllocator::PAD_PATTERN)
+      return true;
+
+  return false;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      ctor for a FrameAllocator instance
+    \param _config
+      configuration used by both arenas
+*/
+//>=------------------------------------------------------------------------=<//
+FrameAllocator::FrameAllocator(const ArenaConfig& _config) :
+  arenas_{ ArenaAllocator(_config), ArenaAllocator(_config) },
+  current_(0)
+{
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Allocates a block from the arena of the current frame
+    \param _size
+      size in bytes of the block
+    \param _alignment
+      alignment of the block, must be a power of two
+    \return
+      allocated memory for client, valid until the second SwapFrames call
+*/
+//>=------------------------------------------------------------------------=<//
+void* FrameAllocator::Allocate(size_t _size, size_t _alignment)
+{
+  return arenas_[current_].Allocate(_size, _alignment);
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Ends the current frame. The arena used two frames ago is reset and
+      becomes the current one.
+*/
+//>=------------------------------------------------------------------------=<//
+void FrameAllocator::SwapFrames()
+{
+  current_ ^= 1;
+  arenas_[current_].Reset();
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Returns the arena of the frame in progress
+    \return
+      current arena
+*/
+//>=------------------------------------------------------------------------=<//
+ArenaAllocator& FrameAllocator::GetCurrent()
+{
+  return arenas_[current_];
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Returns the arena of the previous frame
+    \return
+      previous arena
+*/
+//>=------------------------------------------------------------------------=<//
+const ArenaAllocator& FrameAllocator::GetPrevious() const
+{
+  return arenas_[current_ ^ 1];
+}
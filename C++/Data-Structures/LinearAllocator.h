@@ -0,0 +1,248 @@
+//>=------------------------------------------------------------------------=<//
+// file:    LinearAllocator.h
+// author:  Tristan Baskerville
+// course:  CS280
+// brief:
+//   This file contains the interface for the ArenaAllocator class and the
+//   double-buffered FrameAllocator built on top of it. Both hand out memory
+//   by bumping a pointer through a list of pages, and release everything at
+//   once instead of per object.
+//
+//   Public operations include:
+//     + Constructor/Destructor
+//     + Allocating a block of any size/alignment
+//     + Taking a marker and rewinding to it (or a scoped marker)
+//     + Resetting the whole arena
+//     + Verifying pad bytes for corrupted memory
+//     + Freeing retained pages
+//     + Getter for configuration
+//     + Getter for statistics
+//
+//   Debug patterns and exceptions are shared with ObjectAllocator.
+//
+// Copyright © 2020 DigiPen, All rights reserved.
+//>=------------------------------------------------------------------------=<//
+
+#ifndef LINEARALLOCATORH
+#define LINEARALLOCATORH
+
+#include "ObjectAllocator.h"
+#include <cstddef> // std::max_align_t
+
+// If the client doesn't specify this:
+static const size_t DEFAULT_ARENA_PAGE_SIZE = 64 * 1024;
+
+/*!
+  ArenaAllocator configuration parameters
+*/
+struct ArenaConfig
+{
+  /*!
+    Constructor
+
+    \param PageSize
+      Number of usable bytes in each page. Larger requests get their own page.
+
+    \param MaxPages
+      Maximum number of pages before throwing an exception. A value
+      of 0 means unlimited.
+
+    \param DebugOn
+      Is debugging code on or off?
+
+    \param PadBytes
+      The number of bytes to the left and right of a block to pad with.
+  */
+  ArenaConfig(size_t PageSize = DEFAULT_ARENA_PAGE_SIZE,
+    unsigned MaxPages = 0,
+    bool DebugOn = false,
+    unsigned PadBytes = 0) : PageSize_(PageSize),
+    MaxPages_(MaxPages),
+    DebugOn_(DebugOn),
+    PadBytes_(PadBytes)
+  {
+  }
+
+  //! number of usable bytes on each page
+  size_t PageSize_;
+  //! maximum number of pages the arena can allocate (0=unlimited)
+  unsigned MaxPages_;
+  //! enable/disable debugging code (signatures, checks, etc.)
+  bool DebugOn_;
+  //! size of the left/right padding for each block
+  unsigned PadBytes_;
+};
+
+/*!
+  POD that holds the ArenaAllocator statistical info
+*/
+struct ArenaStats
+{
+  /*!
+    Constructor
+  */
+  ArenaStats() : PagesInUse_(0), BytesInUse_(0), MostBytes_(0),
+    Allocations_(0), Resets_(0) {};
+
+  unsigned PagesInUse_;  //!< number of pages allocated (retained or not)
+  size_t BytesInUse_;    //!< bytes given to the client since the last reset
+  size_t MostBytes_;     //!< most bytes in use by client at one time
+  unsigned Allocations_; //!< total requests to allocate memory
+  unsigned Resets_;      //!< total number of resets and rewinds
+};
+
+/*!
+  This class represents a linear (bump-pointer) memory manager
+*/
+class ArenaAllocator
+{
+  struct ArenaPage;
+
+public:
+  //! Callback function when validating blocks
+  typedef ObjectAllocator::VALIDATECALLBACK VALIDATECALLBACK;
+
+  /*!
+    A position in the arena that can be rewound to later
+  */
+  struct Marker
+  {
+    ArenaPage* page_;   //!< page that was current (null before first alloc)
+    size_t used_;       //!< bytes used on that page
+    size_t bytesInUse_; //!< total bytes in use when the marker was taken
+  };
+
+  class Scope;
+
+  // Creates the arena per the specified values. No page is allocated until
+  // the first call to Allocate.
+  ArenaAllocator(const ArenaConfig& config = ArenaConfig());
+
+  // Destroys the arena and every page it owns (never throws)
+  ~ArenaAllocator();
+
+  // Bumps the current page and gives the block to the client.
+  // Throws an exception if a new page can't be allocated.
+  void* Allocate(size_t Size, size_t Alignment = alignof(std::max_align_t));
+
+  // Position of the next allocation
+  Marker GetMarker() const;
+
+  // Releases every allocation made after the marker was taken
+  void RewindTo(const Marker& marker);
+
+  // Releases every allocation, pages are kept for reuse
+  void Reset();
+
+  // Calls the callback fn for each block that is potentially corrupted
+  unsigned ValidatePages(VALIDATECALLBACK fn) const;
+
+  // Frees all pages past the current one, returns how many were freed
+  unsigned FreeEmptyPages();
+
+    // Testing/Debugging/Statistic methods
+  const void* GetPageList() const;  // returns a pointer to internal page list
+  ArenaConfig GetConfig() const;    // returns the configuration parameters
+  ArenaStats GetStats() const;      // returns the statistics for the arena
+
+    // Prevent copy construction and assignment
+  //! Do not implement!
+  ArenaAllocator(const ArenaAllocator&) = delete;
+  //! Do not implement!
+  ArenaAllocator& operator=(const ArenaAllocator&) = delete;
+
+private:
+  //! Redef for ease of use
+  using BYTE = unsigned char;
+
+  /*!
+    Sits at the front of every page, pages are kept in allocation order
+  */
+  struct ArenaPage
+  {
+    ArenaPage* Next;  //!< The next page in the list
+    size_t Capacity;  //!< usable bytes after this header
+    size_t Used;      //!< bytes handed out on this page
+  };
+
+  /*!
+    With debugging on, precedes every block so pages can be walked
+  */
+  struct BlockRecord
+  {
+    size_t Size; //!< size the client asked for
+    size_t Lead; //!< bytes between this record and the block
+  };
+
+  ArenaConfig config_;   //!< config settings
+  ArenaStats stats_;     //!< tracked statistics
+  ArenaPage* pagelist_;  //!< first page, where a reset starts from
+  ArenaPage* current_;   //!< page allocations are bumped from
+  ArenaPage* last_;      //!< last page, new pages are linked after it
+
+  //>=------------------------=<//
+  //>=--  Helper functions  --=<//
+  //>=------------------------=<//
+
+  // Bumps an allocation on a page, returns null if it does not fit
+  BYTE* bumpPage(ArenaPage* Page, size_t Size, size_t Alignment);
+  // Allocates a page and links it at the end of the pagelist. Can throw.
+  ArenaPage* allocatePage(size_t Capacity);
+  // Start of the usable bytes of a page
+  static BYTE* pageData(ArenaPage* Page);
+  // Sets the freed pattern from a point on a page to the current position
+  void setPatternFreed(ArenaPage* Page, size_t From);
+  // returns if a pad byte is found faulty
+  bool badPadBytes(const BYTE* Block, size_t Size) const;
+};
+
+/*!
+  Rewinds an arena to where it was when the scope was entered
+*/
+class ArenaAllocator::Scope
+{
+public:
+  //! Takes a marker from the arena
+  explicit Scope(ArenaAllocator& arena) :
+    arena_(arena), marker_(arena.GetMarker()) {}
+
+  //! Rewinds the arena to the marker (never throws)
+  ~Scope() { arena_.RewindTo(marker_); }
+
+  //! Do not implement!
+  Scope(const Scope&) = delete;
+  //! Do not implement!
+  Scope& operator=(const Scope&) = delete;
+
+private:
+  ArenaAllocator& arena_; //!< arena being rewound
+  Marker marker_;         //!< position to rewind to
+};
+
+/*!
+  Two arenas used on alternating frames. Memory allocated during a frame
+  stays valid through the following frame, then is reset in O(1).
+*/
+class FrameAllocator
+{
+public:
+  // Both arenas use the same configuration
+  FrameAllocator(const ArenaConfig& config = ArenaConfig());
+
+  // Allocates from the current frame's arena
+  void* Allocate(size_t Size, size_t Alignment = alignof(std::max_align_t));
+
+  // Ends the current frame, the arena from two frames ago is reset and reused
+  void SwapFrames();
+
+  // Arena of the frame in progress
+  ArenaAllocator& GetCurrent();
+  // Arena of the last frame, still valid until the next swap
+  const ArenaAllocator& GetPrevious() const;
+
+private:
+  ArenaAllocator arenas_[2]; //!< one arena per frame parity
+  unsigned current_;         //!< index of the arena for this frame
+};
+
+#endif
@@ -286,6 +286,9 @@ void OAHashTable<T>::init_slot(OAHTSlot& slot, const char* key, const T& data)
 template<typename T>
 void OAHashTable<T>::set_key(char* slot_key, const char* string_key)
 {
+  //  packing can reinsert a key into the slot it came from
+  if (slot_key == string_key) return;
+
   //  copy contents of string_key into slot_key up until a NUL
   //  character is encountered, or MAX_KEYLEN is hit.
   strncpy(slot_key, string_key, MAX_KEYLEN);
@@ -371,7 +374,8 @@ void OAHashTable<T>::pack(int index)
   //  if we aren't supposed to pack, bail
   if (config_.DeletionPolicy_ != OAHTDeletionPolicy::PACK) return;
   
-  int i = index + 1; // starting right after the deleted element
+  //  starting right after the deleted element, wrapping past the end
+  int i = (index + 1) % static_cast<int>(stats_.TableSize_);
   while (i != index) // stop when a full cycle is completed
   {
     //  break early if we hit an unoccupied slot
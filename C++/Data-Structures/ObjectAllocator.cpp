@@ -12,14 +12,98 @@
 //>=------------------------------------------------------------------------=<//
 
 #include "ObjectAllocator.h"
+#include "AllocationProfiler.h"
+#include "PageSource.h"
+#include <algorithm> // std::sort, std::stable_sort, std::upper_bound
+#include <cstddef> // std::max_align_t
 #include <cstring>
+#include <new> // placement new
+
+#if defined(_WIN32)
+  #include <windows.h>
+#else
+  #include <sys/mman.h>
+  #include <unistd.h>
+#endif
 
 namespace
 {
   // const value for sizeof(void*);
   constexpr size_t ptrSize = sizeof(void*);
+  // marks a live guard record, checked when debugging
+  constexpr unsigned guardMagic = 0x6A7D0B1Eu;
+
+  //  largest power of two dividing a non-zero value
+  constexpr size_t lowestBit(size_t value)
+  {
+    return value & (~value + 1);
+  }
+
+  //  size of a virtual memory page, the granularity of guard pages
+  size_t systemPageSize()
+  {
+#if defined(_WIN32)
+    static const size_t size = []()
+    {
+      SYSTEM_INFO info;
+      GetSystemInfo(&info);
+      return static_cast<size_t>(info.dwPageSize);
+    }();
+#else
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    return size;
+  }
+
+  //  maps zeroed, accessible pages directly from the system
+  void* mapPages(size_t bytes)
+  {
+#if defined(_WIN32)
+    return VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT,
+                        PAGE_READWRITE);
+#else
+    void* pages = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return pages == MAP_FAILED ? nullptr : pages;
+#endif
+  }
+
+  //  makes pages inaccessible, any access afterwards faults
+  bool protectPages(void* pages, size_t bytes)
+  {
+#if defined(_WIN32)
+    DWORD old;
+    return VirtualProtect(pages, bytes, PAGE_NOACCESS, &old) != 0;
+#else
+    return mprotect(pages, bytes, PROT_NONE) == 0;
+#endif
+  }
+
+  //  returns pages mapped by mapPages to the system
+  void unmapPages(void* pages, size_t bytes)
+  {
+#if defined(_WIN32)
+    (void)bytes;
+    VirtualFree(pages, 0, MEM_RELEASE);
+#else
+    munmap(pages, bytes);
+#endif
+  }
 }
 
+/*!
+  Sits at the start of every guarded mapping, the block is at the end of the
+  accessible pages, right against the guard page
+*/
+struct ObjectAllocator::GuardRecord
+{
+  GuardRecord* Prev;  //!< previous live guarded block
+  GuardRecord* Next;  //!< next live guarded block
+  const char* Label;  //!< label given to Allocate
+  unsigned AllocNum;  //!< The allocation number (count) of this block
+  unsigned Magic;     //!< guardMagic while the block is live
+};
+
 //>=------------------------------------------------------------------------=<//
 /*!
     \brief
@@ -36,16 +120,82 @@ ObjectAllocator::ObjectAllocator(size_t _objectSize, const OAConfig& _config) :
   config_(_config),
   stats_(),
   headerOffset_(config_.HBlockInfo_.size_ + config_.PadBytes_),
-  blockOffset_(headerOffset_ + _objectSize + config_.PadBytes_)
+  blockOffset_(headerOffset_ + _objectSize + config_.PadBytes_),
+  blockAlign_(0),
+  profiler_(nullptr),
+  relocator_(nullptr),
+  guardlist_(nullptr),
+  quarantine_(nullptr),
+  quarantined_(0),
+  quarantineNext_(0),
+  guardSpan_(0),
+  guardSlack_(0),
+  sideTableOffset_(0),
+  labels_(),
+  lastLabel_(nullptr),
+  pageSource_(config_.PageSource_ ? config_.PageSource_ : PageSource::Heap()),
+  pageBytes_(0),
+  carveNext_(nullptr),
+  carveEnd_(nullptr),
+  sweeping_(nullptr)
 {
   stats_.ObjectSize_ = _objectSize;
 
   stats_.PageSize_ = ptrSize + config_.ObjectsPerPage_ *
     (config_.HBlockInfo_.size_ + 2 * config_.PadBytes_ + _objectSize);
 
+  //  external headers point into a table stored after the page's blocks
+  if (config_.HBlockInfo_.type_ == config_.hbExternal)
+    sideTableOffset_ = (stats_.PageSize_ + alignof(MemBlockInfo) - 1) /
+                       alignof(MemBlockInfo) * alignof(MemBlockInfo);
+
+  //  pages with external headers end with one MemBlockInfo per block
+  pageBytes_ = sideTableOffset_ ? sideTableOffset_ +
+    config_.ObjectsPerPage_ * sizeof(MemBlockInfo) : stats_.PageSize_;
+
+  //  new[] only promises the default new alignment
+  blockAlign_ = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+  if (config_.GuardPages_ && not config_.UseCPPMemManager_)
+  {
+    //  blocks keep pointer alignment, so up to ptrSize - 1 bytes of slack
+    //  sit between the block and its guard page
+    size_t rounded = (_objectSize + ptrSize - 1) / ptrSize * ptrSize;
+    size_t page = systemPageSize();
+    guardSlack_ = rounded - _objectSize;
+    guardSpan_ = (sizeof(GuardRecord) + rounded + page - 1) / page * page;
+
+    //  the block ends where the mapping's accessible pages do
+    blockAlign_ = lowestBit(page | rounded);
+
+    if (config_.QuarantineSize_)
+    {
+      try
+      {
+        quarantine_ = new BYTE*[config_.QuarantineSize_];
+      }
+      catch (std::bad_alloc&)
+      {
+        throw OAException(OAException::E_NO_MEMORY, "No system memory free");
+      }
+    }
+  }
   //  only allocate page if not using new/delete
-  if (config_.UseCPPMemManager_ != true)
+  else if (config_.UseCPPMemManager_ != true)
+  {
+    //  a block's address is its page's plus the offset of the first block
+    //  plus some number of block strides
+    size_t offsets = alignof(std::max_align_t) | (ptrSize + headerOffset_);
+    if (config_.ObjectsPerPage_ > 1)
+      offsets |= blockOffset_;
+    blockAlign_ = lowestBit(offsets);
+
+    //  a slab source sizes its slab from the page limit
+    if (not pageSource_->Reserve(pageBytes_, config_.MaxPages_))
+      throw OAException(OAException::E_NO_MEMORY, "Page source unavailable");
+
     allocatePage();
+  }
 
 }
 
@@ -57,28 +207,27 @@ ObjectAllocator::ObjectAllocator(size_t _objectSize, const OAConfig& _config) :
 //>=------------------------------------------------------------------------=<//
 ObjectAllocator::~ObjectAllocator()
 {
+  //  guarded blocks the client never freed, then the quarantine
+  while (guardlist_)
+  {
+    BYTE* mapping = reinterpret_cast<BYTE*>(guardlist_);
+    guardlist_ = guardlist_->Next;
+    unmapPages(mapping, guardSpan_ + systemPageSize());
+  }
+
+  for (unsigned i = 0; i < quarantined_; ++i)
+    unmapPages(quarantine_[i], guardSpan_ + systemPageSize());
+  delete[] quarantine_;
+
   //  empty the entire pagelist.
   //  there are no pages if the C++ Memory Manager is in use.
   while (pagelist_)
   {
-    //  memory to be deleted
+    //  memory to be deleted, external headers live on the page too
     BYTE* page = reinterpret_cast<BYTE*>(pagelist_);
 
-    //  (DEBUG) make sure there are no remaining headers left by the client
-    if (config_.DebugOn_ && config_.HBlockInfo_.type_ == config_.hbExternal)
-    {
-      for (unsigned i = 0; i < config_.ObjectsPerPage_; ++i)
-      {
-        BYTE* block = page + ptrSize + i * blockOffset_ + headerOffset_;
-
-        //  if this wasn't freed by the client, free it
-        if (not onFreelist(block))
-          headerSetterExternal(block - headerOffset_, false);
-      }
-    }
-
     pagelist_ = pagelist_->Next;
-    delete[] page;
+    pageSource_->ReleasePage(page, pageBytes_);
   }
 }
 
@@ -98,7 +247,10 @@ void* ObjectAllocator::Allocate(const char* _label)
   //  normal functionality
   if (not config_.UseCPPMemManager_)
   {
-    obj = popFreelist(_label, &ObjectAllocator::setPatternAlloc);
+    if (config_.GuardPages_)
+      obj = guardAllocate(_label);
+    else
+      obj = popFreelist(_label, &ObjectAllocator::setPatternAlloc);
   }
   //  only used when set to
   else
@@ -113,12 +265,17 @@ void* ObjectAllocator::Allocate(const char* _label)
     }
   }
 
-  //  update stats
+  //  update stats, guarded blocks are mapped on demand and never counted
+  //  as free, so only blocks carved from pages come out of FreeObjects_
   stats_.Allocations_ += 1;
-  stats_.FreeObjects_ -= 1;
+  if (not config_.GuardPages_ || config_.UseCPPMemManager_)
+    stats_.FreeObjects_ -= 1;
   if ((stats_.ObjectsInUse_ += 1) > stats_.MostObjects_)
     stats_.MostObjects_ = stats_.ObjectsInUse_;
 
+  if (profiler_)
+    profiler_->OnAllocate(obj, stats_.ObjectSize_);
+
   return obj;
 }
 
@@ -132,11 +289,37 @@ void* ObjectAllocator::Allocate(const char* _label)
 //>=------------------------------------------------------------------------=<//
 void ObjectAllocator::Free(void* _object)
 {
-  if (not config_.UseCPPMemManager_)
-  {
-    if (config_.DebugOn_) 
-      verifyPointer(_object);
+  //  guarded blocks are checked by guardFree
+  if (config_.DebugOn_ && not config_.UseCPPMemManager_ &&
+      not config_.GuardPages_)
+    verifyPointer(_object);
 
+  releaseBlock(_object);
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Returns a block to the allocator. Does everything Free does except
+      for the debug checks, which the caller has done or doesn't need.
+    \param _object
+      Pointer to memory to release
+*/
+//>=------------------------------------------------------------------------=<//
+void ObjectAllocator::releaseBlock(void* _object)
+{
+  if (sweeping_)
+    sweeping_->erase(_object);
+
+  if (profiler_)
+    profiler_->OnFree(_object, stats_.ObjectSize_);
+
+  if (config_.GuardPages_ && not config_.UseCPPMemManager_)
+  {
+    guardFree(_object);
+  }
+  else if (not config_.UseCPPMemManager_)
+  {
     if (config_.HBlockInfo_.type_ != config_.hbNone)
       removeHeader(_object);
     
@@ -147,10 +330,12 @@ void ObjectAllocator::Free(void* _object)
     delete [] reinterpret_cast<BYTE*>(_object);
   }
 
-  //  update stats
+  //  update stats, a freed guarded block is unmapped or quarantined, it
+  //  can't be handed out again
   stats_.Deallocations_ += 1;
   stats_.ObjectsInUse_  -= 1;
-  stats_.FreeObjects_   += 1;
+  if (not config_.GuardPages_ || config_.UseCPPMemManager_)
+    stats_.FreeObjects_ += 1;
 }
 
 //>=------------------------------------------------------------------------=<//
@@ -165,27 +350,251 @@ void ObjectAllocator::Free(void* _object)
 //>=------------------------------------------------------------------------=<//
 unsigned ObjectAllocator::DumpMemoryInUse(DUMPCALLBACK _fn) const
 {
-  GenericObject* page = pagelist_;
-  
   //  call _fn on all allocated obj's
-  while (page)
+  for (const void* block : collectLiveBlocks())
+    _fn(block, stats_.ObjectSize_);
+
+  return stats_.ObjectsInUse_;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Finds every block in use by walking the pages. Without headers the
+      freelist is gathered into a set first, so each block is checked in
+      constant time instead of walking the freelist for each one.
+    \return
+      blocks in use, guarded blocks first, then page by page
+*/
+//>=------------------------------------------------------------------------=<//
+std::vector<void*> ObjectAllocator::collectLiveBlocks() const
+{
+  std::vector<void*> live;
+  live.reserve(stats_.ObjectsInUse_);
+
+  //  guarded blocks are only ever on the guard list
+  for (const GuardRecord* rec = guardlist_; rec; rec = rec->Next)
+    live.push_back(const_cast<BYTE*>(reinterpret_cast<const BYTE*>(rec)) +
+                   guardSpan_ - guardSlack_ - stats_.ObjectSize_);
+
+  std::unordered_set<const void*> freed;
+  bool headers = config_.HBlockInfo_.type_ != config_.hbNone;
+  if (not headers && pagelist_)
+  {
+    freed.reserve(stats_.FreeObjects_);
+    for (const GenericObject* obj = freelist_; obj; obj = obj->Next)
+      freed.insert(obj);
+  }
+
+  for (GenericObject* page = pagelist_; page; page = page->Next)
   {
     BYTE* byte_page = reinterpret_cast<BYTE*>(page);
     for (unsigned i = 0; i < config_.ObjectsPerPage_; ++i)
     {
       //  find next object
-      const BYTE* block = byte_page + ptrSize + 
-                          i * blockOffset_ + headerOffset_;
+      BYTE* block = byte_page + ptrSize + i * blockOffset_ + headerOffset_;
 
       //  check if the object is in use
-      if (not onFreelist(block))
-        _fn(block, stats_.ObjectSize_);
+      bool free = headers ? onFreelist(block)
+                          : isUncarved(block) || freed.count(block);
+      if (not free)
+        live.push_back(block);
     }
+  }
 
-    page = page->Next;
+  return live;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Carves what is left of the newest page and pushes it onto the
+      freelist, so every free block is on the freelist
+*/
+//>=------------------------------------------------------------------------=<//
+void ObjectAllocator::carveAll()
+{
+  while (carveNext_ != carveEnd_)
+  {
+    GenericObject* obj = carveBlock();
+    obj->Next = freelist_;
+    freelist_ = obj;
   }
+}
 
-  return stats_.ObjectsInUse_;
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Collects the pages so a block's page can be found with a binary search
+    \return
+      every page, lowest address first
+*/
+//>=------------------------------------------------------------------------=<//
+std::vector<ObjectAllocator::BYTE*> ObjectAllocator::sortedPages() const
+{
+  std::vector<BYTE*> pages;
+  pages.reserve(stats_.PagesInUse_);
+
+  for (GenericObject* page = pagelist_; page; page = page->Next)
+    pages.push_back(reinterpret_cast<BYTE*>(page));
+
+  std::sort(pages.begin(), pages.end());
+  return pages;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Flags which blocks are in use. The freelist and the uncarved blocks
+      are the free ones, the rest are in use, regardless of headers.
+    \param _pages
+      pages returned by sortedPages
+    \return
+      one flag per block, page by page in the order of _pages
+*/
+//>=------------------------------------------------------------------------=<//
+std::vector<char> ObjectAllocator::liveMap(
+  const std::vector<BYTE*>& _pages) const
+{
+  unsigned perPage = config_.ObjectsPerPage_;
+  std::vector<char> live(_pages.size() * perPage, 1);
+
+  for (const GenericObject* obj = freelist_; obj; obj = obj->Next)
+  {
+    const BYTE* block = reinterpret_cast<const BYTE*>(obj);
+    size_t page = std::upper_bound(_pages.begin(), _pages.end(), block) -
+                  _pages.begin() - 1;
+    size_t index = (block - (_pages[page] + ptrSize + headerOffset_)) /
+                   blockOffset_;
+    live[page * perPage + index] = 0;
+  }
+
+  for (const BYTE* block = carveNext_; block != carveEnd_;
+       block += blockOffset_)
+  {
+    size_t page = std::upper_bound(_pages.begin(), _pages.end(), block) -
+                  _pages.begin() - 1;
+    size_t index = (block - (_pages[page] + ptrSize + headerOffset_)) /
+                   blockOffset_;
+    live[page * perPage + index] = 0;
+  }
+
+  return live;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Unlinks the pages that aren't kept, drops their blocks from the
+      freelist and returns them to the page source. Pages that aren't kept
+      must not have any block in use.
+    \param _pages
+      pages returned by sortedPages
+    \param _keep
+      one flag per page, 0 frees the page
+    \return
+      number of pages freed
+*/
+//>=------------------------------------------------------------------------=<//
+unsigned ObjectAllocator::releasePages(const std::vector<BYTE*>& _pages,
+  const std::vector<char>& _keep)
+{
+  auto kept = [&](const void* _address)
+  {
+    const BYTE* address = reinterpret_cast<const BYTE*>(_address);
+    return _keep[std::upper_bound(_pages.begin(), _pages.end(), address) -
+                 _pages.begin() - 1] != 0;
+  };
+
+  //  the freelist runs through the pages, so it's fixed before they go
+  GenericObject** link = &freelist_;
+  while (*link)
+  {
+    if (kept(*link))
+      link = &(*link)->Next;
+    else
+      *link = (*link)->Next;
+  }
+
+  //  only the newest page can have uncarved blocks
+  if (pagelist_ && not kept(pagelist_))
+    carveNext_ = carveEnd_ = nullptr;
+
+  unsigned freed = 0;
+  link = &pagelist_;
+  while (*link)
+  {
+    if (kept(*link))
+    {
+      link = &(*link)->Next;
+      continue;
+    }
+
+    BYTE* page = reinterpret_cast<BYTE*>(*link);
+    *link = (*link)->Next;
+    pageSource_->ReleasePage(page, pageBytes_);
+
+    //  update stats
+    stats_.PagesInUse_ -= 1;
+    stats_.FreeObjects_ -= config_.ObjectsPerPage_;
+    ++freed;
+  }
+
+  return freed;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Moves an object to a free block. The header goes with it, except for
+      the use counter, which belongs to the block.
+    \param _from
+      block in use
+    \param _to
+      free block taking its place
+*/
+//>=------------------------------------------------------------------------=<//
+void ObjectAllocator::relocateBlock(BYTE* _from, BYTE* _to)
+{
+  //  to a profiler, the object was freed and allocated again
+  if (profiler_)
+  {
+    profiler_->OnFree(_from, stats_.ObjectSize_);
+    profiler_->OnAllocate(_to, stats_.ObjectSize_);
+  }
+
+  std::memcpy(_to, _from, stats_.ObjectSize_);
+
+  BYTE* fromHeader = _from - headerOffset_;
+  BYTE* toHeader = _to - headerOffset_;
+
+  if (config_.HBlockInfo_.type_ == config_.hbBasic)
+  {
+    std::memcpy(toHeader, fromHeader, config_.HBlockInfo_.size_);
+  }
+  else if (config_.HBlockInfo_.type_ == config_.hbExtended)
+  {
+    unsigned short use;
+    BYTE* counter = toHeader + config_.HBlockInfo_.additional_;
+
+    std::memcpy(&use, counter, sizeof(use));
+    std::memcpy(toHeader, fromHeader, config_.HBlockInfo_.size_);
+    use += 1;
+    std::memcpy(counter, &use, sizeof(use));
+  }
+  else if (config_.HBlockInfo_.type_ == config_.hbExternal)
+  {
+    MemBlockInfo* from;
+    MemBlockInfo* to;
+    std::memcpy(&from, fromHeader, sizeof(from));
+    std::memcpy(&to, toHeader, sizeof(to));
+
+    unsigned short use = to->use_count + 1;
+    *to = *from;
+    to->use_count = use;
+  }
+
+  relocator_(_from, _to, stats_.ObjectSize_);
 }
 
 //>=------------------------------------------------------------------------=<//
@@ -203,6 +612,26 @@ unsigned ObjectAllocator::ValidatePages(VALIDATECALLBACK _fn) const
   const GenericObject* page = pagelist_;
   unsigned count = 0;
 
+  //  overflows past a guarded block fault on their own, only the slack
+  //  before the guard page can be written to unnoticed
+  if (config_.DebugOn_)
+  {
+    for (const GuardRecord* rec = guardlist_; rec; rec = rec->Next)
+    {
+      const BYTE* slack = reinterpret_cast<const BYTE*>(rec) + guardSpan_ -
+                          guardSlack_;
+      for (size_t i = 0; i < guardSlack_; ++i)
+      {
+        if (slack[i] != PAD_PATTERN)
+        {
+          _fn(slack - stats_.ObjectSize_, stats_.ObjectSize_);
+          ++count;
+          break;
+        }
+      }
+    }
+  }
+
   //  call _fn on all potentially corrupted memory
   while (page)
   {
@@ -229,15 +658,108 @@ unsigned ObjectAllocator::ValidatePages(VALIDATECALLBACK _fn) const
 //>=------------------------------------------------------------------------=<//
 /*!
     \brief
-      Does nothing. Not Implemented
+      Returns every page without an object in use to the page source
     \return
-      N/A
+      Number of pages freed
 */
 //>=------------------------------------------------------------------------=<//
 unsigned ObjectAllocator::FreeEmptyPages()
 {
-  //  not implemented
-  return 0;
+  if (pagelist_ == nullptr)
+    return 0;
+
+  std::vector<BYTE*> pages = sortedPages();
+  std::vector<char> live = liveMap(pages);
+  std::vector<char> keep(pages.size(), 0);
+
+  for (size_t i = 0; i < live.size(); ++i)
+    if (live[i])
+      keep[i / config_.ObjectsPerPage_] = 1;
+
+  return releasePages(pages, keep);
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Moves objects off the emptiest pages into free blocks of the fullest,
+      until objects in use fill the fewest pages possible, then frees the
+      pages that were emptied. Every object is copied along with its header
+      and the relocator is told where it went, so the client can fix its
+      pointers. Objects must be safe to move with memcpy.
+    \return
+      Number of objects moved, 0 if there is no relocator
+*/
+//>=------------------------------------------------------------------------=<//
+unsigned ObjectAllocator::Compact()
+{
+  if (relocator_ == nullptr || pagelist_ == nullptr)
+    return 0;
+
+  //  every free block has to be on the freelist before it can be a target
+  carveAll();
+
+  std::vector<BYTE*> pages = sortedPages();
+  std::vector<char> live = liveMap(pages);
+  unsigned perPage = config_.ObjectsPerPage_;
+
+  std::vector<unsigned> counts(pages.size(), 0);
+  unsigned total = 0;
+  for (size_t i = 0; i < live.size(); ++i)
+  {
+    counts[i / perPage] += live[i];
+    total += live[i];
+  }
+
+  //  the fullest pages stay, the fewest moves fill them
+  std::vector<size_t> order(pages.size());
+  for (size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+  std::stable_sort(order.begin(), order.end(),
+    [&counts](size_t a, size_t b) { return counts[a] > counts[b]; });
+
+  std::vector<char> keep(pages.size(), 0);
+  for (size_t i = 0; i < (total + perPage - 1) / perPage; ++i)
+    keep[order[i]] = 1;
+
+  //  fill the free blocks of kept pages in address order
+  unsigned moved = 0;
+  size_t target = 0;
+  for (size_t i = 0; i < live.size(); ++i)
+  {
+    if (keep[i / perPage] || not live[i])
+      continue;
+
+    while (not keep[target / perPage] || live[target])
+      ++target;
+
+    relocateBlock(
+      pages[i / perPage] + ptrSize + (i % perPage) * blockOffset_ +
+        headerOffset_,
+      pages[target / perPage] + ptrSize + (target % perPage) * blockOffset_ +
+        headerOffset_);
+
+    live[target] = 1;
+    live[i] = 0;
+    ++moved;
+  }
+
+  //  rebuild the freelist from the kept pages, lowest address on top
+  freelist_ = nullptr;
+  for (size_t i = live.size(); i-- > 0; )
+  {
+    if (keep[i / perPage] && not live[i])
+    {
+      GenericObject* obj = reinterpret_cast<GenericObject*>(
+        pages[i / perPage] + ptrSize + (i % perPage) * blockOffset_ +
+        headerOffset_);
+      obj->Next = freelist_;
+      freelist_ = obj;
+    }
+  }
+
+  releasePages(pages, keep);
+  return moved;
 }
 
 //>=------------------------------------------------------------------------=<//
@@ -253,6 +775,34 @@ void ObjectAllocator::SetDebugState(bool _debugState)
   config_.DebugOn_ = _debugState;
 }
 
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Attaches a sampling profiler that is told about every allocation
+      and free. The profiler must outlive the allocator, or be detached.
+    \param _profiler
+      Profiler to report to, null to stop reporting
+*/
+//>=------------------------------------------------------------------------=<//
+void ObjectAllocator::SetProfiler(AllocationProfiler* _profiler)
+{
+  profiler_ = _profiler;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Opts in to compaction. The relocator is called for every object
+      Compact moves, after it was copied to its new block.
+    \param _fn
+      Callback to tell about moved objects, null to turn compaction off
+*/
+//>=------------------------------------------------------------------------=<//
+void ObjectAllocator::SetRelocator(RELOCATECALLBACK _fn)
+{
+  relocator_ = _fn;
+}
+
 //>=------------------------------------------------------------------------=<//
 /*!
     \brief
@@ -308,33 +858,92 @@ OAStats ObjectAllocator::GetStats() const
 //>=------------------------------------------------------------------------=<//
 /*!
     \brief
-      Allocates a new page and places it onto the pagelist
+      Reports how full each page is. Occupancy isn't tracked, it is counted
+      here by walking the pages and the freelist, so this is meant for
+      occasional fragmentation reports rather than every frame.
+    \return
+      Pages by fraction of blocks in use
 */
 //>=------------------------------------------------------------------------=<//
-void ObjectAllocator::allocatePage()
+OAOccupancy ObjectAllocator::GetOccupancy() const
 {
-  if (stats_.PagesInUse_ >= config_.MaxPages_)
-    throw OAException(OAException::E_NO_PAGES, "No extra pages available");
+  OAOccupancy occupancy;
 
-  BYTE* page;
+  if (pagelist_ == nullptr)
+    return occupancy;
 
+  std::vector<BYTE*> pages;
+  std::vector<char> live;
   try
   {
-    //  initilize a page to zeros
-    page = new BYTE[stats_.PageSize_]();
+    pages = sortedPages();
+    live = liveMap(pages);
   }
   catch (std::bad_alloc&)
   {
     throw OAException(OAException::E_NO_MEMORY, "No system memory free");
   }
 
+  unsigned perPage = config_.ObjectsPerPage_;
+  for (size_t page = 0; page < pages.size(); ++page)
+  {
+    unsigned count = 0;
+    for (unsigned i = 0; i < perPage; ++i)
+      count += live[page * perPage + i];
+
+    unsigned bucket = count * OAOccupancy::OCCUPANCY_BUCKETS / perPage;
+    if (bucket >= OAOccupancy::OCCUPANCY_BUCKETS)
+      bucket = OAOccupancy::OCCUPANCY_BUCKETS - 1;
+
+    occupancy.Occupancy_[bucket] += 1;
+    if (count == 0)
+      occupancy.EmptyPages_ += 1;
+  }
+
+  return occupancy;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Returns the alignment every block is guaranteed to have. Header and
+      pad bytes can leave it below the alignment of the pages.
+    \return
+      Power of two every block's address is a multiple of
+*/
+//>=------------------------------------------------------------------------=<//
+size_t ObjectAllocator::GetBlockAlignment() const
+{
+  return blockAlign_;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Allocates a new page and places it onto the pagelist
+*/
+//>=------------------------------------------------------------------------=<//
+void ObjectAllocator::allocatePage()
+{
+  //  a MaxPages_ of 0 means there is no limit on the number of pages
+  if (config_.MaxPages_ && stats_.PagesInUse_ >= config_.MaxPages_)
+    throw OAException(OAException::E_NO_PAGES, "No extra pages available");
+
+  //  left uninitialized, blocks are only touched once they are carved
+  BYTE* page = static_cast<BYTE*>(pageSource_->AcquirePage(pageBytes_));
+
+  if (page == nullptr)
+    throw OAException(OAException::E_NO_MEMORY, "No system memory free");
+
   pushPagelist(page);
 }
 
 //>=------------------------------------------------------------------------=<//
 /*!
     \brief
-      Takes a page pointer and places on front of pagelist
+      Takes a page pointer and places on front of pagelist. None of the
+      blocks are threaded onto the freelist here, instead the carve pointer
+      is reset to the first block so they can be handed out on demand.
     \param _pageBlock
       pointer to the page
 */
@@ -345,18 +954,67 @@ void ObjectAllocator::pushPagelist(BYTE* _pageBlock)
   page->Next = pagelist_;
   pagelist_ = page;
 
-  for (size_t i = 0; i < config_.ObjectsPerPage_; ++i)
-  {
-    BYTE* block = _pageBlock + ptrSize + i * blockOffset_ + headerOffset_;
-
-    popFreelist(block, &ObjectAllocator::setPatternUnalloc);
-  }
+  //  a new page is only requested once the previous one is fully carved,
+  //  so the newest page is the only one that can have untouched blocks
+  carveNext_ = _pageBlock + ptrSize + headerOffset_;
+  carveEnd_ = carveNext_ + config_.ObjectsPerPage_ * blockOffset_;
 
   //  update stats
   stats_.PagesInUse_ += 1;
   stats_.FreeObjects_ += config_.ObjectsPerPage_;
 }
 
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Hands out the next never-used block on the newest page and moves the
+      carve pointer past it. The block's header and pad bytes have never been
+      written, so they are initialized here instead of when the page is made.
+    \return
+      block ready to be given to the client
+*/
+//>=------------------------------------------------------------------------=<//
+GenericObject* ObjectAllocator::carveBlock()
+{
+  BYTE* block = carveNext_;
+  carveNext_ += blockOffset_;
+
+  //  headers are read before they are written (use counter, in-use flag)
+  std::memset(block - headerOffset_, 0, config_.HBlockInfo_.size_);
+
+  //  point the external header at this block's entry in the side table
+  if (sideTableOffset_)
+  {
+    BYTE* page = reinterpret_cast<BYTE*>(pagelist_);
+    size_t index = (block - (page + ptrSize + headerOffset_)) / blockOffset_;
+    MemBlockInfo* info = reinterpret_cast<MemBlockInfo*>(
+      page + sideTableOffset_) + index;
+    *info = MemBlockInfo{ false, nullptr, 0, 0 };
+    std::memcpy(block - headerOffset_, &info, sizeof(info));
+  }
+
+  GenericObject* obj = reinterpret_cast<GenericObject*>(block);
+  setPatternUnalloc(obj);
+
+  return obj;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Checks if a block is still waiting to be carved from the newest page
+    \param _object
+      Object to check
+    \return
+      Whether or not the block has ever been handed out
+*/
+//>=------------------------------------------------------------------------=<//
+bool ObjectAllocator::isUncarved(const void* _object) const
+{
+  const BYTE* block = reinterpret_cast<const BYTE*>(_object);
+  return block >= carveNext_ && block < carveEnd_;
+}
+
 //>=------------------------------------------------------------------------=<//
 /*!
     \brief
@@ -372,12 +1030,22 @@ void ObjectAllocator::pushPagelist(BYTE* _pageBlock)
 GenericObject* ObjectAllocator::popFreelist(const char* _label,
   PATTERNCALLBACK _fn)
 {
-  //  allocate a new page if no more space
-  if (freelist_ == nullptr)
-    allocatePage();
+  GenericObject* obj;
+
+  //  recycled blocks are preferred, they are likely still in cache
+  if (freelist_)
+  {
+    obj = freelist_;
+    freelist_ = freelist_->Next;
+  }
+  else
+  {
+    //  allocate a new page if no more space
+    if (carveNext_ == carveEnd_)
+      allocatePage();
 
-  GenericObject* obj = freelist_;
-  freelist_ = freelist_->Next;
+    obj = carveBlock();
+  }
   
   //  call pattern setting function
   (this->*_fn)(obj);
@@ -514,7 +1182,8 @@ void ObjectAllocator::headerSetterExtended(BYTE* _header, short unsigned _use,
 //>=------------------------------------------------------------------------=<//
 /*!
     \brief
-      Set up for the External header
+      Set up for the External header. The header points at the block's
+      entry in its page's side table, so nothing is allocated per block.
     \param _header
       Pointer to the location to write to
     \param _build
@@ -528,26 +1197,198 @@ void ObjectAllocator::headerSetterExtended(BYTE* _header, short unsigned _use,
 void ObjectAllocator::headerSetterExternal(BYTE* _header, bool _build, 
   const char* _label, unsigned _allocs)
 {
-  //  if build is true, construct header, else, destroy it
+  MemBlockInfo* info;
+  std::memcpy(&info, _header, sizeof(info));
+
+  //  if build is true, fill in the entry, else, clear it
   if (_build)
   {
-    try
-    {
-      *(reinterpret_cast<MemBlockInfo**>(_header)) = new MemBlockInfo{ true,
-                            const_cast<char*>(_label), _allocs };
-    }
-    catch (std::bad_alloc&)
-    {
-      throw OAException(OAException::E_NO_MEMORY, "No system memory free");
-    }
+    info->in_use = true;
+    info->label = internLabel(_label);
+    info->alloc_num = _allocs;
+    info->use_count += 1;
   }
   else
   {
-    delete *(reinterpret_cast<MemBlockInfo**>(_header));
-    std::memset(_header, 0, config_.HBlockInfo_.size_);
+    //  the use counter is kept for the life of the page
+    info->in_use = false;
+    info->label = nullptr;
+    info->alloc_num = 0;
   }
 }
 
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Returns the allocator's own copy of a label, so the client's string
+      doesn't have to outlive the block. Consecutive allocations usually
+      share a label, so the last one is checked before the pool.
+    \param _label
+      Label given to Allocate
+    \return
+      Pooled copy of the label, or null if there was no label
+*/
+//>=------------------------------------------------------------------------=<//
+const char* ObjectAllocator::internLabel(const char* _label)
+{
+  if (_label == nullptr)
+    return nullptr;
+
+  if (lastLabel_ && std::strcmp(lastLabel_, _label) == 0)
+    return lastLabel_;
+
+  std::string_view key(_label);
+  auto it = labels_.find(key);
+  if (it != labels_.end())
+    return lastLabel_ = it->second.get();
+
+  try
+  {
+    //  the copy is owned by the map and never moves, so the key's view and
+    //  the pointer handed out stay valid until the allocator is destroyed
+    std::unique_ptr<char[]> copy(new char[key.size() + 1]);
+    std::memcpy(copy.get(), _label, key.size() + 1);
+    const char* label = copy.get();
+    labels_.emplace(std::string_view(label, key.size()), std::move(copy));
+    lastLabel_ = label;
+  }
+  catch (std::bad_alloc&)
+  {
+    throw OAException(OAException::E_NO_MEMORY, "No system memory free");
+  }
+
+  return lastLabel_;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Maps a block of its own with an inaccessible page right after it.
+      The mapping starts with a GuardRecord, the block is pushed against the
+      guard page so writing past it faults immediately.
+    \param _label
+      Optional label kept in the guard record
+    \return
+      allocated memory for client
+*/
+//>=------------------------------------------------------------------------=<//
+GenericObject* ObjectAllocator::guardAllocate(const char* _label)
+{
+  //  the page limit still bounds how many blocks can be live at once
+  if (config_.MaxPages_ && stats_.ObjectsInUse_ >=
+      config_.MaxPages_ * config_.ObjectsPerPage_)
+    throw OAException(OAException::E_NO_PAGES, "No extra pages available");
+
+  size_t page = systemPageSize();
+  BYTE* mapping = static_cast<BYTE*>(mapPages(guardSpan_ + page));
+  if (mapping == nullptr)
+    throw OAException(OAException::E_NO_MEMORY, "No system memory free");
+
+  if (not protectPages(mapping + guardSpan_, page))
+  {
+    unmapPages(mapping, guardSpan_ + page);
+    throw OAException(OAException::E_NO_MEMORY, "No system memory free");
+  }
+
+  GuardRecord* rec = new (mapping) GuardRecord{ nullptr, guardlist_, _label,
+                                                stats_.Allocations_ + 1,
+                                                guardMagic };
+  if (guardlist_)
+    guardlist_->Prev = rec;
+  guardlist_ = rec;
+
+  BYTE* slack = mapping + guardSpan_ - guardSlack_;
+  BYTE* block = slack - stats_.ObjectSize_;
+
+  if (config_.DebugOn_)
+  {
+    std::memset(block, ALLOCATED_PATTERN, stats_.ObjectSize_);
+    std::memset(slack, PAD_PATTERN, guardSlack_);
+  }
+
+  return reinterpret_cast<GenericObject*>(block);
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Makes a guarded block inaccessible. Without a quarantine the mapping is
+      released right away, otherwise it stays protected until it is the
+      oldest of QuarantineSize_ freed blocks. Freeing a block twice faults
+      when its record is read.
+    \param _object
+      Pointer to memory to release
+*/
+//>=------------------------------------------------------------------------=<//
+void ObjectAllocator::guardFree(void* _object)
+{
+  GuardRecord* rec = guardRecord(_object);
+  size_t page = systemPageSize();
+
+  if (rec->Prev) rec->Prev->Next = rec->Next;
+  else           guardlist_ = rec->Next;
+  if (rec->Next) rec->Next->Prev = rec->Prev;
+  rec->Magic = 0;
+
+  BYTE* mapping = reinterpret_cast<BYTE*>(rec);
+
+  if (config_.QuarantineSize_ == 0)
+  {
+    unmapPages(mapping, guardSpan_ + page);
+    return;
+  }
+
+  if (config_.DebugOn_)
+    std::memset(_object, FREED_PATTERN, stats_.ObjectSize_);
+
+  protectPages(mapping, guardSpan_);
+
+  //  the oldest quarantined block finally goes back to the system
+  if (quarantined_ == config_.QuarantineSize_)
+    unmapPages(quarantine_[quarantineNext_], guardSpan_ + page);
+  else
+    ++quarantined_;
+
+  quarantine_[quarantineNext_] = mapping;
+  quarantineNext_ = (quarantineNext_ + 1) % config_.QuarantineSize_;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Finds the record at the start of a guarded block's mapping
+    \param _object
+      Pointer to a guarded block
+    \return
+      The block's record
+    \exception
+      When debugging, can throw if: _object not on block boundary
+                                    _object has corrupted slack bytes
+*/
+//>=------------------------------------------------------------------------=<//
+ObjectAllocator::GuardRecord* ObjectAllocator::guardRecord(void* _object) const
+{
+  BYTE* slack = reinterpret_cast<BYTE*>(_object) + stats_.ObjectSize_;
+  BYTE* mapping = slack + guardSlack_ - guardSpan_;
+  GuardRecord* rec = reinterpret_cast<GuardRecord*>(mapping);
+
+  if (config_.DebugOn_)
+  {
+    //  guarded blocks always end right where a page does
+    size_t offset = reinterpret_cast<size_t>(slack + guardSlack_);
+    if (offset % systemPageSize() != 0 || rec->Magic != guardMagic)
+      throw OAException(OAException::E_BAD_BOUNDARY,
+                        "Pointer not on block boundary");
+
+    for (size_t i = 0; i < guardSlack_; ++i)
+      if (slack[i] != PAD_PATTERN)
+        throw OAException(OAException::E_CORRUPTED_BLOCK,
+                          "Pointer has corrupted pad bytes");
+  }
+
+  return rec;
+}
+
 //>=------------------------------------------------------------------------=<//
 /*!
     \brief
@@ -589,6 +1430,10 @@ void ObjectAllocator::verifyPointer(const void* _object) const
 //>=------------------------------------------------------------------------=<//
 bool ObjectAllocator::onFreelist(const void* _object) const
 {
+  //  blocks that were never carved count as free, their headers are garbage
+  if (isUncarved(_object))
+    return true;
+
   //  check const-time operation if available
   if (config_.HBlockInfo_.type_ != config_.hbNone)
     return !isHeaderInUse(_object);
@@ -630,9 +1475,10 @@ bool ObjectAllocator::isHeaderInUse(const void* _object) const
   }
   else if (config_.HBlockInfo_.type_ == config_.hbExternal)
   {
-    //  returns whether or not a header exists
-    return (*reinterpret_cast<MemBlockInfo* const*>
-      (obj_block - headerOffset_)) != nullptr;
+    //  returns the flag of the block's side table entry
+    const MemBlockInfo* info;
+    std::memcpy(&info, obj_block - headerOffset_, sizeof(info));
+    return info != nullptr && info->in_use;
   }
 
   //  not sure how you got here
@@ -651,7 +1497,6 @@ bool ObjectAllocator::isHeaderInUse(const void* _object) const
 //>=------------------------------------------------------------------------=<//
 bool ObjectAllocator::badBoundary(const void* _object) const
 {
-  const GenericObject* obj = reinterpret_cast<const GenericObject*>(_object);
   const BYTE* obj_block = reinterpret_cast<const BYTE*>(_object);
   const GenericObject* page = pagelist_;
 
@@ -660,10 +1505,10 @@ bool ObjectAllocator::badBoundary(const void* _object) const
 
   while (page)
   {
-    //  find what page the pointer is on
-    if (obj > page && obj < page + stats_.PageSize_)
+    //  find what page the pointer is on, in bytes (not GenericObjects)
+    const BYTE* page_block = reinterpret_cast<const BYTE*>(page);
+    if (obj_block > page_block && obj_block < page_block + stats_.PageSize_)
     {
-      const BYTE* page_block = reinterpret_cast<const BYTE*>(page);
       size_t page_mem = (obj_block - header_off) - (page_block + ptrSize);
       //  returns if the object is properly aligned. == 0 means aligned
       return static_cast<bool>(page_mem % block_off != 0);
@@ -688,6 +1533,10 @@ bool ObjectAllocator::badBoundary(const void* _object) const
 //>=------------------------------------------------------------------------=<//
 bool ObjectAllocator::badPadBytes(const void* _object) const
 {
+  //  pad bytes of a block that was never carved have not been written yet
+  if (isUncarved(_object))
+    return false;
+
   const BYTE* block = reinterpret_cast<const BYTE*>(_object);
   const BYTE* left_pad = block - config_.PadBytes_;
   const BYTE* right_pad = block + stats_.ObjectSize_;
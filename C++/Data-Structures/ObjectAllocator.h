@@ -9,6 +9,9 @@
 //     + Constructor/Destructor
 //     + Allocating an object
 //     + Freeing and object
+//     + Creating/Destroying typed objects (Create, Destroy, PoolPtr)
+//     + Destroying every live object at once
+//     + Compacting live objects into fewer pages
 //     + Dumping in-use memory
 //     + Verifying pad bytes for corrupted memory
 //     + Enabling/Disabling debug functionality
@@ -16,6 +19,13 @@
 //     + Getter for pagelist
 //     + Getter for configuration
 //     + Getter for statistics
+//     + Page occupancy report
+//
+//   Build: ObjectAllocator.cpp calls into the profiler and page sources, so
+//   AllocationProfiler.cpp and PageSource.cpp must be compiled and linked
+//   alongside it, e.g.
+//     g++ -std=c++17 app.cpp ObjectAllocator.cpp AllocationProfiler.cpp
+//       PageSource.cpp
 //
 //   Hours spent on this assignment: ~35
 //   Specific portions that gave you the most trouble: External Headers
@@ -26,7 +36,47 @@
 #ifndef OBJECTALLOCATORH
 #define OBJECTALLOCATORH
 
+#include <cassert>       // assert
+#include <memory>        // std::unique_ptr
+#include <new>           // placement new
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>       // std::forward
+#include <vector>
+
+class AllocationProfiler;
+class PageSource;
+class ObjectAllocator;
+
+/*!
+  Deleter that destroys an object and returns it to its ObjectAllocator
+*/
+template <typename T>
+class PoolDeleter
+{
+public:
+  //! Binds the deleter to the allocator the object came from
+  PoolDeleter(ObjectAllocator* allocator = nullptr) noexcept :
+    allocator_(allocator) {}
+
+  //! Runs the destructor and frees the block
+  void operator()(T* Object) const;
+
+  //! Allocator the deleter frees to
+  ObjectAllocator* allocator() const noexcept
+  {
+    return allocator_;
+  }
+
+private:
+  ObjectAllocator* allocator_; //!< allocator the object came from
+};
+
+//! Owning pointer to an object created by ObjectAllocator::Create
+template <typename T>
+using PoolPtr = std::unique_ptr<T, PoolDeleter<T>>;
 
 // If the client doesn't specify these:
 static const int DEFAULT_OBJECTS_PER_PAGE = 4;
@@ -47,14 +97,15 @@ public:
     E_NO_PAGES,       //!< out of logical memory (max pages has been reached)
     E_BAD_BOUNDARY,   //!< block address is on a page, but not a block-boundary
     E_MULTIPLE_FREE,  //!< block has already been freed
-    E_CORRUPTED_BLOCK //!< block has been corrupted (pad bytes overwritten)
+    E_CORRUPTED_BLOCK, //!< block has been corrupted (pad bytes overwritten)
+    E_BAD_ALIGNMENT   //!< type needs more alignment than the blocks have
   };
 
   /*!
     Constructor
 
     \param ErrCode
-      One of the 5 error codes listed above
+      One of the error codes listed above
 
     \param Message
       A message returned by the what method.
@@ -72,7 +123,7 @@ public:
     Retrieves the error code
 
     \return
-      One of the 5 error codes.
+      One of the error codes.
   */
   OA_EXCEPTION code() const {
     return error_code_;
@@ -165,6 +216,17 @@ struct OAConfig
 
     \param Alignment
       The number of bytes to align on.
+
+    \param GuardPages
+      Places every block against an inaccessible page instead of on a page
+      shared with other blocks. Overflows fault at the offending write.
+
+    \param QuarantineSize
+      With guard pages, number of freed blocks kept inaccessible before
+      their memory is returned to the system. Use-after-free faults.
+
+    \param Source
+      Where pages come from, null for the heap. Must outlive the OA.
   */
   OAConfig(bool UseCPPMemManager = false,
     unsigned ObjectsPerPage = DEFAULT_OBJECTS_PER_PAGE,
@@ -172,13 +234,19 @@ struct OAConfig
     bool DebugOn = false,
     unsigned PadBytes = 0,
     const HeaderBlockInfo& HBInfo = HeaderBlockInfo(),
-    unsigned Alignment = 0) : UseCPPMemManager_(UseCPPMemManager),
+    unsigned Alignment = 0,
+    bool GuardPages = false,
+    unsigned QuarantineSize = 0,
+    PageSource* Source = nullptr) : UseCPPMemManager_(UseCPPMemManager),
     ObjectsPerPage_(ObjectsPerPage),
     MaxPages_(MaxPages),
     DebugOn_(DebugOn),
     PadBytes_(PadBytes),
     HBlockInfo_(HBInfo),
-    Alignment_(Alignment)
+    Alignment_(Alignment),
+    GuardPages_(GuardPages),
+    QuarantineSize_(QuarantineSize),
+    PageSource_(Source)
   {
     HBlockInfo_ = HBInfo;
     LeftAlignSize_ = 0;
@@ -203,6 +271,12 @@ struct OAConfig
   unsigned LeftAlignSize_;
   //! number of alignment bytes required between remaining blocks
   unsigned InterAlignSize_;
+  //! place each block against an inaccessible guard page
+  bool GuardPages_;
+  //! freed guarded blocks kept inaccessible before being released
+  unsigned QuarantineSize_;
+  //! where pages are acquired from (null=heap)
+  PageSource* PageSource_;
 };
 
 
@@ -227,6 +301,25 @@ struct OAStats
   unsigned Deallocations_; //!< total requests to free memory
 };
 
+/*!
+  POD that holds how full the pages of an ObjectAllocator are
+*/
+struct OAOccupancy
+{
+  //! number of occupancy buckets, each covers a tenth of a page
+  static const unsigned OCCUPANCY_BUCKETS = 10;
+
+  /*!
+    Constructor
+  */
+  OAOccupancy() : EmptyPages_(0), Occupancy_() {};
+
+  unsigned EmptyPages_;    //!< pages with no objects in use
+  //! pages by fraction of blocks in use: bucket i holds pages that are
+  //! i/10 to (i+1)/10 full, full pages are in the last bucket
+  unsigned Occupancy_[OCCUPANCY_BUCKETS];
+};
+
 /*!
   This allows us to easily treat raw objects as nodes in a linked list
 */
@@ -236,13 +329,15 @@ struct GenericObject
 };
 
 /*!
-  This is used with external headers
+  This is used with external headers. One is kept per block in a side table
+  at the end of each page, the header only points at it.
 */
 struct MemBlockInfo
 {
-  bool in_use;        //!< Is the block free or in use?
-  char* label;        //!< A dynamically allocated NUL-terminated string
-  unsigned alloc_num; //!< The allocation number (count) of this block
+  bool in_use;              //!< Is the block free or in use?
+  const char* label;        //!< Interned NUL-terminated string (or null)
+  unsigned alloc_num;       //!< The allocation number (count) of this block
+  unsigned short use_count; //!< Number of times the block was allocated
 };
 
 /*!
@@ -256,6 +351,8 @@ public:
   typedef void (*DUMPCALLBACK)(const void*, size_t);
   //! Callback function when validating blocks
   typedef void (*VALIDATECALLBACK)(const void*, size_t);
+  //! Callback function when an object was moved (from, to, size of object)
+  typedef void (*RELOCATECALLBACK)(const void*, void*, size_t);
 
     // Predefined values for memory signatures
   //! New memory never given to the client
@@ -284,6 +381,25 @@ public:
   // Throws an exception if the the object can't be freed. (Invalid object)
   void Free(void* Object);
 
+  // Allocates an object and constructs it with the given arguments
+  // Throws an exception if the obj can't be allocated or constructed
+  template <typename T, typename... Args>
+  T* Create(Args&&... args);
+
+  // Same as Create, but the object is owned by a PoolPtr
+  template <typename T, typename... Args>
+  PoolPtr<T> CreatePtr(Args&&... args);
+
+  // Destroys an object made by Create and returns its block (null is ignored)
+  template <typename T>
+  void Destroy(T* Object);
+
+  // Destroys every object still in use, all of which must be T's, and
+  // returns their blocks. Returns the number of objects destroyed. A
+  // destructor may destroy other objects of this allocator.
+  template <typename T>
+  unsigned DestroyAll();
+
   // Calls the callback fn for each block still in use
   unsigned DumpMemoryInUse(DUMPCALLBACK fn) const;
 
@@ -293,15 +409,23 @@ public:
   // Frees all empty pages (extra credit)
   unsigned FreeEmptyPages();
 
+  // Moves objects in use into the fewest pages and frees the pages left
+  // empty. Needs a relocator, returns the number of objects moved.
+  unsigned Compact();
+
   // Returns true if FreeEmptyPages and alignments are implemented
   static bool ImplementedExtraCredit();
 
     // Testing/Debugging/Statistic methods
   void SetDebugState(bool State);   // true=enable, false=disable
+  void SetProfiler(AllocationProfiler* Profiler); // null=disable
+  void SetRelocator(RELOCATECALLBACK Fn); // null=objects can't be moved
   const void* GetFreeList() const;  // returns a pointer to internal free list
   const void* GetPageList() const;  // returns a pointer to internal page list
   OAConfig GetConfig() const;       // returns the configuration parameters
-  OAStats GetStats() const;         // returns the statistics for the allocator
+  OAStats GetStats() const;         // returns the statistics
+  OAOccupancy GetOccupancy() const; // reports page fullness (walks pages)
+  size_t GetBlockAlignment() const; // alignment every block is guaranteed
 
     // Prevent copy construction and assignment
   //! Do not implement!
@@ -314,6 +438,8 @@ private:
   using BYTE = unsigned char;
   //! Callback function when setting pattern bytes
   typedef void (ObjectAllocator::* PATTERNCALLBACK)(GenericObject*);
+  //! Bookkeeping at the start of each guarded mapping
+  struct GuardRecord;
 
   GenericObject* pagelist_; //!< the beginning of the list of pages
   GenericObject* freelist_; //!< the beginning of the list of objects
@@ -321,6 +447,26 @@ private:
   OAStats stats_;           //!< tracked statistics
   size_t headerOffset_;    //!< size in bytes to offset for header
   size_t blockOffset_;     //!< size in bytes of total block size
+  size_t blockAlign_;      //!< alignment every block is guaranteed to have
+  AllocationProfiler* profiler_; //!< sampling profiler, null when disabled
+  RELOCATECALLBACK relocator_; //!< told about moved objects, null when off
+  GuardRecord* guardlist_;  //!< live guarded blocks (guard page mode)
+  BYTE** quarantine_;       //!< ring of freed guarded mappings
+  unsigned quarantined_;    //!< number of mappings in the quarantine
+  unsigned quarantineNext_; //!< next quarantine slot to use
+  size_t guardSpan_;        //!< accessible bytes of each guarded mapping
+  size_t guardSlack_;       //!< bytes between a guarded block and its guard
+  size_t sideTableOffset_;  //!< offset of the MemBlockInfo table in a page
+  //! interned external labels, keyed by a view of the owned copy so a
+  //! lookup doesn't have to build a string
+  std::unordered_map<std::string_view, std::unique_ptr<char[]>> labels_;
+  const char* lastLabel_;   //!< most recently interned label
+  PageSource* pageSource_;  //!< where pages come from
+  size_t pageBytes_;        //!< bytes acquired for each page
+  BYTE* carveNext_;        //!< next never-used block on the newest page
+  BYTE* carveEnd_;         //!< one past the last block on the newest page
+  //! blocks DestroyAll has yet to reach, null outside of it
+  std::unordered_set<void*>* sweeping_;
 
   //>=------------------------=<//
   //>=--  Helper functions  --=<//
@@ -330,10 +476,29 @@ private:
   void allocatePage();
   // Takes a page and sets to front of pagelist
   void pushPagelist(BYTE* Page);
+  // Bumps the carve pointer and prepares a never-used block
+  GenericObject* carveBlock();
+  // returns whether a block has not yet been carved from the newest page
+  bool isUncarved(const void* Object) const;
   // Takes object off front of freelist and returns to client
   GenericObject* popFreelist(const char* label, PATTERNCALLBACK fn);
   // Puts a freed object onto freelist
   void popFreelist(void* Object, PATTERNCALLBACK fn);
+  // Returns a block that is known to be in use, without any checks
+  void releaseBlock(void* Object);
+  // Returns every block still in use (none with new/delete)
+  std::vector<void*> collectLiveBlocks() const;
+  // Carves every block left on the newest page onto the freelist
+  void carveAll();
+  // Returns every page, sorted by address
+  std::vector<BYTE*> sortedPages() const;
+  // Flags every block of the sorted pages, 1=in use, 0=free
+  std::vector<char> liveMap(const std::vector<BYTE*>& Pages) const;
+  // Frees the sorted pages not flagged to keep, returns how many
+  unsigned releasePages(const std::vector<BYTE*>& Pages,
+                        const std::vector<char>& Keep);
+  // Copies an object and its header to a free block, tells the relocator
+  void relocateBlock(BYTE* From, BYTE* To);
 
   // Used to create header blocks when desired
   void generateHeader(void* Object, const char* label = 0);
@@ -348,6 +513,15 @@ private:
   // Builds an external header
   void headerSetterExternal(BYTE* Header, bool build, const char* label = 0, 
                          unsigned allocs = 0);
+  // Returns the pooled copy of a label
+  const char* internLabel(const char* label);
+
+  // Maps a block against a guard page and gives it to the client. Can throw.
+  GenericObject* guardAllocate(const char* label);
+  // Protects a guarded block and moves it into the quarantine. Can throw.
+  void guardFree(void* Object);
+  // Finds the record of a guarded block (debug checks if enabled)
+  GuardRecord* guardRecord(void* Object) const;
 
   // Several checks to verify returned pointer
   void verifyPointer(const void* Object) const;
@@ -368,4 +542,128 @@ private:
   void setPatternFreed(GenericObject* Object);
 };
 
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Allocates a block and constructs a T in it. The block is freed if
+      the constructor throws. Throws E_BAD_ALIGNMENT if the block layout
+      can't guarantee alignof(T).
+    \param _args
+      arguments forwarded to T's constructor
+    \return
+      the new object
+*/
+//>=------------------------------------------------------------------------=<//
+template <typename T, typename... Args>
+T* ObjectAllocator::Create(Args&&... _args)
+{
+  //  blocks are only as big as the allocator's objects
+  assert(sizeof(T) <= stats_.ObjectSize_);
+
+  //  headers and pad bytes can leave blocks less aligned than T needs
+  if (alignof(T) > blockAlign_)
+    throw OAException(OAException::E_BAD_ALIGNMENT,
+      "Create: type needs more alignment than the allocator's blocks have");
+
+  void* block = Allocate();
+  try
+  {
+    return new (block) T(std::forward<Args>(_args)...);
+  }
+  catch (...)
+  {
+    Free(block);
+    throw;
+  }
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Creates a T owned by a pointer that destroys it through this allocator
+    \param _args
+      arguments forwarded to T's constructor
+    \return
+      owning pointer to the new object
+*/
+//>=------------------------------------------------------------------------=<//
+template <typename T, typename... Args>
+PoolPtr<T> ObjectAllocator::CreatePtr(Args&&... _args)
+{
+  return PoolPtr<T>(Create<T>(std::forward<Args>(_args)...),
+                    PoolDeleter<T>(this));
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Runs the destructor of an object made by Create and frees its block
+    \param _object
+      object to destroy
+*/
+//>=------------------------------------------------------------------------=<//
+template <typename T>
+void ObjectAllocator::Destroy(T* _object)
+{
+  if (_object == nullptr)
+    return;
+
+  _object->~T();
+  Free(const_cast<void*>(static_cast<const volatile void*>(_object)));
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Runs the destructor of every object still in use and returns its
+      block. Blocks are found with one walk of the pages, and are not
+      checked the way Free checks them.
+    \return
+      number of objects destroyed, including any destroyed by destructors
+*/
+//>=------------------------------------------------------------------------=<//
+template <typename T>
+unsigned ObjectAllocator::DestroyAll()
+{
+  std::vector<void*> live = collectLiveBlocks();
+
+  //  a destructor that destroys a sibling frees its block through
+  //  releaseBlock, which takes it out of here so the sweep skips it
+  std::unordered_set<void*> pending(live.begin(), live.end());
+  sweeping_ = &pending;
+  try
+  {
+    for (void* block : live)
+    {
+      if (pending.count(block) == 0)
+        continue;
+
+      static_cast<T*>(block)->~T();
+      releaseBlock(block);
+    }
+  }
+  catch (...)
+  {
+    sweeping_ = nullptr;
+    throw;
+  }
+  sweeping_ = nullptr;
+
+  return static_cast<unsigned>(live.size());
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Destroys an object and returns it to the allocator it came from
+    \param _object
+      object to destroy
+*/
+//>=------------------------------------------------------------------------=<//
+template <typename T>
+void PoolDeleter<T>::operator()(T* _object) const
+{
+  allocator_->Destroy(_object);
+}
+
 #endif
@@ -0,0 +1,451 @@
+//>=------------------------------------------------------------------------=<//
+// file:    ObjectAllocatorBench.cpp
+// author:  Tristan Baskerville
+// course:  CS280
+// brief:
+//   This file contains a stress and throughput benchmark for the Object
+//   Allocator, measured against new/delete, malloc/free and
+//   std::pmr::unsynchronized_pool_resource.
+//
+//   Single threaded runs cover every combination of:
+//     + header type (none, basic, extended, external)
+//     + pad bytes (0, 8)
+//     + debugging (off, on)
+//     + object size (8B to 4KB)
+//     + free order (LIFO, FIFO, random)
+//   and report throughput plus p50/p99/p99.9 latency of each call.
+//
+//   Multi threaded runs pair producer threads, which allocate, with
+//   consumer threads, which free, so every block is freed on a different
+//   thread than the one that allocated it. ObjectAllocator needs a mutex
+//   for this, ConcurrentObjectAllocator doesn't.
+//
+//   Build (optimized, asserts off) and run:
+//     g++ -std=c++17 -O2 -DNDEBUG ObjectAllocatorBench.cpp
+//       ObjectAllocator.cpp ConcurrentObjectAllocator.cpp PageSource.cpp
+//       AllocationProfiler.cpp -lpthread -o oabench
+//     ./oabench [--ops N] [--batch N] [--threads N] [--csv]
+//
+// Copyright © 2020 DigiPen, All rights reserved.
+//>=------------------------------------------------------------------------=<//
+
+#include "ObjectAllocator.h"
+#include "ConcurrentObjectAllocator.h"
+#include <algorithm>       // std::nth_element, std::shuffle
+#include <atomic>          // std::atomic
+#include <chrono>          // std::chrono::steady_clock
+#include <cstdio>          // std::printf
+#include <cstdlib>         // std::malloc, std::free, std::atoi
+#include <cstring>         // std::strcmp, std::memset
+#include <memory>          // std::unique_ptr
+#include <memory_resource> // std::pmr::unsynchronized_pool_resource
+#include <mutex>           // std::mutex
+#include <random>          // std::mt19937
+#include <string>          // std::string
+#include <thread>          // std::thread
+#include <vector>          // std::vector
+
+namespace
+{
+  using Clock = std::chrono::steady_clock;
+
+  /*!
+    Order blocks are freed in, relative to the order they were allocated
+  */
+  enum class Order { LIFO, FIFO, Random };
+
+  /*!
+    Command line settings
+  */
+  struct Options
+  {
+    unsigned Ops = 200000;  //!< allocations per single threaded run
+    unsigned Batch = 256;   //!< blocks allocated before any is freed
+    unsigned Threads = 4;   //!< producer/consumer pairs
+    bool Csv = false;       //!< machine readable output
+  };
+
+  /*!
+    Result of one single threaded run
+  */
+  struct Result
+  {
+    double OpsPerSec;   //!< allocations and frees per second
+    double Alloc[3];    //!< p50/p99/p99.9 Allocate latency (ns)
+    double Free[3];     //!< p50/p99/p99.9 Free latency (ns)
+  };
+
+  //  objects per page, so a page is around 64KB like a typical slab
+  unsigned objectsPerPage(size_t size)
+  {
+    size_t count = 64 * 1024 / size;
+    return static_cast<unsigned>(count < 16 ? 16 : count);
+  }
+
+  //  p50/p99/p99.9 of a set of samples, which get reordered
+  void percentiles(std::vector<unsigned>& samples, double out[3])
+  {
+    static const double points[3] = { 0.50, 0.99, 0.999 };
+    if (samples.empty())
+    {
+      out[0] = out[1] = out[2] = 0;
+      return;
+    }
+
+    for (int i = 0; i < 3; ++i)
+    {
+      size_t n = static_cast<size_t>(points[i] * (samples.size() - 1));
+      std::nth_element(samples.begin(), samples.begin() + n, samples.end());
+      out[i] = samples[n];
+    }
+  }
+
+  //  nanoseconds between two time points
+  unsigned nanoseconds(Clock::time_point start, Clock::time_point end)
+  {
+    return static_cast<unsigned>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+        .count());
+  }
+
+  /*!
+    Adapter over an ObjectAllocator
+  */
+  struct OAAdapter
+  {
+    ObjectAllocator oa;
+    OAAdapter(size_t size, const OAConfig& config) : oa(size, config) {}
+    void* allocate() { return oa.Allocate("bench"); }
+    void release(void* block) { oa.Free(block); }
+  };
+
+  /*!
+    Adapter over new/delete
+  */
+  struct NewAdapter
+  {
+    size_t size;
+    void* allocate() { return new unsigned char[size]; }
+    void release(void* block) { delete[] static_cast<unsigned char*>(block); }
+  };
+
+  /*!
+    Adapter over malloc/free
+  */
+  struct MallocAdapter
+  {
+    size_t size;
+    void* allocate() { return std::malloc(size); }
+    void release(void* block) { std::free(block); }
+  };
+
+  /*!
+    Adapter over the standard library's single threaded pool
+  */
+  struct PmrAdapter
+  {
+    size_t size;
+    std::pmr::unsynchronized_pool_resource pool;
+    void* allocate() { return pool.allocate(size); }
+    void release(void* block) { pool.deallocate(block, size); }
+  };
+
+  //>=----------------------------------------------------------------------=<//
+  /*!
+      \brief
+        Allocates batches of blocks and frees them in the given order. The
+        first pass times the whole run, the second times every call.
+      \param _alloc
+        allocator adapter
+      \param _size
+        size of each block, every byte is written once
+      \param _order
+        order blocks of a batch are freed in
+      \param _options
+        number of operations and batch size
+      \return
+        throughput and latencies
+  */
+  //>=----------------------------------------------------------------------=<//
+  template <typename Adapter>
+  Result run(Adapter& _alloc, size_t _size, Order _order,
+             const Options& _options)
+  {
+    std::vector<void*> blocks(_options.Batch);
+    std::vector<unsigned> order(_options.Batch);
+    for (unsigned i = 0; i < _options.Batch; ++i)
+      order[i] = _order == Order::LIFO ? _options.Batch - 1 - i : i;
+
+    std::mt19937 random(280);
+    unsigned rounds = (_options.Ops + _options.Batch - 1) / _options.Batch;
+    Result result;
+
+    //  throughput, nothing but the calls and one write per block
+    Clock::duration total{};
+    for (unsigned r = 0; r < rounds; ++r)
+    {
+      if (_order == Order::Random)
+        std::shuffle(order.begin(), order.end(), random);
+
+      Clock::time_point start = Clock::now();
+      for (unsigned i = 0; i < _options.Batch; ++i)
+      {
+        blocks[i] = _alloc.allocate();
+        std::memset(blocks[i], 0, _size < 64 ? _size : 64);
+      }
+      for (unsigned i = 0; i < _options.Batch; ++i)
+        _alloc.release(blocks[order[i]]);
+      total += Clock::now() - start;
+    }
+
+    double seconds = std::chrono::duration<double>(total).count();
+    //  a run too short for the clock to see has no meaningful rate
+    result.OpsPerSec = seconds > 0 ? 2.0 * rounds * _options.Batch / seconds
+                                   : 0;
+
+    //  latency, the clock is read around every call
+    std::vector<unsigned> allocs, frees;
+    allocs.reserve(rounds * _options.Batch);
+    frees.reserve(rounds * _options.Batch);
+    for (unsigned r = 0; r < rounds; ++r)
+    {
+      if (_order == Order::Random)
+        std::shuffle(order.begin(), order.end(), random);
+
+      for (unsigned i = 0; i < _options.Batch; ++i)
+      {
+        Clock::time_point start = Clock::now();
+        blocks[i] = _alloc.allocate();
+        allocs.push_back(nanoseconds(start, Clock::now()));
+      }
+      for (unsigned i = 0; i < _options.Batch; ++i)
+      {
+        Clock::time_point start = Clock::now();
+        _alloc.release(blocks[order[i]]);
+        frees.push_back(nanoseconds(start, Clock::now()));
+      }
+    }
+
+    percentiles(allocs, result.Alloc);
+    percentiles(frees, result.Free);
+    return result;
+  }
+
+  //  prints a single threaded result
+  void report(const Options& _options, const std::string& _name,
+              size_t _size, Order _order, const Result& _result)
+  {
+    static const char* orders[] = { "LIFO", "FIFO", "Random" };
+    const char* format = _options.Csv ?
+      "%s,%zu,%s,%.0f,%.0f,%.0f,%.0f,%.0f,%.0f,%.0f\n" :
+      "%-34s %5zu %-6s %8.2f  %5.0f %6.0f %7.0f  %5.0f %6.0f %7.0f\n";
+    double ops = _options.Csv ? _result.OpsPerSec : _result.OpsPerSec / 1e6;
+
+    std::printf(format, _name.c_str(), _size,
+      orders[static_cast<int>(_order)], ops,
+      _result.Alloc[0], _result.Alloc[1], _result.Alloc[2],
+      _result.Free[0], _result.Free[1], _result.Free[2]);
+  }
+
+  //  name of an ObjectAllocator configuration
+  std::string configName(OAConfig::HBLOCK_TYPE _type, unsigned _pad,
+                         bool _debug)
+  {
+    static const char* headers[] = { "none", "basic", "extended", "external" };
+    return std::string("OA hdr=") + headers[_type] + " pad=" +
+      std::to_string(_pad) + (_debug ? " debug" : "");
+  }
+
+  /*!
+    Single producer/single consumer ring handing blocks to a consumer
+  */
+  struct Ring
+  {
+    static const unsigned SIZE = 1024;                //!< slots in the ring
+    void* slots[SIZE];                                //!< blocks in flight
+    alignas(64) std::atomic<unsigned> head{ 0 };      //!< next slot to fill
+    alignas(64) std::atomic<unsigned> tail{ 0 };      //!< next slot to empty
+  };
+
+  //>=----------------------------------------------------------------------=<//
+  /*!
+      \brief
+        Runs producer/consumer pairs over a shared allocator. Producers
+        allocate and hand blocks over a ring, consumers free them.
+      \param _allocate
+        allocates a block, called from producer threads
+      \param _release
+        frees a block, called from consumer threads
+      \param _options
+        number of operations and threads
+      \return
+        allocations and frees per second, over all threads
+  */
+  //>=----------------------------------------------------------------------=<//
+  template <typename Allocate, typename Release>
+  double producerConsumer(Allocate _allocate, Release _release,
+                          const Options& _options)
+  {
+    unsigned perThread = _options.Ops;
+    std::unique_ptr<Ring[]> rings(new Ring[_options.Threads]);
+    std::vector<std::thread> threads;
+
+    Clock::time_point start = Clock::now();
+    for (unsigned t = 0; t < _options.Threads; ++t)
+    {
+      Ring& ring = rings[t];
+      threads.emplace_back([&ring, &_allocate, perThread]()
+      {
+        for (unsigned i = 0; i < perThread; ++i)
+        {
+          void* block = _allocate();
+          unsigned head = ring.head.load(std::memory_order_relaxed);
+          while (head - ring.tail.load(std::memory_order_acquire) == Ring::SIZE)
+            std::this_thread::yield();
+          ring.slots[head % Ring::SIZE] = block;
+          ring.head.store(head + 1, std::memory_order_release);
+        }
+      });
+      threads.emplace_back([&ring, &_release, perThread]()
+      {
+        for (unsigned i = 0; i < perThread; ++i)
+        {
+          unsigned tail = ring.tail.load(std::memory_order_relaxed);
+          while (ring.head.load(std::memory_order_acquire) == tail)
+            std::this_thread::yield();
+          _release(ring.slots[tail % Ring::SIZE]);
+          ring.tail.store(tail + 1, std::memory_order_release);
+        }
+      });
+    }
+
+    for (std::thread& thread : threads)
+      thread.join();
+
+    double seconds = std::chrono::duration<double>(Clock::now() - start)
+                       .count();
+    return 2.0 * perThread * _options.Threads / seconds;
+  }
+
+  //  runs every allocator through the producer/consumer pattern
+  void runThreaded(const Options& _options)
+  {
+    static const size_t sizes[] = { 8, 64, 512 };
+    const char* format = _options.Csv ? "%s,%zu,%u,%.0f\n"
+                                      : "%-34s %5zu %7u %8.2f\n";
+    double scale = _options.Csv ? 1.0 : 1e-6;
+
+    if (_options.Csv)
+      std::printf("\nallocator,size,threads,ops_per_sec\n");
+    else
+      std::printf("\n%-34s %5s %7s %8s\n", "producer/consumer", "size",
+                  "threads", "Mops/s");
+
+    for (size_t size : sizes)
+    {
+      ObjectAllocator oa(size, OAConfig(false, objectsPerPage(size), 0));
+      std::mutex mutex;
+      double ops = producerConsumer(
+        [&]() { std::lock_guard<std::mutex> lock(mutex); return oa.Allocate(); },
+        [&](void* b) { std::lock_guard<std::mutex> lock(mutex); oa.Free(b); },
+        _options);
+      std::printf(format, "ObjectAllocator + mutex", size,
+                  _options.Threads, ops * scale);
+
+      ConcurrentObjectAllocator coa(size, OAConfig(false,
+                                    objectsPerPage(size), 0));
+      ops = producerConsumer([&]() { return coa.Allocate(); },
+                             [&](void* b) { coa.Free(b); }, _options);
+      std::printf(format, "ConcurrentObjectAllocator", size,
+                  _options.Threads, ops * scale);
+
+      ops = producerConsumer([&]() { return new unsigned char[size]; },
+        [&](void* b) { delete[] static_cast<unsigned char*>(b); }, _options);
+      std::printf(format, "new/delete", size, _options.Threads, ops * scale);
+
+      ops = producerConsumer([&]() { return std::malloc(size); },
+                             [&](void* b) { std::free(b); }, _options);
+      std::printf(format, "malloc/free", size, _options.Threads, ops * scale);
+    }
+  }
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Runs every benchmark and prints the results
+    \param argc
+      number of arguments
+    \param argv
+      --ops N, --batch N, --threads N, --csv
+    \return
+      0
+*/
+//>=------------------------------------------------------------------------=<//
+int main(int argc, char** argv)
+{
+  Options options;
+  for (int i = 1; i < argc; ++i)
+  {
+    if (std::strcmp(argv[i], "--csv") == 0)
+      options.Csv = true;
+    else if (i + 1 < argc && std::strcmp(argv[i], "--ops") == 0)
+      options.Ops = static_cast<unsigned>(std::atoi(argv[++i]));
+    else if (i + 1 < argc && std::strcmp(argv[i], "--batch") == 0)
+      options.Batch = static_cast<unsigned>(std::atoi(argv[++i]));
+    else if (i + 1 < argc && std::strcmp(argv[i], "--threads") == 0)
+      options.Threads = static_cast<unsigned>(std::atoi(argv[++i]));
+  }
+  if (options.Ops == 0) options.Ops = 1;
+  if (options.Batch == 0) options.Batch = 1;
+
+  static const size_t sizes[] = { 8, 64, 512, 4096 };
+  static const Order orders[] = { Order::LIFO, Order::FIFO, Order::Random };
+  static const OAConfig::HBLOCK_TYPE headers[] = { OAConfig::hbNone,
+    OAConfig::hbBasic, OAConfig::hbExtended, OAConfig::hbExternal };
+  static const unsigned pads[] = { 0, 8 };
+
+  if (options.Csv)
+    std::printf("allocator,size,order,ops_per_sec,alloc_p50,alloc_p99,"
+                "alloc_p999,free_p50,free_p99,free_p999\n");
+  else
+    std::printf("%-34s %5s %-6s %8s  %5s %6s %7s  %5s %6s %7s\n",
+      "allocator", "size", "order", "Mops/s", "a.p50", "a.p99", "a.p999",
+      "f.p50", "f.p99", "f.p999");
+
+  for (size_t size : sizes)
+  {
+    for (Order order : orders)
+    {
+      NewAdapter newDelete{ size };
+      report(options, "new/delete", size, order,
+             run(newDelete, size, order, options));
+
+      MallocAdapter malloc{ size };
+      report(options, "malloc/free", size, order,
+             run(malloc, size, order, options));
+
+      PmrAdapter pmr{ size, {} };
+      report(options, "pmr::unsynchronized_pool_resource", size, order,
+             run(pmr, size, order, options));
+
+      for (OAConfig::HBLOCK_TYPE header : headers)
+      {
+        for (unsigned pad : pads)
+        {
+          for (bool debug : { false, true })
+          {
+            OAConfig config(false, objectsPerPage(size), 0, debug, pad,
+                            OAConfig::HeaderBlockInfo(header));
+            OAAdapter oa(size, config);
+            report(options, configName(header, pad, debug), size, order,
+                   run(oa, size, order, options));
+          }
+        }
+      }
+    }
+  }
+
+  runThreaded(options);
+  return 0;
+}
@@ -0,0 +1,445 @@
+//>=------------------------------------------------------------------------=<//
+// file:    PageSource.cpp
+// author:  Tristan Baskerville
+// course:  CS280
+// brief:
+//   This file contains the implementation for the HeapPageSource and
+//   SlabPageSource classes.
+//
+// Copyright © 2020 DigiPen, All rights reserved.
+//>=------------------------------------------------------------------------=<//
+
+#include "PageSource.h"
+#include <cstddef> // std::max_align_t
+#include <new>     // std::nothrow
+
+#if defined(_WIN32)
+  #include <windows.h>
+#else
+  #include <sys/mman.h>
+  #include <unistd.h>
+  #if defined(__linux__)
+    #include <sys/syscall.h>
+  #endif
+#endif
+
+namespace
+{
+  //  every page handed out keeps the alignment new[] would give it
+  constexpr size_t pageAlign = alignof(std::max_align_t);
+  //  size of a transparent/reserved huge page on common systems
+  constexpr size_t hugePageSize = 2 * 1024 * 1024;
+  //  offset of the first page in a slab, the slab's record gets a cache
+  //  line to itself
+  constexpr size_t slabHeader = 64;
+
+  //  rounds a size up to a multiple of a power of two
+  size_t roundUp(size_t bytes, size_t multiple)
+  {
+    return (bytes + multiple - 1) & ~(multiple - 1);
+  }
+
+  //  size of a virtual memory page
+  size_t systemPageSize()
+  {
+#if defined(_WIN32)
+    static const size_t size = []()
+    {
+      SYSTEM_INFO info;
+      GetSystemInfo(&info);
+      return static_cast<size_t>(info.dwPageSize);
+    }();
+#else
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    return size;
+  }
+
+  //  writes to every page of a mapping so it is backed before it's used
+  void prefault(unsigned char* memory, size_t bytes)
+  {
+    for (size_t i = 0; i < bytes; i += systemPageSize())
+      static_cast<volatile unsigned char*>(memory)[i] = 0;
+  }
+
+  //  binds a mapping to a NUMA node, before any of it is faulted in
+  bool bindNode(void* memory, size_t bytes, int node)
+  {
+#if defined(__linux__) && defined(SYS_mbind)
+    //  from numaif.h, which isn't always installed
+    const int mpolBind = 2;
+    const unsigned long maxNodes = sizeof(unsigned long) * 8;
+
+    if (node < 0 || static_cast<unsigned long>(node) >= maxNodes)
+      return false;
+
+    unsigned long mask = 1ul << node;
+    return syscall(SYS_mbind, memory, bytes, mpolBind, &mask, maxNodes,
+                   0) == 0;
+#else
+    (void)memory; (void)bytes; (void)node;
+    return false;
+#endif
+  }
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Returns the source used when an allocator doesn't specify one
+    \return
+      shared heap page source
+*/
+//>=------------------------------------------------------------------------=<//
+PageSource* PageSource::Heap()
+{
+  static HeapPageSource heap;
+  return &heap;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Any page size can come from the heap
+    \param _pageSize
+      size of each page
+    \param _maxPages
+      allocator's page limit
+    \return
+      true
+*/
+//>=------------------------------------------------------------------------=<//
+bool HeapPageSource::Reserve(size_t _pageSize, unsigned _maxPages)
+{
+  (void)_pageSize; (void)_maxPages;
+  return true;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Gets a page from new[], left uninitialized
+    \param _pageSize
+      size of the page
+    \return
+      the page, or null when out of memory
+*/
+//>=------------------------------------------------------------------------=<//
+void* HeapPageSource::AcquirePage(size_t _pageSize)
+{
+  return new (std::nothrow) unsigned char[_pageSize];
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Gives a page back to delete[]
+    \param _page
+      page returned by AcquirePage
+    \param _pageSize
+      size of the page
+*/
+//>=------------------------------------------------------------------------=<//
+void HeapPageSource::ReleasePage(void* _page, size_t _pageSize)
+{
+  (void)_pageSize;
+  delete[] static_cast<unsigned char*>(_page);
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      ctor for a SlabPageSource instance
+    \param _config
+      configuration of the slabs
+*/
+//>=------------------------------------------------------------------------=<//
+SlabPageSource::SlabPageSource(const SlabConfig& _config) :
+  config_(_config),
+  stats_(),
+  pageSize_(0),
+  pageStride_(0),
+  maxPages_(0),
+  slabs_(nullptr),
+  freePages_(nullptr),
+  next_(nullptr),
+  end_(nullptr)
+{
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      destructor for a SlabPageSource instance, unmaps every slab
+*/
+//>=------------------------------------------------------------------------=<//
+SlabPageSource::~SlabPageSource()
+{
+  while (slabs_)
+  {
+    Slab* slab = slabs_;
+    slabs_ = slabs_->Next;
+
+#if defined(_WIN32)
+    VirtualFree(slab, 0, MEM_RELEASE);
+#else
+    munmap(slab, slab->Bytes);
+#endif
+  }
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Fixes the page size. With a page limit, one slab holding every page
+      the allocator may ask for is mapped now.
+    \param _pageSize
+      size of each page
+    \param _maxPages
+      allocator's page limit (0=unlimited)
+    \return
+      false if the source already serves another page size or the slab
+      couldn't be mapped
+*/
+//>=------------------------------------------------------------------------=<//
+bool SlabPageSource::Reserve(size_t _pageSize, unsigned _maxPages)
+{
+  if (pageSize_)
+    return pageSize_ == _pageSize;
+
+  pageSize_ = _pageSize;
+  pageStride_ = roundUp(_pageSize, pageAlign);
+  maxPages_ = _maxPages;
+
+  if (maxPages_ && not mapSlab(maxPages_))
+  {
+    pageSize_ = 0;
+    return false;
+  }
+
+  return true;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Reuses a released page, otherwise takes the next page of the newest
+      slab, mapping another slab when there is no page limit
+    \param _pageSize
+      size of the page
+    \return
+      the page, or null when out of memory
+*/
+//>=------------------------------------------------------------------------=<//
+void* SlabPageSource::AcquirePage(size_t _pageSize)
+{
+  if (_pageSize != pageSize_ && not (pageSize_ == 0 && Reserve(_pageSize, 0)))
+    return nullptr;
+
+  unsigned char* page;
+
+  if (freePages_)
+  {
+    page = reinterpret_cast<unsigned char*>(freePages_);
+    freePages_ = freePages_->Next;
+  }
+  else
+  {
+    //  a limited slab already holds every page the allocator may use
+    if (next_ == end_ && (maxPages_ ||
+        not mapSlab(config_.SlabSize_ > slabHeader ?
+                    (config_.SlabSize_ - slabHeader) / pageStride_ : 1)))
+      return nullptr;
+
+    page = next_;
+    next_ += pageStride_;
+  }
+
+  stats_.PagesInUse_ += 1;
+  return page;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Keeps a page for the next AcquirePage. Slabs are only unmapped by the
+      destructor.
+    \param _page
+      page returned by AcquirePage
+    \param _pageSize
+      size of the page
+*/
+//>=------------------------------------------------------------------------=<//
+void SlabPageSource::ReleasePage(void* _page, size_t _pageSize)
+{
+  (void)_pageSize;
+
+  FreePage* page = static_cast<FreePage*>(_page);
+  page->Next = freePages_;
+  freePages_ = page;
+
+  stats_.PagesInUse_ -= 1;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Returns the configuration of the source
+    \return
+      Configuration parameters
+*/
+//>=------------------------------------------------------------------------=<//
+SlabConfig SlabPageSource::GetConfig() const
+{
+  return config_;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Returns the currently tracked statistics
+    \return
+      Current statistics
+*/
+//>=------------------------------------------------------------------------=<//
+SlabStats SlabPageSource::GetStats() const
+{
+  return stats_;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Maps a new slab and makes it the one pages are taken from. The slab
+      is rounded up to whole (huge) pages, the extra room holds more pages.
+    \param _pages
+      minimum number of pages the slab has to hold
+    \return
+      whether the slab was mapped
+*/
+//>=------------------------------------------------------------------------=<//
+bool SlabPageSource::mapSlab(size_t _pages)
+{
+  if (_pages == 0)
+    _pages = 1;
+
+  bool huge = config_.Huge_ != HugePages::None;
+  bool bind = config_.NumaNode_ >= 0;
+  size_t bytes = roundUp(slabHeader + _pages * pageStride_,
+                         huge ? hugePageSize : systemPageSize());
+  unsigned char* memory = nullptr;
+  bool hugeTLB = false;
+  bool bound = false;
+
+#if defined(_WIN32)
+  DWORD type = MEM_RESERVE | MEM_COMMIT;
+  DWORD node = bind ? static_cast<DWORD>(config_.NumaNode_)
+                     : NUMA_NO_PREFERRED_NODE;
+
+  //  large pages need SeLockMemoryPrivilege, fall back to regular pages
+  if (config_.Huge_ == HugePages::Explicit && GetLargePageMinimum())
+  {
+    size_t large = roundUp(bytes, GetLargePageMinimum());
+    memory = static_cast<unsigned char*>(VirtualAllocExNuma(
+      GetCurrentProcess(), nullptr, large, type | MEM_LARGE_PAGES,
+      PAGE_READWRITE, node));
+    if (memory)
+    {
+      bytes = large;
+      hugeTLB = true;
+    }
+  }
+
+  if (memory == nullptr)
+    memory = static_cast<unsigned char*>(VirtualAllocExNuma(
+      GetCurrentProcess(), nullptr, bytes, type, PAGE_READWRITE, node));
+
+  if (memory == nullptr)
+    return false;
+
+  //  large pages are always resident
+  bound = bind;
+  if (config_.Prefault_ && not hugeTLB)
+    prefault(memory, bytes);
+#else
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+  int populateFlag = 0;
+
+  //  MAP_POPULATE faults the pages in before they could be bound to a node
+  bool populate = config_.Prefault_ && not bind;
+#if defined(MAP_POPULATE)
+  if (populate)
+    populateFlag = MAP_POPULATE;
+#else
+  populate = false;
+#endif
+
+#if defined(MAP_HUGETLB)
+  //  only succeeds if huge pages were reserved (vm.nr_hugepages)
+  if (config_.Huge_ == HugePages::Explicit)
+  {
+    void* pages = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                       flags | populateFlag | MAP_HUGETLB, -1, 0);
+    if (pages != MAP_FAILED)
+    {
+      memory = static_cast<unsigned char*>(pages);
+      hugeTLB = true;
+    }
+  }
+#endif
+
+  if (memory == nullptr && huge)
+  {
+    //  transparent huge pages need the range aligned to the huge page size,
+    //  so map extra and trim both ends
+    void* pages = mmap(nullptr, bytes + hugePageSize, PROT_READ | PROT_WRITE,
+                       flags, -1, 0);
+    if (pages == MAP_FAILED)
+      return false;
+
+    unsigned char* start = static_cast<unsigned char*>(pages);
+    memory = reinterpret_cast<unsigned char*>(
+      roundUp(reinterpret_cast<size_t>(start), hugePageSize));
+    if (memory != start)
+      munmap(start, memory - start);
+    munmap(memory + bytes, start + hugePageSize - memory);
+
+#if defined(MADV_HUGEPAGE)
+    madvise(memory, bytes, MADV_HUGEPAGE);
+#endif
+    //  the advice has to come before the first touch, populated below
+    populate = false;
+  }
+  else if (memory == nullptr)
+  {
+    void* pages = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                       flags | populateFlag, -1, 0);
+    if (pages == MAP_FAILED)
+      return false;
+    memory = static_cast<unsigned char*>(pages);
+  }
+
+  if (bind)
+    bound = bindNode(memory, bytes, config_.NumaNode_);
+  if (config_.Prefault_ && not populate)
+    prefault(memory, bytes);
+#endif
+
+  Slab* slab = reinterpret_cast<Slab*>(memory);
+  slab->Next = slabs_;
+  slab->Bytes = bytes;
+  slabs_ = slab;
+
+  //  pages are only taken from the newest slab, whatever was left on the
+  //  previous one is lost (less than a page)
+  next_ = memory + slabHeader;
+  end_ = next_ + (bytes - slabHeader) / pageStride_ * pageStride_;
+
+  //  update stats
+  stats_.HugeTLB_ = hugeTLB && (stats_.Slabs_ == 0 || stats_.HugeTLB_);
+  stats_.NumaBound_ = bound && (stats_.Slabs_ == 0 || stats_.NumaBound_);
+  stats_.Slabs_ += 1;
+  stats_.BytesMapped_ += bytes;
+
+  return true;
+}
@@ -0,0 +1,189 @@
+//>=------------------------------------------------------------------------=<//
+// file:    PageSource.h
+// author:  Tristan Baskerville
+// course:  CS280
+// brief:
+//   This file contains the interface for the page sources an ObjectAllocator
+//   can get its pages from.
+//
+//     + HeapPageSource, every page is its own new[] (the default)
+//     + SlabPageSource, pages are carved out of large mmap'd slabs, with
+//       optional huge pages, pre-faulting and NUMA node binding
+//
+//   A slab keeps an allocator's pages next to each other, so fewer TLB
+//   entries cover them, and getting a page is usually a pointer bump.
+//
+// Copyright © 2020 DigiPen, All rights reserved.
+//>=------------------------------------------------------------------------=<//
+
+#ifndef PAGESOURCEH
+#define PAGESOURCEH
+
+#include <cstddef> // size_t
+
+/*!
+  Where an ObjectAllocator gets its pages from
+*/
+class PageSource
+{
+public:
+  //! Destructor
+  virtual ~PageSource() {}
+
+  // Called once by each allocator before its first page. MaxPages is the
+  // allocator's limit (0=unlimited). Returns false if the source can't
+  // serve pages of this size.
+  virtual bool Reserve(size_t PageSize, unsigned MaxPages) = 0;
+
+  // Returns PageSize bytes aligned for any object, or null when out of memory
+  virtual void* AcquirePage(size_t PageSize) = 0;
+
+  // Takes back a page returned by AcquirePage
+  virtual void ReleasePage(void* Page, size_t PageSize) = 0;
+
+  // Source used by allocators that don't specify one, shared and stateless
+  static PageSource* Heap();
+};
+
+/*!
+  Gets every page from new[], as the allocator always has
+*/
+class HeapPageSource : public PageSource
+{
+public:
+  bool Reserve(size_t PageSize, unsigned MaxPages) override;
+  void* AcquirePage(size_t PageSize) override;
+  void ReleasePage(void* Page, size_t PageSize) override;
+};
+
+/*!
+  Huge page modes for a slab
+*/
+enum class HugePages
+{
+  None,        //!< regular pages
+  Transparent, //!< ask for transparent huge pages (madvise)
+  Explicit     //!< reserved huge pages (MAP_HUGETLB), falls back to THP
+};
+
+/*!
+  SlabPageSource configuration parameters
+*/
+struct SlabConfig
+{
+  //! default size of each slab when the allocator has no page limit
+  static const size_t DEFAULT_SLAB_SIZE = 2 * 1024 * 1024;
+
+  /*!
+    Constructor
+
+    \param SlabSize
+      Bytes mapped at a time when the allocator has no page limit. With a
+      limit, a single slab holding every page is mapped up front.
+
+    \param Huge
+      Huge page mode of the slabs.
+
+    \param Prefault
+      Fault every page in when a slab is mapped, instead of on first touch.
+
+    \param NumaNode
+      Node the slab memory is bound to, -1 to leave it to the system.
+  */
+  SlabConfig(size_t SlabSize = DEFAULT_SLAB_SIZE,
+    HugePages Huge = HugePages::None,
+    bool Prefault = false,
+    int NumaNode = -1) : SlabSize_(SlabSize),
+    Huge_(Huge),
+    Prefault_(Prefault),
+    NumaNode_(NumaNode)
+  {
+  }
+
+  size_t SlabSize_; //!< bytes mapped at a time without a page limit
+  HugePages Huge_;  //!< huge page mode
+  bool Prefault_;   //!< fault pages in when the slab is mapped
+  int NumaNode_;    //!< node to bind to (-1=any)
+};
+
+/*!
+  SlabPageSource statistical info
+*/
+struct SlabStats
+{
+  /*!
+    Constructor
+  */
+  SlabStats() : Slabs_(0), BytesMapped_(0), PagesInUse_(0), HugeTLB_(false),
+    NumaBound_(false) {};
+
+  unsigned Slabs_;      //!< number of slabs mapped
+  size_t BytesMapped_;  //!< bytes mapped for all slabs
+  unsigned PagesInUse_; //!< pages handed out and not released
+  bool HugeTLB_;        //!< every slab got reserved huge pages
+  bool NumaBound_;      //!< every slab was bound to the requested node
+};
+
+/*!
+  Sub-allocates pages out of large anonymous mappings. Serves a single
+  allocator (a single page size) and keeps its slabs until destroyed;
+  released pages are reused by the next AcquirePage.
+*/
+class SlabPageSource : public PageSource
+{
+public:
+  // Nothing is mapped until the allocator reserves its pages
+  SlabPageSource(const SlabConfig& config = SlabConfig());
+
+  // Unmaps every slab. Allocators using it must be destroyed first.
+  ~SlabPageSource();
+
+  bool Reserve(size_t PageSize, unsigned MaxPages) override;
+  void* AcquirePage(size_t PageSize) override;
+  void ReleasePage(void* Page, size_t PageSize) override;
+
+  SlabConfig GetConfig() const; // returns the configuration parameters
+  SlabStats GetStats() const;   // returns the statistics for the source
+
+  //! Do not implement!
+  SlabPageSource(const SlabPageSource&) = delete;
+  //! Do not implement!
+  SlabPageSource& operator=(const SlabPageSource&) = delete;
+
+private:
+  /*!
+    Start of every slab, links the slabs for the destructor
+  */
+  struct Slab
+  {
+    Slab* Next;   //!< previously mapped slab
+    size_t Bytes; //!< size of the mapping
+  };
+
+  /*!
+    A released page, until it's handed out again
+  */
+  struct FreePage
+  {
+    FreePage* Next; //!< next released page
+  };
+
+  SlabConfig config_;  //!< configuration
+  SlabStats stats_;    //!< statistics
+  size_t pageSize_;    //!< bytes the allocator asks for (0=not reserved)
+  size_t pageStride_;  //!< distance between two pages in a slab
+  unsigned maxPages_;  //!< allocator's page limit (0=unlimited)
+  Slab* slabs_;        //!< every slab, newest first
+  FreePage* freePages_; //!< released pages
+  unsigned char* next_; //!< next page never handed out
+  unsigned char* end_;  //!< end of the newest slab
+
+  //>=------------------------=<//
+  //>=--  Helper functions  --=<//
+  //>=------------------------=<//
+
+  // Maps a slab big enough for the given number of pages
+  bool mapSlab(size_t Pages);
+};
+
+#endif
@@ -0,0 +1,189 @@
+//>=------------------------------------------------------------------------=<//
+// file:    PoolResource.cpp
+// author:  Tristan Baskerville
+// course:  CS280
+// brief:
+//   This file contains the implementation for the ObjectAllocatorResource
+//   class.
+//
+// Copyright © 2020 DigiPen, All rights reserved.
+//>=------------------------------------------------------------------------=<//
+
+#include "PoolResource.h"
+#include <new> // std::bad_alloc
+
+namespace
+{
+  //  bytes each page aims for when the client doesn't pick a page size
+  constexpr size_t targetPageSize = 16 * 1024;
+  //  never fewer objects than this on a page
+  constexpr unsigned minObjectsPerPage = 16;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      ctor for an ObjectAllocatorResource instance. No pool is created
+      until its size class is first requested.
+    \param _objectsPerPage
+      objects on each page of every pool, 0 sizes pages per size class
+    \param _upstream
+      resource used for requests the pools can't serve
+*/
+//>=------------------------------------------------------------------------=<//
+ObjectAllocatorResource::ObjectAllocatorResource(unsigned _objectsPerPage,
+  std::pmr::memory_resource* _upstream) :
+  pools_(),
+  upstream_(_upstream),
+  objectsPerPage_(_objectsPerPage)
+{
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      destructor for an ObjectAllocatorResource instance. Every container
+      using the resource must already be destroyed.
+*/
+//>=------------------------------------------------------------------------=<//
+ObjectAllocatorResource::~ObjectAllocatorResource() = default;
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Returns the pool serving requests of a given size
+    \param _bytes
+      size of a request
+    \return
+      the pool, or null if the request is not pooled or pool doesn't exist
+*/
+//>=------------------------------------------------------------------------=<//
+const ObjectAllocator* ObjectAllocatorResource::GetPool(size_t _bytes) const
+{
+  int index = sizeClass(_bytes, 1);
+  return index < 0 ? nullptr : pools_[index].get();
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Returns the fallback resource
+    \return
+      upstream resource
+*/
+//>=------------------------------------------------------------------------=<//
+std::pmr::memory_resource* ObjectAllocatorResource::GetUpstream() const
+{
+  return upstream_;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Takes a block from the pool matching the request, creating the pool
+      if needed. Large or over-aligned requests go upstream.
+    \param _bytes
+      size of the request
+    \param _alignment
+      alignment of the request
+    \return
+      allocated memory for client
+    \exception
+      std::bad_alloc when the pool can't grow
+*/
+//>=------------------------------------------------------------------------=<//
+void* ObjectAllocatorResource::do_allocate(size_t _bytes, size_t _alignment)
+{
+  int index = sizeClass(_bytes, _alignment);
+  if (index < 0)
+    return upstream_->allocate(_bytes, _alignment);
+
+  try
+  {
+    std::unique_ptr<ObjectAllocator>& pool = pools_[index];
+    if (not pool)
+    {
+      size_t size = MIN_POOLED_SIZE << index;
+      unsigned perPage = objectsPerPage_;
+      if (perPage == 0)
+      {
+        perPage = static_cast<unsigned>(targetPageSize / size);
+        if (perPage < minObjectsPerPage) perPage = minObjectsPerPage;
+      }
+
+      //  no page limit, no debugging, no headers
+      pool.reset(new ObjectAllocator(size, OAConfig(false, perPage, 0)));
+    }
+
+    return pool->Allocate();
+  }
+  //  memory resources report failure the same way operator new does
+  catch (OAException&)
+  {
+    throw std::bad_alloc();
+  }
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Returns a block to the pool it came from, or to upstream
+    \param _block
+      memory previously returned by do_allocate
+    \param _bytes
+      size of the original request
+    \param _alignment
+      alignment of the original request
+*/
+//>=------------------------------------------------------------------------=<//
+void ObjectAllocatorResource::do_deallocate(void* _block, size_t _bytes,
+  size_t _alignment)
+{
+  int index = sizeClass(_bytes, _alignment);
+  if (index < 0)
+    upstream_->deallocate(_block, _bytes, _alignment);
+  else
+    pools_[index]->Free(_block);
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Blocks can only be freed by the resource that allocated them
+    \param _other
+      resource being compared
+    \return
+      whether the two resources are the same object
+*/
+//>=------------------------------------------------------------------------=<//
+bool ObjectAllocatorResource::do_is_equal(
+  const std::pmr::memory_resource& _other) const noexcept
+{
+  return this == &_other;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Finds the smallest power-of-two size class that fits a request
+    \param _bytes
+      size of the request
+    \param _alignment
+      alignment of the request
+    \return
+      index into pools_, -1 when the request must go upstream
+*/
+//>=------------------------------------------------------------------------=<//
+int ObjectAllocatorResource::sizeClass(size_t _bytes, size_t _alignment)
+{
+  //  blocks sit right after the page's next pointer, so pooled blocks are
+  //  only ever aligned to a pointer
+  if (_bytes > MAX_POOLED_SIZE || _alignment > MAX_POOLED_ALIGN)
+    return -1;
+
+  int index = 0;
+  for (size_t size = MIN_POOLED_SIZE; size < _bytes; size <<= 1)
+    ++index;
+
+  return index;
+}
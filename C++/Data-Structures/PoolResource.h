@@ -0,0 +1,154 @@
+//>=------------------------------------------------------------------------=<//
+// file:    PoolResource.h
+// author:  Tristan Baskerville
+// course:  CS280
+// brief:
+//   This file contains adapters that let standard containers allocate from
+//   ObjectAllocator pools.
+//
+//     + ObjectAllocatorResource, a std::pmr::memory_resource that routes
+//       each request to an ObjectAllocator for its size class, and falls
+//       back to an upstream resource for large or over-aligned requests.
+//     + PoolAllocator<T>, a std::allocator compatible adapter over the same
+//       resource. Node based containers rebind it to their node type, so
+//       every node comes from the pool matching the node's size.
+//
+//   Neither adapter is thread safe, same as ObjectAllocator.
+//
+// Copyright © 2020 DigiPen, All rights reserved.
+//>=------------------------------------------------------------------------=<//
+
+#ifndef POOLRESOURCEH
+#define POOLRESOURCEH
+
+#include "ObjectAllocator.h"
+#include <cstddef>         // std::size_t
+#include <memory>          // std::unique_ptr
+#include <memory_resource> // std::pmr::memory_resource
+
+/*!
+  Number of power-of-two sizes from Min up to Max, counting both ends
+*/
+constexpr unsigned PoolSizeClassCount(size_t Min, size_t Max)
+{
+  return Min >= Max ? 1 : 1 + PoolSizeClassCount(Min * 2, Max);
+}
+
+/*!
+  Memory resource backed by one ObjectAllocator per power-of-two size class
+*/
+class ObjectAllocatorResource : public std::pmr::memory_resource
+{
+public:
+  //! smallest size class, a block has to hold a freelist pointer
+  static const size_t MIN_POOLED_SIZE = sizeof(GenericObject);
+  //! largest size class served by a pool
+  static const size_t MAX_POOLED_SIZE = 512;
+  //! largest alignment every pooled block is guaranteed to have
+  static const size_t MAX_POOLED_ALIGN = alignof(GenericObject);
+
+  // Pools are created the first time their size class is requested.
+  // Requests the pools can't serve are passed on to upstream.
+  ObjectAllocatorResource(unsigned ObjectsPerPage = 0,
+    std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+  // Frees every pool and all of their pages
+  ~ObjectAllocatorResource();
+
+  // Returns the pool used for a request of the given size, or null if the
+  // request goes upstream or the pool hasn't been created yet
+  const ObjectAllocator* GetPool(size_t Bytes) const;
+
+  // Returns the resource used for requests the pools can't serve
+  std::pmr::memory_resource* GetUpstream() const;
+
+  //! Do not implement!
+  ObjectAllocatorResource(const ObjectAllocatorResource&) = delete;
+  //! Do not implement!
+  ObjectAllocatorResource& operator=(const ObjectAllocatorResource&) = delete;
+
+private:
+  //! number of power-of-two size classes between MIN and MAX
+  static const unsigned SIZE_CLASSES =
+    PoolSizeClassCount(MIN_POOLED_SIZE, MAX_POOLED_SIZE);
+  static_assert((MIN_POOLED_SIZE << (SIZE_CLASSES - 1)) == MAX_POOLED_SIZE,
+    "MAX_POOLED_SIZE must be MIN_POOLED_SIZE times a power of two.");
+
+  //! lazily created pool for each size class
+  std::unique_ptr<ObjectAllocator> pools_[SIZE_CLASSES];
+  std::pmr::memory_resource* upstream_; //!< fallback resource
+  unsigned objectsPerPage_;             //!< 0 means sized per class
+
+  // std::pmr::memory_resource interface
+  void* do_allocate(size_t Bytes, size_t Alignment) override;
+  void do_deallocate(void* Block, size_t Bytes, size_t Alignment) override;
+  bool do_is_equal(const std::pmr::memory_resource& Other)
+    const noexcept override;
+
+  // returns the size class index for a request, or -1 to go upstream
+  static int sizeClass(size_t Bytes, size_t Alignment);
+};
+
+/*!
+  std::allocator compatible adapter over an ObjectAllocatorResource. It is
+  cheap to copy and compares equal to any adapter sharing its resource.
+*/
+template <typename T>
+class PoolAllocator
+{
+public:
+  using value_type = T; //!< type being allocated
+
+  //! Allows containers to allocate their node types from the same resource
+  template <typename U>
+  struct rebind
+  {
+    using other = PoolAllocator<U>; //!< rebound adapter
+  };
+
+  //! Binds the adapter to a resource that must outlive every container
+  PoolAllocator(ObjectAllocatorResource* resource) noexcept :
+    resource_(resource) {}
+
+  //! Rebinding copy, shares the resource of the other adapter
+  template <typename U>
+  PoolAllocator(const PoolAllocator<U>& other) noexcept :
+    resource_(other.resource()) {}
+
+  //! Allocates (uninitialized) room for Count objects
+  T* allocate(size_t Count)
+  {
+    return static_cast<T*>(resource_->allocate(Count * sizeof(T), alignof(T)));
+  }
+
+  //! Returns room for Count objects to the resource
+  void deallocate(T* Block, size_t Count) noexcept
+  {
+    resource_->deallocate(Block, Count * sizeof(T), alignof(T));
+  }
+
+  //! Resource this adapter allocates from
+  ObjectAllocatorResource* resource() const noexcept
+  {
+    return resource_;
+  }
+
+private:
+  ObjectAllocatorResource* resource_; //!< resource shared by all rebinds
+};
+
+//! Adapters are interchangeable when they share a resource
+template <typename T, typename U>
+bool operator==(const PoolAllocator<T>& lhs, const PoolAllocator<U>& rhs)
+{
+  return lhs.resource() == rhs.resource();
+}
+
+//! Adapters are interchangeable when they share a resource
+template <typename T, typename U>
+bool operator!=(const PoolAllocator<T>& lhs, const PoolAllocator<U>& rhs)
+{
+  return !(lhs == rhs);
+}
+
+#endif
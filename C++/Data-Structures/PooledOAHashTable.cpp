@@ -0,0 +1,208 @@
+//>=------------------------------------------------------------------------=<//
+// file:    PooledOAHashTable.cpp
+// author:  Tristan Baskerville
+// course:  CS280
+// brief:
+//   This file contains the implementation for the PooledOAHashTable class.
+//
+// Copyright © 2020 DigiPen, All rights reserved.
+//>=------------------------------------------------------------------------=<//
+
+//>=------------------------------------------------------------------------=<//
+/*
+    \brief
+      Constructs the pool and the table. Pool blocks are only aligned to
+      a pointer, so values can't need more than that. Values smaller than
+      a pointer still get a pointer sized block.
+    \param Config
+      configuration settings for the underlying table.
+    \param ValuesPerPage
+      number of values on each page of the pool.
+*/
+//>=------------------------------------------------------------------------=<//
+template<typename T>
+PooledOAHashTable<T>::PooledOAHashTable(const OAHTConfig& Config,
+  unsigned ValuesPerPage)
+  : pool_(VALUE_BLOCK_SIZE, OAConfig(false, ValuesPerPage, 0)),
+    table_(without_free_proc(Config))
+{
+  static_assert(alignof(T) <= alignof(void*),
+                "Pooled values can't be over-aligned");
+}
+
+//>=------------------------------------------------------------------------=<//
+/*
+    \brief
+      Destroys every value still in the table, then the pool frees its pages.
+*/
+//>=------------------------------------------------------------------------=<//
+template<typename T>
+PooledOAHashTable<T>::~PooledOAHashTable()
+{
+  clear();
+}
+
+//>=------------------------------------------------------------------------=<//
+/*
+    \brief
+      Copies the data into a block of the pool and inserts a pointer to it.
+      If the key is a duplicate, or the table can't grow, the copy is
+      destroyed before the exception reaches the client.
+    \param Key
+      String we are hashing to find an appropriate location to store Data.
+    \param Data
+      Data we wish to store in the hash table.
+*/
+//>=------------------------------------------------------------------------=<//
+template<typename T>
+void PooledOAHashTable<T>::insert(const char* Key, const T& Data)
+{
+  T* value;
+
+  try
+  {
+    value = pool_.Create<T>(Data);
+  }
+  //  the table reports running out of memory with its own exception
+  catch (OAException& e)
+  {
+    throw OAHTException(OAHTException::E_NO_MEMORY, e.what());
+  }
+
+  try
+  {
+    table_.insert(Key, value);
+  }
+  catch (...)
+  {
+    pool_.Destroy(value);
+    throw;
+  }
+}
+
+//>=------------------------------------------------------------------------=<//
+/*
+    \brief
+      Removes the key from the table, then destroys its value and returns
+      the block to the pool.
+    \param Key
+      String we are hashing to find the slot we stored data in.
+*/
+//>=------------------------------------------------------------------------=<//
+template<typename T>
+void PooledOAHashTable<T>::remove(const char* Key)
+{
+  //  throws if the key isn't in the table
+  T* value = table_.find(Key);
+
+  table_.remove(Key);
+  pool_.Destroy(value);
+}
+
+//>=------------------------------------------------------------------------=<//
+/*
+    \brief
+      Finds the value stored with a key.
+    \param Key
+      The string we are hashing to find the slot we stored data in.
+    \return
+      A reference to the value in the pool.
+*/
+//>=------------------------------------------------------------------------=<//
+template<typename T>
+const T& PooledOAHashTable<T>::find(const char* Key) const
+{
+  return *table_.find(Key);
+}
+
+//>=------------------------------------------------------------------------=<//
+/*
+    \brief
+      Finds the value stored with a key, which may be changed in place.
+    \param Key
+      The string we are hashing to find the slot we stored data in.
+    \return
+      A reference to the value in the pool.
+*/
+//>=------------------------------------------------------------------------=<//
+template<typename T>
+T& PooledOAHashTable<T>::find(const char* Key)
+{
+  return *table_.find(Key);
+}
+
+//>=------------------------------------------------------------------------=<//
+/*
+    \brief
+      Destroys every value with one walk of the pool, instead of one free
+      per slot, then marks every slot as unoccupied.
+*/
+//>=------------------------------------------------------------------------=<//
+template<typename T>
+void PooledOAHashTable<T>::clear()
+{
+  pool_.DestroyAll<T>();
+  table_.clear();
+}
+
+//>=------------------------------------------------------------------------=<//
+/*
+    \brief
+      Returns the stats of the underlying table.
+    \return
+      The internally tracked stats stored within the hash table.
+*/
+//>=------------------------------------------------------------------------=<//
+template<typename T>
+OAHTStats PooledOAHashTable<T>::GetStats() const
+{
+  return table_.GetStats();
+}
+
+//>=------------------------------------------------------------------------=<//
+/*
+    \brief
+      Returns the stats of the pool holding the values.
+    \return
+      The statistics of the value pool.
+*/
+//>=------------------------------------------------------------------------=<//
+template<typename T>
+OAStats PooledOAHashTable<T>::GetPoolStats() const
+{
+  return pool_.GetStats();
+}
+
+//>=------------------------------------------------------------------------=<//
+/*
+    \brief
+      Returns the slots of the underlying table.
+    \return
+      The internal slot array, Data of occupied slots points into the pool.
+*/
+//>=------------------------------------------------------------------------=<//
+template<typename T>
+typename PooledOAHashTable<T>::OAHTSlot const*
+PooledOAHashTable<T>::GetTable() const
+{
+  return table_.GetTable();
+}
+
+//>=------------------------------------------------------------------------=<//
+/*
+    \brief
+      The pool owns the values, a client free proc would free them twice.
+    \param Config
+      configuration given by the client.
+    \return
+      The same configuration without a free proc.
+*/
+//>=------------------------------------------------------------------------=<//
+template<typename T>
+typename PooledOAHashTable<T>::OAHTConfig
+PooledOAHashTable<T>::without_free_proc(const OAHTConfig& Config)
+{
+  OAHTConfig config = Config;
+  config.FreeProc_ = 0;
+  return config;
+}
@@ -0,0 +1,87 @@
+//>=------------------------------------------------------------------------=<//
+// file:    PooledOAHashTable.h
+// author:  Tristan Baskerville
+// course:  CS280
+// brief:
+//   This file contains the declaration for the PooledOAHashTable class, an
+//   OAHashTable that owns its values.
+//
+//   Values live out-of-line in an ObjectAllocator owned by the table, and
+//   the slots only hold pointers to them:
+//     + insert copies the value into a pooled block
+//     + remove destroys the value and returns its block
+//     + clear destroys every value with a single walk of the pool
+//     + growing the table only moves pointers, never values
+//
+//   No FreeProc is needed, the pool knows every value still in the table.
+//
+// Copyright © 2020 DigiPen, All rights reserved.
+//>=------------------------------------------------------------------------=<//
+#ifndef POOLEDOAHASHTABLEH
+#define POOLEDOAHASHTABLEH
+
+#include "OAHashTable.h"
+#include "ObjectAllocator.h"
+
+//! Objects on each page of a table's value pool, unless configured
+const unsigned DEFAULT_VALUES_PER_PAGE = 64;
+
+//! Hash table (open-addressing) that stores its values in a pool
+template <typename T>
+class PooledOAHashTable
+{
+  public:
+      //! Configuration of the underlying table, its FreeProc_ is ignored
+    typedef typename OAHashTable<T*>::OAHTConfig OAHTConfig;
+      //! Slots of the underlying table, Data points into the pool
+    typedef typename OAHashTable<T*>::OAHTSlot OAHTSlot;
+
+      // Constructor, the pool gets ValuesPerPage values on each page
+    PooledOAHashTable(const OAHTConfig& Config,
+                      unsigned ValuesPerPage = DEFAULT_VALUES_PER_PAGE);
+    ~PooledOAHashTable();  // Destructor, destroys every value
+
+      // Copy the data into the pool and insert it. Throws an exception if
+      // the insertion is unsuccessful.
+    void insert(const char *Key, const T& Data);
+
+      // Destroy an item by key. Throws an exception if the key doesn't exist.
+    void remove(const char *Key);
+
+      // Find and return data by key. Throws an exception (E_ITEM_NOT_FOUND)
+      // if not found.
+    const T& find(const char *Key) const;
+    T& find(const char *Key);
+
+      // Destroys all items at once (Doesn't deallocate table or pool)
+    void clear();
+
+      // Allow the client to peer into the data
+    OAHTStats GetStats() const;
+    OAStats GetPoolStats() const;
+    const OAHTSlot *GetTable() const;
+
+      //! Do not implement!
+    PooledOAHashTable(const PooledOAHashTable&) = delete;
+      //! Do not implement!
+    PooledOAHashTable& operator=(const PooledOAHashTable&) = delete;
+
+  private:
+    typedef OAHashTableException OAHTException; //!< shorthand for my use
+
+    static OAHTConfig without_free_proc(const OAHTConfig& Config);
+
+      //! Free blocks hold the pool's freelist pointer, so a block is never
+      //! smaller than one, and stays a multiple of T's alignment
+    static constexpr size_t VALUE_BLOCK_SIZE =
+      ((sizeof(T) > sizeof(void*) ? sizeof(T) : sizeof(void*)) +
+        alignof(T) - 1) / alignof(T) * alignof(T);
+
+    ObjectAllocator pool_; //!< owns every value in the table
+    OAHashTable<T*> table_; //!< keys and pointers to the values
+};
+
+//  We are using templates and the function definitions must be in this file.
+#include "PooledOAHashTable.cpp"
+
+#endif
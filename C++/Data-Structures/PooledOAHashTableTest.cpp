@@ -0,0 +1,187 @@
+//>=------------------------------------------------------------------------=<//
+// file:    PooledOAHashTableTest.cpp
+// author:  Tristan Baskerville
+// course:  CS280
+// brief:
+//   This file contains tests for the PooledOAHashTable class.
+//
+//     + values smaller than a pointer, whose pool blocks also hold the
+//       pool's freelist pointer once they are freed
+//     + values that survive removals of their neighbours and table growth
+//     + clear destroying every value still in the table
+//
+//   Every check is an assert, so build with asserts on. Support.h comes
+//   with the OAHashTable driver.
+//     g++ -std=c++17 PooledOAHashTableTest.cpp ObjectAllocator.cpp
+//       AllocationProfiler.cpp PageSource.cpp -o pooledtest
+//     ./pooledtest
+//
+// Copyright © 2020 DigiPen, All rights reserved.
+//>=------------------------------------------------------------------------=<//
+
+#undef NDEBUG
+#include "PooledOAHashTable.h"
+#include <cassert> // assert
+#include <cstdio>  // std::printf, std::snprintf
+
+namespace
+{
+  //! number of keys each test inserts
+  const unsigned KEY_COUNT = 500;
+
+  //>=----------------------------------------------------------------------=<//
+  /*!
+      \brief
+        FNV-1a, reduced to the table size
+      \param Key
+        string to hash
+      \param TableSize
+        number of slots in the table
+      \return
+        slot index
+  */
+  //>=----------------------------------------------------------------------=<//
+  unsigned Hash(const char* Key, unsigned TableSize)
+  {
+    unsigned hash = 2166136261u;
+    for (; *Key; ++Key)
+      hash = (hash ^ static_cast<unsigned char>(*Key)) * 16777619u;
+    return hash % TableSize;
+  }
+
+  //>=----------------------------------------------------------------------=<//
+  /*!
+      \brief
+        Writes the key used for an index
+      \param Index
+        index of the key
+      \param Buffer
+        buffer of at least 16 characters
+      \return
+        Buffer
+  */
+  //>=----------------------------------------------------------------------=<//
+  const char* MakeKey(unsigned Index, char* Buffer)
+  {
+    std::snprintf(Buffer, 16, "key%u", Index);
+    return Buffer;
+  }
+
+  //>=----------------------------------------------------------------------=<//
+  /*!
+      \brief
+        Value stored for an index. Neighbouring values differ in every byte,
+        so a freelist pointer written over a neighbour changes it.
+      \param Index
+        index of the key
+      \return
+        value for the key
+  */
+  //>=----------------------------------------------------------------------=<//
+  template <typename T>
+  T MakeValue(unsigned Index)
+  {
+    return static_cast<T>(Index * 37u + 11u);
+  }
+
+  //>=----------------------------------------------------------------------=<//
+  /*!
+      \brief
+        Inserts every key, removes every other one and checks that the rest
+        kept their values, then refills the freed blocks and checks again.
+        Run with a T smaller than a pointer.
+      \param Name
+        name printed for the test
+  */
+  //>=----------------------------------------------------------------------=<//
+  template <typename T>
+  void TestSmallValues(const char* Name)
+  {
+    typedef typename PooledOAHashTable<T>::OAHTConfig Config;
+    PooledOAHashTable<T> table(Config(7, Hash), 16);
+    char key[16];
+
+    for (unsigned i = 0; i < KEY_COUNT; ++i)
+      table.insert(MakeKey(i, key), MakeValue<T>(i));
+
+    assert(table.GetStats().Count_ == KEY_COUNT);
+    assert(table.GetPoolStats().ObjectSize_ >= sizeof(void*));
+
+    //  every freed block now holds a freelist pointer
+    for (unsigned i = 0; i < KEY_COUNT; i += 2)
+      table.remove(MakeKey(i, key));
+
+    for (unsigned i = 1; i < KEY_COUNT; i += 2)
+      assert(table.find(MakeKey(i, key)) == MakeValue<T>(i));
+
+    //  reuses the freed blocks, popping the freelist through them
+    for (unsigned i = 0; i < KEY_COUNT; i += 2)
+      table.insert(MakeKey(i, key), MakeValue<T>(i + 1));
+
+    for (unsigned i = 0; i < KEY_COUNT; ++i)
+      assert(table.find(MakeKey(i, key)) ==
+             MakeValue<T>(i % 2 ? i : i + 1));
+
+    table.clear();
+    assert(table.GetStats().Count_ == 0);
+    assert(table.GetPoolStats().ObjectsInUse_ == 0);
+
+    std::printf("%-24s passed\n", Name);
+  }
+
+  //>=----------------------------------------------------------------------=<//
+  /*!
+      \brief
+        Values bigger than a pointer keep their own size in the pool
+  */
+  //>=----------------------------------------------------------------------=<//
+  void TestLargeValues()
+  {
+    struct Large
+    {
+      double a, b, c; //!< 24 bytes, more than a pointer
+    };
+
+    typedef PooledOAHashTable<Large>::OAHTConfig Config;
+    PooledOAHashTable<Large> table(Config(7, Hash), 16);
+    char key[16];
+
+    for (unsigned i = 0; i < KEY_COUNT; ++i)
+      table.insert(MakeKey(i, key), Large{ i * 1.0, i * 2.0, i * 3.0 });
+
+    assert(table.GetPoolStats().ObjectSize_ == sizeof(Large));
+
+    for (unsigned i = 0; i < KEY_COUNT; i += 3)
+      table.remove(MakeKey(i, key));
+
+    for (unsigned i = 0; i < KEY_COUNT; ++i)
+    {
+      if (i % 3 == 0)
+        continue;
+
+      const Large& value = table.find(MakeKey(i, key));
+      assert(value.a == i * 1.0 && value.b == i * 2.0 && value.c == i * 3.0);
+    }
+
+    std::printf("%-24s passed\n", "large values");
+  }
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Runs every test, any failure aborts
+    \return
+      0 once every test passed
+*/
+//>=------------------------------------------------------------------------=<//
+int main()
+{
+  TestSmallValues<char>("1 byte values");
+  TestSmallValues<unsigned short>("2 byte values");
+  TestSmallValues<unsigned>("4 byte values");
+  TestLargeValues();
+
+  std::printf("all tests passed\n");
+  return 0;
+}
@@ -0,0 +1,688 @@
+//>=------------------------------------------------------------------------=<//
+// file:    TypedObjectAllocator.h
+// author:  Tristan Baskerville
+// course:  CS280
+// brief:
+//   This file contains the interface and implementation for the
+//   TypedObjectAllocator class template. It manages the same page/block
+//   layout as ObjectAllocator, but every feature (headers, pad bytes, debug
+//   patterns, alignment, statistics) is selected at compile time by a
+//   policy type, so disabled features cost nothing.
+//
+//   Public operations include:
+//     + Constructor/Destructor
+//     + Allocating an object
+//     + Freeing an object
+//     + Dumping in-use memory
+//     + Verifying pad bytes for corrupted memory
+//     + Getter for freelist
+//     + Getter for pagelist
+//     + Getter for statistics
+//
+//   A policy is any type providing the static constexpr members found in
+//   OAReleasePolicy below. OAReleasePolicy compiles Allocate/Free down to an
+//   intrusive freelist pop/push, the runtime configured ObjectAllocator is
+//   still available when the configuration must change at runtime.
+//
+// Copyright © 2020 DigiPen, All rights reserved.
+//>=------------------------------------------------------------------------=<//
+
+#ifndef TYPEDOBJECTALLOCATORH
+#define TYPEDOBJECTALLOCATORH
+
+#include "ObjectAllocator.h"
+#include <cstddef> // std::max_align_t
+#include <cstring> // std::memset, std::memcpy
+#include <new>     // std::align_val_t, std::bad_alloc
+
+/*!
+  Policy with every debugging feature disabled. Allocate and Free are a
+  freelist pop and push, pages are carved lazily as in ObjectAllocator.
+*/
+struct OAReleasePolicy
+{
+  //! by-pass the allocator and use new/delete
+  static constexpr bool UseCPPMemManager = false;
+  //! number of objects on each page
+  static constexpr unsigned ObjectsPerPage = 64;
+  //! maximum number of pages the allocator can allocate (0=unlimited)
+  static constexpr unsigned MaxPages = 0;
+  //! enable/disable debugging code (signatures, checks, etc.)
+  static constexpr bool DebugOn = false;
+  //! size of the left/right padding for each block
+  static constexpr unsigned PadBytes = 0;
+  //! header type for each block, hbExternal is not supported
+  static constexpr OAConfig::HBLOCK_TYPE HeaderType = OAConfig::hbNone;
+  //! user-defined bytes for extended headers
+  static constexpr unsigned HeaderAdditional = 0;
+  //! address alignment of each block (0=natural alignment of the type)
+  static constexpr unsigned Alignment = 0;
+  //! update OAStats on every call
+  static constexpr bool TrackStats = false;
+};
+
+/*!
+  Policy mirroring a typical debug ObjectAllocator configuration.
+*/
+struct OADebugPolicy : OAReleasePolicy
+{
+  static constexpr bool DebugOn = true;                                 //!< on
+  static constexpr unsigned PadBytes = 4;                               //!< on
+  static constexpr OAConfig::HBLOCK_TYPE HeaderType = OAConfig::hbBasic;//!< on
+  static constexpr bool TrackStats = true;                              //!< on
+};
+
+/*!
+  Object allocator for objects of type T configured entirely by Policy
+*/
+template <typename T, typename Policy = OAReleasePolicy>
+class TypedObjectAllocator
+{
+public:
+  //! Callback function when dumping memory leaks
+  typedef ObjectAllocator::DUMPCALLBACK DUMPCALLBACK;
+  //! Callback function when validating blocks
+  typedef ObjectAllocator::VALIDATECALLBACK VALIDATECALLBACK;
+
+  static_assert(Policy::HeaderType != OAConfig::hbExternal,
+    "External headers need a runtime label, use ObjectAllocator instead.");
+
+  // Allocates the first page. Throws an exception if the allocation fails.
+  TypedObjectAllocator();
+
+  // Releases every page (never throws)
+  ~TypedObjectAllocator();
+
+  // Take an object from the freelist and give it to the client (simulates new)
+  // Throws an exception if the obj can't be allocated. (Memory alloc problem)
+  void* Allocate();
+
+  // Returns an object to the free list for the client (simulates delete)
+  // Throws an exception if the the object can't be freed. (Invalid object)
+  void Free(void* Object);
+
+  // Calls the callback fn for each block still in use
+  unsigned DumpMemoryInUse(DUMPCALLBACK fn) const;
+
+  // Calls the callback fn for each block that is potentially corrupted
+  unsigned ValidatePages(VALIDATECALLBACK fn) const;
+
+    // Testing/Debugging/Statistic methods
+  const void* GetFreeList() const;  // returns a pointer to internal free list
+  const void* GetPageList() const;  // returns a pointer to internal page list
+  OAStats GetStats() const;         // returns the statistics for the allocator
+
+    // Prevent copy construction and assignment
+  //! Do not implement!
+  TypedObjectAllocator(const TypedObjectAllocator&) = delete;
+  //! Do not implement!
+  TypedObjectAllocator& operator=(const TypedObjectAllocator&) = delete;
+
+private:
+  //! Redef for ease of use
+  using BYTE = unsigned char;
+
+  //! rounds a value up to a multiple of an alignment
+  static constexpr size_t roundUp(size_t value, size_t align)
+  {
+    return align > 1 ? (value + align - 1) / align * align : value;
+  }
+
+  //! largest of two sizes
+  static constexpr size_t maxOf(size_t lhs, size_t rhs)
+  {
+    return lhs > rhs ? lhs : rhs;
+  }
+
+  //! size of each header, computed the same way as HeaderBlockInfo
+  static constexpr size_t headerSize()
+  {
+    if (Policy::HeaderType == OAConfig::hbBasic)
+      return OAConfig::BASIC_HEADER_SIZE;
+    if (Policy::HeaderType == OAConfig::hbExtended)
+      return sizeof(unsigned) + sizeof(unsigned short) + sizeof(char) +
+             Policy::HeaderAdditional;
+    return 0;
+  }
+
+  //! objects must be able to hold a freelist pointer
+  static constexpr size_t ObjectSize = maxOf(sizeof(T), sizeof(GenericObject));
+  //! alignment of every object handed to the client
+  static constexpr size_t BlockAlign = maxOf(Policy::Alignment,
+    maxOf(alignof(T), alignof(GenericObject)));
+  //! alignment of every page, at least what operator new would give
+  static constexpr size_t PageAlign = maxOf(BlockAlign,
+                                            alignof(std::max_align_t));
+  //! size in bytes to offset for header
+  static constexpr size_t HeaderOffset = headerSize() + Policy::PadBytes;
+  //! offset from the start of a page to the first object
+  static constexpr size_t FirstBlock = roundUp(sizeof(GenericObject) +
+                                               HeaderOffset, BlockAlign);
+  //! distance between two objects, including alignment bytes
+  static constexpr size_t BlockStride = roundUp(HeaderOffset + ObjectSize +
+                                                Policy::PadBytes, BlockAlign);
+  //! size of a page including headers, padding, alignment, etc.
+  static constexpr size_t PageSize = FirstBlock + ObjectSize + Policy::PadBytes
+                                   + (Policy::ObjectsPerPage - 1) * BlockStride;
+  //! allocation numbers are needed by headers even without statistics
+  static constexpr bool CountAllocations =
+    Policy::TrackStats || Policy::HeaderType != OAConfig::hbNone;
+
+  static_assert(Policy::ObjectsPerPage > 0, "Pages must hold an object.");
+
+  GenericObject* pagelist_{ nullptr }; //!< the beginning of the list of pages
+  GenericObject* freelist_{ nullptr }; //!< the beginning of the list of objects
+  BYTE* carveNext_{ nullptr };  //!< next never-used block on the newest page
+  BYTE* carveEnd_{ nullptr };   //!< one past the last block on newest page
+  OAStats stats_{};             //!< tracked statistics
+
+  //>=------------------------=<//
+  //>=--  Helper functions  --=<//
+  //>=------------------------=<//
+
+  // Allocates a page and pushes to front of pagelist. Can throw.
+  void allocatePage();
+  // Bumps the carve pointer and prepares a never-used block
+  GenericObject* carveBlock();
+  // Writes the header in front of a block
+  void writeHeader(BYTE* Block, bool InUse);
+
+  // Several checks to verify returned pointer
+  void verifyPointer(const void* Object) const;
+  // returns whether a pointer is on the freelist or never carved
+  bool onFreelist(const void* Object) const;
+  // returns if a freed pointer was on a bad boundary
+  bool badBoundary(const void* Object) const;
+  // returns if a pad byte is found faulty
+  bool badPadBytes(const void* Object) const;
+};
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      ctor for a TypedObjectAllocator instance, allocates the first page
+*/
+//>=------------------------------------------------------------------------=<//
+template <typename T, typename Policy>
+TypedObjectAllocator<T, Policy>::TypedObjectAllocator()
+{
+  stats_.ObjectSize_ = ObjectSize;
+  stats_.PageSize_ = PageSize;
+
+  //  only allocate page if not using new/delete
+  if constexpr (not Policy::UseCPPMemManager)
+    allocatePage();
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      destructor for a TypedObjectAllocator instance
+*/
+//>=------------------------------------------------------------------------=<//
+template <typename T, typename Policy>
+TypedObjectAllocator<T, Policy>::~TypedObjectAllocator()
+{
+  //  there are no pages if the C++ Memory Manager is in use.
+  while (pagelist_)
+  {
+    GenericObject* page = pagelist_;
+    pagelist_ = pagelist_->Next;
+    ::operator delete(page, std::align_val_t(PageAlign));
+  }
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Allocates an object and returns to client
+    \return
+      allocated memory for client
+*/
+//>=------------------------------------------------------------------------=<//
+template <typename T, typename Policy>
+void* TypedObjectAllocator<T, Policy>::Allocate()
+{
+  GenericObject* obj;
+
+  if constexpr (Policy::UseCPPMemManager)
+  {
+    try
+    {
+      obj = reinterpret_cast<GenericObject*>(new BYTE[ObjectSize]);
+    }
+    catch (std::bad_alloc&)
+    {
+      throw OAException(OAException::E_NO_MEMORY, "No system memory free");
+    }
+  }
+  else
+  {
+    //  recycled blocks are preferred, they are likely still in cache
+    if (freelist_)
+    {
+      obj = freelist_;
+      freelist_ = freelist_->Next;
+    }
+    else
+    {
+      //  allocate a new page if no more space
+      if (carveNext_ == carveEnd_)
+        allocatePage();
+
+      obj = carveBlock();
+    }
+
+    if constexpr (Policy::DebugOn)
+      std::memset(obj, ObjectAllocator::ALLOCATED_PATTERN, ObjectSize);
+
+    if constexpr (Policy::HeaderType != OAConfig::hbNone)
+      writeHeader(reinterpret_cast<BYTE*>(obj), true);
+  }
+
+  //  update stats
+  if constexpr (CountAllocations)
+    stats_.Allocations_ += 1;
+
+  if constexpr (Policy::TrackStats)
+  {
+    stats_.FreeObjects_ -= 1;
+    if ((stats_.ObjectsInUse_ += 1) > stats_.MostObjects_)
+      stats_.MostObjects_ = stats_.ObjectsInUse_;
+  }
+
+  return obj;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Takes a pointer from client and "releases" it
+    \param _object
+      Pointer to memory to release
+*/
+//>=------------------------------------------------------------------------=<//
+template <typename T, typename Policy>
+void TypedObjectAllocator<T, Policy>::Free(void* _object)
+{
+  if constexpr (Policy::UseCPPMemManager)
+  {
+    delete [] reinterpret_cast<BYTE*>(_object);
+  }
+  else
+  {
+    if constexpr (Policy::DebugOn)
+      verifyPointer(_object);
+
+    if constexpr (Policy::HeaderType != OAConfig::hbNone)
+      writeHeader(reinterpret_cast<BYTE*>(_object), false);
+
+    if constexpr (Policy::DebugOn)
+      std::memset(_object, ObjectAllocator::FREED_PATTERN, ObjectSize);
+
+    GenericObject* obj = reinterpret_cast<GenericObject*>(_object);
+    obj->Next = freelist_;
+    freelist_ = obj;
+  }
+
+  //  update stats
+  if constexpr (Policy::TrackStats)
+  {
+    stats_.Deallocations_ += 1;
+    stats_.ObjectsInUse_  -= 1;
+    stats_.FreeObjects_   += 1;
+  }
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Dumps memory currently in use by client
+    \param _fn
+      Pointer to client defined callback function
+    \return
+      Total number of objects in use by client
+*/
+//>=------------------------------------------------------------------------=<//
+template <typename T, typename Policy>
+unsigned TypedObjectAllocator<T, Policy>::DumpMemoryInUse(DUMPCALLBACK _fn) const
+{
+  unsigned count = 0;
+
+  for (const GenericObject* page = pagelist_; page; page = page->Next)
+  {
+    const BYTE* byte_page = reinterpret_cast<const BYTE*>(page);
+    for (unsigned i = 0; i < Policy::ObjectsPerPage; ++i)
+    {
+      const BYTE* block = byte_page + FirstBlock + i * BlockStride;
+
+      //  check if the object is in use
+      if (not onFreelist(block))
+      {
+        _fn(block, ObjectSize);
+        ++count;
+      }
+    }
+  }
+
+  return count;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Verifies the pad bytes for corrupted memory
+    \param _fn
+      Pointer to client defined callback function
+    \return
+      Total count of potentially corrupt memory
+*/
+//>=------------------------------------------------------------------------=<//
+template <typename T, typename Policy>
+unsigned TypedObjectAllocator<T, Policy>::ValidatePages(
+  VALIDATECALLBACK _fn) const
+{
+  //  nothing to validate without pad bytes
+  if constexpr (not Policy::DebugOn || Policy::PadBytes == 0)
+  {
+    (void)_fn;
+    return 0;
+  }
+
+  unsigned count = 0;
+
+  for (const GenericObject* page = pagelist_; page; page = page->Next)
+  {
+    const BYTE* byte_page = reinterpret_cast<const BYTE*>(page);
+    for (unsigned i = 0; i < Policy::ObjectsPerPage; ++i)
+    {
+      const BYTE* block = byte_page + FirstBlock + i * BlockStride;
+
+      if (badPadBytes(block))
+      {
+        _fn(block, ObjectSize);
+        ++count;
+      }
+    }
+  }
+
+  //  total count of bad memory found
+  return count;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Returns a pointer to the internal freelist
+    \return
+      freelist
+*/
+//>=------------------------------------------------------------------------=<//
+template <typename T, typename Policy>
+const void* TypedObjectAllocator<T, Policy>::GetFreeList() const
+{
+  return freelist_;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Returns a pointer to the internal pagelist
+    \return
+      pagelist
+*/
+//>=------------------------------------------------------------------------=<//
+template <typename T, typename Policy>
+const void* TypedObjectAllocator<T, Policy>::GetPageList() const
+{
+  return pagelist_;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Returns the currently tracked statistic. Only the sizes and page count
+      are kept up to date unless the policy enables TrackStats.
+    \return
+      Current statistics
+*/
+//>=------------------------------------------------------------------------=<//
+template <typename T, typename Policy>
+OAStats TypedObjectAllocator<T, Policy>::GetStats() const
+{
+  return stats_;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Allocates a new page and places it onto the pagelist. Only the
+      alignment bytes are written here, blocks are set up when carved.
+*/
+//>=------------------------------------------------------------------------=<//
+template <typename T, typename Policy>
+void TypedObjectAllocator<T, Policy>::allocatePage()
+{
+  //  a MaxPages of 0 means there is no limit on the number of pages
+  if (Policy::MaxPages && stats_.PagesInUse_ >= Policy::MaxPages)
+    throw OAException(OAException::E_NO_PAGES, "No extra pages available");
+
+  BYTE* page;
+
+  try
+  {
+    page = static_cast<BYTE*>(
+      ::operator new(PageSize, std::align_val_t(PageAlign)));
+  }
+  catch (std::bad_alloc&)
+  {
+    throw OAException(OAException::E_NO_MEMORY, "No system memory free");
+  }
+
+  GenericObject* pageObj = reinterpret_cast<GenericObject*>(page);
+  pageObj->Next = pagelist_;
+  pagelist_ = pageObj;
+
+  carveNext_ = page + FirstBlock;
+  carveEnd_ = carveNext_ + Policy::ObjectsPerPage * BlockStride;
+
+  //  update stats
+  stats_.PagesInUse_ += 1;
+  if constexpr (Policy::TrackStats)
+    stats_.FreeObjects_ += Policy::ObjectsPerPage;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Hands out the next never-used block on the newest page and moves the
+      carve pointer past it, setting up its header and debug bytes.
+    \return
+      block ready to be given to the client
+*/
+//>=------------------------------------------------------------------------=<//
+template <typename T, typename Policy>
+GenericObject* TypedObjectAllocator<T, Policy>::carveBlock()
+{
+  BYTE* block = carveNext_;
+  carveNext_ += BlockStride;
+
+  if constexpr (Policy::HeaderType != OAConfig::hbNone)
+    std::memset(block - HeaderOffset, 0, headerSize());
+
+  if constexpr (Policy::DebugOn)
+  {
+    //  alignment bytes in front of this block, back to the previous block
+    //  (or the page's next pointer for the first block)
+    BYTE* page = reinterpret_cast<BYTE*>(pagelist_);
+    BYTE* align_begin = (block == page + FirstBlock) ?
+      page + sizeof(GenericObject) :
+      block - BlockStride + ObjectSize + Policy::PadBytes;
+    std::memset(align_begin, ObjectAllocator::ALIGN_PATTERN,
+                (block - HeaderOffset) - align_begin);
+
+    std::memset(block - Policy::PadBytes, ObjectAllocator::PAD_PATTERN,
+                Policy::PadBytes);
+    std::memset(block + ObjectSize, ObjectAllocator::PAD_PATTERN,
+                Policy::PadBytes);
+  }
+
+  return reinterpret_cast<GenericObject*>(block);
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Writes a basic or extended header in front of a block. Fields are
+      copied byte-wise since headers are not necessarily aligned.
+    \param _block
+      Block whose header is written
+    \param _inUse
+      true when allocating, false when freeing
+*/
+//>=------------------------------------------------------------------------=<//
+template <typename T, typename Policy>
+void TypedObjectAllocator<T, Policy>::writeHeader(BYTE* _block, bool _inUse)
+{
+  BYTE* header = _block - HeaderOffset;
+  //  the count is bumped after the header is written, number from 1 like
+  //  ObjectAllocator does
+  unsigned allocs = _inUse ? stats_.Allocations_ + 1 : 0;
+
+  if constexpr (Policy::HeaderType == OAConfig::hbExtended)
+  {
+    //  skip the user defined bytes
+    header += Policy::HeaderAdditional;
+    //  every allocation increments the use counter
+    if (_inUse)
+    {
+      unsigned short use;
+      std::memcpy(&use, header, sizeof(use));
+      ++use;
+      std::memcpy(header, &use, sizeof(use));
+    }
+    header += sizeof(unsigned short);
+  }
+
+  //  allocation # field followed by the in use flag
+  std::memcpy(header, &allocs, sizeof(allocs));
+  header[sizeof(unsigned)] = _inUse ? 1 : 0;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Verifies there are no issues with a freed pointer
+    \param _object
+      Pointer to the memory that was freed
+    \exception
+      Can throw if: _object not on block boundary
+                    _object previosuly freed
+                    _object has corrupted pad bytes
+*/
+//>=------------------------------------------------------------------------=<//
+template <typename T, typename Policy>
+void TypedObjectAllocator<T, Policy>::verifyPointer(const void* _object) const
+{
+  if (badBoundary(_object))
+    throw OAException(OAException::E_BAD_BOUNDARY,
+                      "Pointer not on block boundary");
+
+  if (badPadBytes(_object))
+    throw OAException(OAException::E_CORRUPTED_BLOCK,
+                      "Pointer has corrupted pad bytes");
+
+  if (onFreelist(_object))
+    throw OAException(OAException::E_MULTIPLE_FREE, "Pointer already freed");
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Checks if an object is free, either never carved or on the freelist
+    \param _object
+      Object to check
+    \return
+      Wether or not an object is free
+*/
+//>=------------------------------------------------------------------------=<//
+template <typename T, typename Policy>
+bool TypedObjectAllocator<T, Policy>::onFreelist(const void* _object) const
+{
+  const BYTE* block = reinterpret_cast<const BYTE*>(_object);
+
+  //  blocks that were never carved count as free
+  if (block >= carveNext_ && block < carveEnd_)
+    return true;
+
+  //  check const-time operation if available
+  if constexpr (Policy::HeaderType != OAConfig::hbNone)
+    return block[-static_cast<std::ptrdiff_t>(Policy::PadBytes) - 1] == 0;
+
+  for (const GenericObject* it = freelist_; it; it = it->Next)
+    if (reinterpret_cast<const BYTE*>(it) == block)
+      return true;
+
+  return false;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Checks if the object is on a block boundary
+    \param _object
+      Object to check
+    \return
+      Wether or not the object is on a block boundary
+*/
+//>=------------------------------------------------------------------------=<//
+template <typename T, typename Policy>
+bool TypedObjectAllocator<T, Policy>::badBoundary(const void* _object) const
+{
+  const BYTE* block = reinterpret_cast<const BYTE*>(_object);
+
+  for (const GenericObject* page = pagelist_; page; page = page->Next)
+  {
+    const BYTE* first = reinterpret_cast<const BYTE*>(page) + FirstBlock;
+    const BYTE* end = first + Policy::ObjectsPerPage * BlockStride;
+
+    //  find what page the pointer is on
+    if (block >= first && block < end)
+      return (block - first) % BlockStride != 0;
+  }
+
+  //  getting here means object wasn't on any page
+  return true;
+}
+
+//>=------------------------------------------------------------------------=<//
+/*!
+    \brief
+      Verifies the pad bytes next to objects
+    \param _object
+      Pointer to object to check pad bytes
+    \return
+      Health of pad bytes
+*/
+//>=------------------------------------------------------------------------=<//
+template <typename T, typename Policy>
+bool TypedObjectAllocator<T, Policy>::badPadBytes(const void* _object) const
+{
+  const BYTE* block = reinterpret_cast<const BYTE*>(_object);
+
+  //  pad bytes of a block that was never carved have not been written yet
+  if (block >= carveNext_ && block < carveEnd_)
+    return false;
+
+  const BYTE* left_pad = block - Policy::PadBytes;
+  const BYTE* right_pad = block + ObjectSize;
+
+  for (unsigned i = 0; i < Policy::PadBytes; ++i)
+    if (left_pad[i] != ObjectAllocator::PAD_PATTERN ||
+        right_pad[i] != ObjectAllocator::PAD_PATTERN)
+      return true;
+
+  return false;
+}
+
+#endif
@@ -8,14 +8,32 @@
 #include <Application/Application.h>
 #include <Interfaces/IService.h>
 #include <Core/DeltaTime.h>
+#include <Core/ThreadPool.h>
+#include <Core/ServiceScheduler.h>
+#include <Core/Profiler.h>
 #include <Core/EResult.h>
 
 namespace triskerville
 {
+  //  dumps everything the profiler holds, chrome://tracing opens the trace
+  static void writeProfile(std::string const& _path)
+  {
+    if (_path.empty()) return;
+
+#if !defined(TRISKERVILLE_NO_PROFILER)
+    auto const& profiler = Profiler::Get();
+    std::ofstream trace(_path + ".json");
+    if (trace) profiler.WriteChromeTrace(trace);
+    std::ofstream table(_path + ".txt");
+    if (table) profiler.WriteStatsTable(table);
+#endif
+  }
+
   Application::~Application()
   {
     serviceCollection_.clear();
     serviceOrder_.clear();
+    serviceDependencies_.clear();
   }
 
   Application::Application(Application&& _other) noexcept
@@ -28,6 +46,10 @@ namespace triskerville
   {
     this->serviceCollection_ = std::move(_other.serviceCollection_);
     this->serviceOrder_ = std::move(_other.serviceOrder_);
+    this->serviceDependencies_ = std::move(_other.serviceDependencies_);
+    this->fixedStep_ = _other.fixedStep_;
+    this->maxFixedSteps_ = _other.maxFixedSteps_;
+    this->profileOutput_ = std::move(_other.profileOutput_);
     this->isRunning_ = _other.isRunning_;
     _other.isRunning_ = false;
     
@@ -36,29 +58,79 @@ namespace triskerville
 
   void Application::Run()
   {
+    //  the pool lives as long as the loop, workers sleep between phases
+    ThreadPool pool;
+    ServiceScheduler scheduler(pool);
+    //  install order guarantees dependencies are added before dependees
+    for (auto const& key : serviceOrder_)
+    {
+      scheduler.AddService(key, serviceCollection_.at(key).get(),
+                           serviceDependencies_.at(key));
+    }
+
+    //  the loop returns from several places, and may throw
+    struct ProfileDump
+    {
+      std::string const& path;
+      ~ProfileDump() { writeProfile(path); }
+    } profileDump{ profileOutput_ };
+
+#if !defined(TRISKERVILLE_NO_PROFILER)
+    auto& profiler = Profiler::Get();
+    profiler.SetThreadName("Main");
+    uint frameCounter = profiler.RegisterCounter("Frame");
+#endif
+
     float dt = 1.f / 60.f;
+    //  wall time not yet simulated by FixedUpdate
+    float accumulator = 0.f;
     while (isRunning_)
     {
       //  manages dt, no need for the time variable aside from the destructor
       //  being called, which is what updates dt
       DeltaTime time(dt);
-      //  update each system and pass dt
-      for (auto it = serviceOrder_.begin(); it != serviceOrder_.end(); ++it)
-      {
-        auto key = *it;
-        auto& pService = serviceCollection_.at(key);
-        pService->FrameBegin(dt);
-        //  if any system reports failure, stop running immediately
-        if (pService->ShouldTerminate()) return;
-      }
-      //  some services are still running, end frame in reverse order
-      for (auto it = serviceOrder_.rbegin(); it != serviceOrder_.rend(); ++it)
+      TRISKERVILLE_PROFILE_COUNTER_ZONE("Frame", frameCounter);
+      //  begin each service once its dependencies have begun, pass dt.
+      //  if any service reports failure, stop running immediately
+      if (not scheduler.FrameBegin(dt)) return;
+
+      //  simulate in fixed steps, however long the frame took
+      accumulator += dt;
+      uint steps = 0;
+      while (accumulator >= fixedStep_ and steps < maxFixedSteps_)
       {
-        auto key = *it;
-        auto& pService = serviceCollection_.at(key);
-        //  call frame end for any services that override it
-        pService->FrameEnd();
+        if (not scheduler.FixedUpdate(fixedStep_)) return;
+        accumulator -= fixedStep_;
+        ++steps;
       }
+      //  a frame too slow to catch up on drops the extra time, otherwise
+      //  every frame would need more steps than the last
+      if (accumulator >= fixedStep_)
+        accumulator = std::fmod(accumulator, fixedStep_);
+      scheduler.SetInterpolationAlpha(accumulator / fixedStep_);
+
+      //  some services are still running, end frame once dependees have
+      scheduler.FrameEnd();
     }
   }
+
+  auto Application::Builder::WithFixedUpdate(float _tickRate, uint _maxSteps)
+    -> Builder&
+  {
+    //  0 would never step and a negative rate would step backwards
+    assert(_tickRate > 0.f and "Fixed update tick rate must be positive.");
+    assert(_maxSteps > 0 and "Fixed update needs at least one step a frame.");
+    instance_.fixedStep_ = 1.f / _tickRate;
+    instance_.maxFixedSteps_ = _maxSteps;
+
+    return *this;
+  }
+
+  auto Application::Builder::WithProfileOutput(std::string const& _path)
+    -> Builder&
+  {
+    instance_.profileOutput_ = _path;
+
+    return *this;
+  }
 }
\ No newline at end of file
@@ -31,6 +31,16 @@ namespace triskerville
     //  type_index vector is used to remember that ordering.
     std::unordered_map<std::type_index, SPointer<IService>> serviceCollection_{};
     std::vector<std::type_index> serviceOrder_{};
+    //  what each service depends on, lets Run schedule independent
+    //  services alongside each other
+    std::unordered_map<
+      std::type_index, std::vector<std::type_index>> serviceDependencies_{};
+
+    //  FixedUpdate runs at this step, at most maxFixedSteps_ times a frame
+    float fixedStep_{ 1.f / 60.f };
+    uint maxFixedSteps_{ 5 };
+    //  written with the profile when Run returns, empty writes nothing
+    std::string profileOutput_{};
     
     bool isRunning_{ true };
   };
@@ -41,6 +51,20 @@ namespace triskerville
     template <typename S>
     inline Builder& InstallService();
 
+    /// Sets how often services get FixedUpdate, independent of frame rate.
+    ///
+    /// \param _tickRate  Fixed updates per second, must be positive.
+    /// \param _maxSteps  Most fixed updates in one frame. Time a slow frame
+    ///                   can't catch up on is dropped rather than carried.
+    ///                   Must be at least 1.
+    Builder& WithFixedUpdate(float _tickRate, uint _maxSteps = 5);
+
+    /// Writes the profiler's output once Run returns, for any reason.
+    ///
+    /// \param _path  Path without an extension. The Chrome trace goes to
+    ///               _path.json, the counter table to _path.txt.
+    Builder& WithProfileOutput(std::string const& _path);
+
   private:
     template <typename S>
     inline void setDependencyPointer(SPointer<S>& _pServiceRef);
@@ -68,6 +92,8 @@ inline auto Application::Builder::InstallService() -> Builder&
   //  ensure services are called in the order they are created
   instance_.serviceOrder_.emplace_back(typeid(S));
   instance_.serviceCollection_.emplace(typeid(S), pService);
+  instance_.serviceDependencies_.emplace(
+    typeid(S), S::DependencyList::GetDependencyTypes());
 
   return *this;
 }
@@ -0,0 +1,77 @@
+// file:    Channel.h
+// author:  Tristan Baskerville
+// brief:   Typed message channels. A message is any struct, its type picks
+//          the channel, and observers receive it as that type. Nothing is
+//          hashed, cast or allocated when a message is published.
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#pragma once
+
+#include <Core/InlineDelegate.h>
+#include <Core/TypeHash.h>
+
+namespace triskerville
+{
+  /// One channel exists per message type, so a message type is its own
+  /// address: Channel<CameraUpdate>::Publish(...) reaches exactly the
+  /// observers subscribed to CameraUpdate. Channels are not thread safe,
+  /// publish from the main thread, or post through the MessageQueue.
+  ///
+  /// \tparam Message Payload type, observers take it by const reference.
+  template <typename Message>
+  class Channel
+  {
+  public:
+    using Observer = InlineDelegate<void(Message const&)>;
+
+    //  stable id of this channel, for logs and bridging to Hash messages
+    static constexpr std::uint64_t Id = TypeHash<Message>();
+
+    /// \tparam Method  Member function taking Message const&.
+    /// \param _pInstance Object to call it on, must unsubscribe before dying.
+    template <auto Method, typename C>
+    static inline void Subscribe(C* _pInstance)
+    {
+      Subscribe(Observer::template Bind<Method>(_pInstance));
+    }
+
+    template <auto Method, typename C>
+    static inline void Unsubscribe(C* _pInstance)
+    {
+      Unsubscribe(Observer::template Bind<Method>(_pInstance));
+    }
+
+    static inline void Subscribe(Observer _observer)
+    {
+      observers_.push_back(_observer);
+    }
+
+    /// Removes the first matching observer. Order is not kept, the last
+    /// observer is moved into its place.
+    static inline void Unsubscribe(Observer _observer)
+    {
+      auto it = std::find(observers_.begin(), observers_.end(), _observer);
+      if (it == observers_.end()) return;
+
+      *it = observers_.back();
+      observers_.pop_back();
+    }
+
+    /// Calls every observer. Observers may subscribe or unsubscribe while
+    /// this runs, one moved by an unsubscribe can miss this message.
+    static inline void Publish(Message const& _message)
+    {
+      for (size_t i = 0; i < observers_.size(); ++i)
+        observers_[i](_message);
+    }
+
+    static inline uint GetObserverCount()
+    {
+      return static_cast<uint>(observers_.size());
+    }
+
+  private:
+    static inline std::vector<Observer> observers_{};
+  };
+}
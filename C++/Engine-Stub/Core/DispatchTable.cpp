@@ -0,0 +1,151 @@
+// file:    DispatchTable.cpp
+// author:  Tristan Baskerville
+// brief:
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#include <stdafx.h>
+#include <Core/DispatchTable.h>
+
+namespace triskerville
+{
+  //  plenty for the message types a frame normally sees, grows past that
+  static constexpr uint InitialBucketCount = 64;
+
+  DispatchTable::DispatchTable()
+    : buckets_(InitialBucketCount)
+  {
+  }
+
+  auto DispatchTable::Register(
+    Hash _hash, Observer _observer, Callback _callback) -> Handle
+  {
+    uint list = findOrAddList(_hash);
+
+    uint index;
+    if (freeHandles_.empty())
+    {
+      index = static_cast<uint>(handles_.size());
+      handles_.emplace_back();
+    }
+    else
+    {
+      index = freeHandles_.back();
+      freeHandles_.pop_back();
+    }
+
+    auto& entries = lists_[list].entries;
+    auto& slot = handles_[index];
+    slot.list = list;
+    slot.position = static_cast<uint>(entries.size());
+    entries.push_back({ _observer, _callback, index });
+
+    return { index, slot.generation };
+  }
+
+  void DispatchTable::Unregister(Handle _handle)
+  {
+    if (_handle.index >= handles_.size()) return;
+
+    auto& slot = handles_[_handle.index];
+    //  the generation moves on every unregister, so old handles miss
+    if (slot.list == InvalidIndex or slot.generation != _handle.generation)
+      return;
+
+    //  swap the last observer into the hole, then fix up its handle
+    auto& entries = lists_[slot.list].entries;
+    auto& last = entries.back();
+    handles_[last.handle].position = slot.position;
+    entries[slot.position] = last;
+    entries.pop_back();
+
+    slot.list = InvalidIndex;
+    ++slot.generation;
+    freeHandles_.push_back(_handle.index);
+  }
+
+  void DispatchTable::Send(
+    Hash _hash, Observer _observer, void* _pPayload) const
+  {
+    uint list = findList(_hash);
+    if (list == InvalidIndex) return;
+
+    bool isBroadcast = (_observer == MessageService::AllObservers);
+    //  the list is looked up every pass and the entry copied out, callbacks
+    //  are allowed to register or unregister while we loop
+    for (uint i = 0; i < lists_[list].entries.size(); ++i)
+    {
+      Entry entry = lists_[list].entries[i];
+      if (isBroadcast or entry.observer == _observer)
+        entry.callback(entry.observer, _hash, _pPayload);
+    }
+  }
+
+  auto DispatchTable::Find(Hash _hash) const -> std::pair<Entry const*, uint>
+  {
+    uint list = findList(_hash);
+    if (list == InvalidIndex) return { nullptr, 0 };
+
+    auto const& entries = lists_[list].entries;
+    return { entries.data(), static_cast<uint>(entries.size()) };
+  }
+
+  uint DispatchTable::GetObserverCount(Hash _hash) const
+  {
+    return Find(_hash).second;
+  }
+
+  size_t DispatchTable::keyOf(Hash _hash)
+  {
+    return std::hash<Hash>{}(_hash);
+  }
+
+  uint DispatchTable::findList(Hash _hash) const
+  {
+    size_t key = keyOf(_hash);
+    size_t mask = buckets_.size() - 1;
+    //  linear probing, the table is never more than half full
+    for (size_t i = key & mask; ; i = (i + 1) & mask)
+    {
+      auto const& bucket = buckets_[i];
+      if (bucket.list == InvalidIndex) return InvalidIndex;
+      if (bucket.key == key and lists_[bucket.list].hash == _hash)
+        return bucket.list;
+    }
+  }
+
+  uint DispatchTable::findOrAddList(Hash _hash)
+  {
+    uint list = findList(_hash);
+    if (list != InvalidIndex) return list;
+
+    if ((lists_.size() + 1) * 2 > buckets_.size()) grow();
+
+    list = static_cast<uint>(lists_.size());
+    lists_.push_back({ _hash, {} });
+
+    size_t key = keyOf(_hash);
+    size_t mask = buckets_.size() - 1;
+    size_t i = key & mask;
+    while (buckets_[i].list != InvalidIndex) i = (i + 1) & mask;
+    buckets_[i] = { key, list };
+
+    return list;
+  }
+
+  void DispatchTable::grow()
+  {
+    std::vector<Bucket> buckets(buckets_.size() * 2);
+    size_t mask = buckets.size() - 1;
+    //  keys are cached in the buckets, no need to hash anything again
+    for (auto const& bucket : buckets_)
+    {
+      if (bucket.list == InvalidIndex) continue;
+
+      size_t i = bucket.key & mask;
+      while (buckets[i].list != InvalidIndex) i = (i + 1) & mask;
+      buckets[i] = bucket;
+    }
+    buckets_ = std::move(buckets);
+  }
+}
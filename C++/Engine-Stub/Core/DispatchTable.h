@@ -0,0 +1,95 @@
+// file:    DispatchTable.h
+// author:  Tristan Baskerville
+// brief:   Observer registry indexed by message Hash. Each Hash owns one
+//          contiguous array of (observer, callback) pairs, so sending is a
+//          single lookup followed by a straight loop of calls.
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#pragma once
+
+#include <Interfaces/INoCopy.h>
+#include <Services/MessageService.h>
+
+namespace triskerville
+{
+  /// Flat, open-addressed map from Hash to a packed array of observers.
+  /// Registering hands back a Handle that finds the observer again in O(1),
+  /// unregistering swaps the last observer of the array into its place.
+  ///
+  /// \author Tristan Baskerville
+  /// \date 3/23/2022
+  class DispatchTable : public virtual INoCopy
+  {
+  public:
+    using Observer = MessageService::Observer;
+    using Callback = void(*)(Observer, Hash, void*);
+
+    struct Handle
+    {
+      uint index{ InvalidIndex };
+      uint generation{ 0 };
+    };
+
+    struct Entry
+    {
+      Observer observer;
+      Callback callback;
+      uint handle;
+    };
+
+    static constexpr uint InvalidIndex = ~0u;
+
+    DispatchTable();
+
+    /// \returns  Handle used to unregister. Registering the same observer
+    ///           twice for a Hash calls it twice.
+    Handle Register(Hash _hash, Observer _observer, Callback _callback);
+
+    /// Removes an observer, stale or invalid handles are ignored.
+    void Unregister(Handle _handle);
+
+    /// Calls every observer of a Hash, or only _observer if it isn't
+    /// MessageService::AllObservers. Callbacks may register and unregister,
+    /// an observer moved by such an unregister can miss this one send.
+    void Send(Hash _hash, Observer _observer, void* _pPayload) const;
+
+    /// \returns  Observers of a Hash, empty if nothing was ever registered.
+    std::pair<Entry const*, uint> Find(Hash _hash) const;
+
+    uint GetObserverCount(Hash _hash) const;
+
+  private:
+    struct Bucket
+    {
+      size_t key{ 0 };
+      uint list{ InvalidIndex };
+    };
+
+    struct ObserverList
+    {
+      Hash hash;
+      std::vector<Entry> entries;
+    };
+
+    struct HandleSlot
+    {
+      uint list{ InvalidIndex };
+      uint position{ 0 };
+      uint generation{ 0 };
+    };
+
+    static size_t keyOf(Hash);
+    uint findList(Hash) const;
+    uint findOrAddList(Hash);
+    void grow();
+
+    //  power of two, grown once half full. message types are never removed,
+    //  so probing never has to step over tombstones
+    std::vector<Bucket> buckets_{};
+    std::vector<ObserverList> lists_{};
+
+    std::vector<HandleSlot> handles_{};
+    std::vector<uint> freeHandles_{};
+  };
+}
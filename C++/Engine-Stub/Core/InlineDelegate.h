@@ -0,0 +1,86 @@
+// file:    InlineDelegate.h
+// author:  Tristan Baskerville
+// brief:   Delegate that fits in two pointers. The target is chosen at
+//          compile time, so calling it never allocates, never goes through
+//          a vtable, and the target itself is inlined into a small stub.
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#pragma once
+
+namespace triskerville
+{
+  template <typename Signature>
+  class InlineDelegate;
+
+  /// Binds a free function or a member function plus its instance. Unlike
+  /// std::function it can't hold a lambda's captures, in exchange it is
+  /// trivially copyable and comparable.
+  ///
+  /// \tparam R     Return type.
+  /// \tparam Args  Parameter types.
+  template <typename R, typename... Args>
+  class InlineDelegate<R(Args...)>
+  {
+  public:
+    InlineDelegate() = default;
+
+    /// \tparam Method  Member function pointer, e.g. &Foo::Bar.
+    /// \param _pInstance Object to call it on, must outlive the delegate.
+    template <auto Method, typename C>
+    static inline InlineDelegate Bind(C* _pInstance)
+    {
+      //  const is stripped for storage and put back in the stub
+      return InlineDelegate(
+        const_cast<void*>(static_cast<void const*>(_pInstance)),
+        [](void* _pObject, Args... _args) -> R
+        {
+          return (static_cast<C*>(_pObject)->*Method)(
+            std::forward<Args>(_args)...);
+        });
+    }
+
+    /// \tparam Function  Free or static function pointer.
+    template <auto Function>
+    static inline InlineDelegate Bind()
+    {
+      return InlineDelegate(nullptr,
+        [](void*, Args... _args) -> R
+        {
+          return Function(std::forward<Args>(_args)...);
+        });
+    }
+
+    inline R operator()(Args... _args) const
+    {
+      return pStub_(pInstance_, std::forward<Args>(_args)...);
+    }
+
+    inline explicit operator bool() const
+    {
+      return pStub_ != nullptr;
+    }
+
+    inline bool operator==(InlineDelegate const& _other) const
+    {
+      return pInstance_ == _other.pInstance_ and pStub_ == _other.pStub_;
+    }
+
+    inline bool operator!=(InlineDelegate const& _other) const
+    {
+      return not (*this == _other);
+    }
+
+  private:
+    using Stub = R(*)(void*, Args...);
+
+    InlineDelegate(void* _pInstance, Stub _pStub)
+      : pInstance_(_pInstance)
+      , pStub_(_pStub)
+    {
+    }
+
+    void* pInstance_{ nullptr };
+    Stub pStub_{ nullptr };
+  };
+}
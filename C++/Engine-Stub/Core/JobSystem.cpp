@@ -0,0 +1,420 @@
+// file:    JobSystem.cpp
+// author:  Tristan Baskerville
+// brief:
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#include <stdafx.h>
+#include <Core/JobSystem.h>
+#include <Core/ThreadPool.h>
+#include <Core/Profiler.h>
+#include <Core/WorkStealingDeque.h>
+
+namespace triskerville
+{
+  struct JobSystem::Worker
+  {
+    JobSystem* pSystem{ nullptr };
+    uint index{ 0 };
+
+    WorkStealingDeque<RingSlot*, JobCapacity> deque{};
+    //  jobs are copied here so the deque only moves pointers around. a slot
+    //  is only handed out again once whoever popped or stole it has copied
+    //  the job out. twice the deque size, so a free one is always close by
+    std::array<RingSlot, JobCapacity * 2> ring{};
+    uint ringIndex{ 0 };
+
+#if TRISKERVILLE_FIBERS_ENABLED
+    //  the fiber this thread started on, switched back to at shutdown
+    void* pThreadFiber{ nullptr };
+    //  handed from the fiber we switched away from to the one we switched to
+    void* pWaitingFiber{ nullptr };
+    JobCounter* pWaitCounter{ nullptr };
+    void* pFreedFiber{ nullptr };
+#endif
+  };
+
+  thread_local JobSystem::Worker* JobSystem::pCurrentWorker_ = nullptr;
+
+  bool JobCounter::IsDone() const
+  {
+    return value_.load(std::memory_order_acquire) == 0;
+  }
+
+  JobSystem::JobSystem(uint _workerCount)
+  {
+    workers_.reserve(_workerCount);
+    for (uint i = 0; i < _workerCount; ++i)
+    {
+      auto pWorker = std::make_unique<Worker>();
+      pWorker->pSystem = this;
+      pWorker->index = i;
+      workers_.emplace_back(std::move(pWorker));
+    }
+
+#if TRISKERVILLE_FIBERS_ENABLED
+    //  every worker needs a fiber to start on, the rest are for parking
+    for (uint i = 0; i < FiberCount + _workerCount; ++i)
+    {
+      void* pFiber = CreateFiber(FiberStackSize, &JobSystem::fiberMain, this);
+      fibers_.push_back(pFiber);
+      freeFibers_.push_back(pFiber);
+    }
+#endif
+
+    threads_.reserve(_workerCount);
+    for (uint i = 0; i < _workerCount; ++i)
+      threads_.emplace_back(&JobSystem::workerMain, this, i);
+  }
+
+  JobSystem::~JobSystem()
+  {
+    //  outstanding counters must be waited on before we get here
+    {
+      std::lock_guard<std::mutex> lock(sleepLock_);
+      isRunning_.store(false, std::memory_order_release);
+    }
+    wake_.notify_all();
+
+    for (auto& thread : threads_)
+      thread.join();
+
+#if TRISKERVILLE_FIBERS_ENABLED
+    for (void* pFiber : fibers_)
+      DeleteFiber(pFiber);
+#endif
+  }
+
+  void JobSystem::Run(Job const* _pJobs, uint _count, JobCounter& _counter)
+  {
+    if (_count == 0) return;
+
+    //  both go up before any job is visible, so neither can underflow
+    _counter.value_.fetch_add(_count, std::memory_order_acq_rel);
+    pending_.fetch_add(_count, std::memory_order_acq_rel);
+
+    Worker* pWorker = currentWorker();
+    if (pWorker and pWorker->pSystem == this)
+    {
+      for (uint i = 0; i < _count; ++i)
+      {
+        auto& slot = takeSlot(*pWorker);
+        slot.queued = { _pJobs[i], &_counter };
+        if (pWorker->deque.Push(&slot)) continue;
+
+        //  our deque is full, the cheapest place to run it is right here
+        QueuedJob queued;
+        releaseSlot(slot, queued);
+        pending_.fetch_sub(1, std::memory_order_relaxed);
+        execute(queued);
+      }
+    }
+    else if (workers_.empty())
+    {
+      pending_.fetch_sub(_count, std::memory_order_relaxed);
+      for (uint i = 0; i < _count; ++i)
+        execute({ _pJobs[i], &_counter });
+      return;
+    }
+    else
+    {
+      //  only a deque's owner may push to it, so everyone else injects
+      std::lock_guard<std::mutex> lock(injectLock_);
+      for (uint i = 0; i < _count; ++i)
+        injected_.push_back({ _pJobs[i], &_counter });
+    }
+
+    wake(_count);
+  }
+
+  void JobSystem::Run(Job const& _job, JobCounter& _counter)
+  {
+    Run(&_job, 1, _counter);
+  }
+
+  void JobSystem::Wait(JobCounter& _counter)
+  {
+    if (_counter.IsDone()) return;
+
+#if TRISKERVILLE_FIBERS_ENABLED
+    //  on a worker we park this fiber and let another one keep the worker
+    //  busy. afterSwitch on the other side decides when we can come back
+    Worker* pWorker = currentWorker();
+    if (pWorker and pWorker->pSystem == this)
+    {
+      if (void* pNext = takeFiber(false))
+      {
+        pWorker->pWaitingFiber = GetCurrentFiber();
+        pWorker->pWaitCounter = &_counter;
+        SwitchToFiber(pNext);
+        //  resumed, possibly on another worker than the one we parked on
+        afterSwitch();
+        return;
+      }
+    }
+#endif
+
+    //  no fiber to park on, run jobs until ours are done
+    help(_counter);
+  }
+
+  uint JobSystem::GetWorkerCount() const
+  {
+    return static_cast<uint>(workers_.size());
+  }
+
+  uint JobSystem::DefaultWorkerCount()
+  {
+    return ThreadPool::DefaultWorkerCount();
+  }
+
+  void JobSystem::workerMain(uint _index)
+  {
+    pCurrentWorker_ = workers_[_index].get();
+    Profiler::Get().SetThreadName("Job Worker");
+
+#if TRISKERVILLE_FIBERS_ENABLED
+    pCurrentWorker_->pThreadFiber = ConvertThreadToFiber(nullptr);
+    SwitchToFiber(takeFiber(false));
+    //  a fiber switches back to us once the system shuts down
+    ConvertFiberToThread();
+#else
+    schedulerLoop();
+#endif
+  }
+
+  void JobSystem::schedulerLoop()
+  {
+    while (isRunning_.load(std::memory_order_acquire))
+    {
+#if TRISKERVILLE_FIBERS_ENABLED
+      //  finishing parked work comes before starting anything new
+      if (void* pReady = takeFiber(true))
+      {
+        currentWorker()->pFreedFiber = GetCurrentFiber();
+        SwitchToFiber(pReady);
+        afterSwitch();
+        continue;
+      }
+#endif
+
+      //  fibers hop between threads, so always look the worker up again
+      QueuedJob queued;
+      if (findJob(currentWorker(), queued))
+      {
+        execute(queued);
+        continue;
+      }
+
+      idle();
+    }
+  }
+
+  bool JobSystem::findJob(Worker* _pWorker, QueuedJob& _queued)
+  {
+    RingSlot* pSlot = nullptr;
+    if (_pWorker and _pWorker->pSystem == this and _pWorker->deque.Pop(pSlot))
+    {
+      releaseSlot(*pSlot, _queued);
+      pending_.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+
+    return popInjected(_queued) or steal(_pWorker, _queued);
+  }
+
+  bool JobSystem::popInjected(QueuedJob& _queued)
+  {
+    std::lock_guard<std::mutex> lock(injectLock_);
+    if (injected_.empty()) return false;
+
+    _queued = injected_.front();
+    injected_.pop_front();
+    pending_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  bool JobSystem::steal(Worker* _pWorker, QueuedJob& _queued)
+  {
+    uint count = static_cast<uint>(workers_.size());
+    //  start at our neighbour so thieves don't all pile onto worker 0
+    uint start = (_pWorker and _pWorker->pSystem == this)
+      ? _pWorker->index + 1
+      : 0;
+
+    for (uint i = 0; i < count; ++i)
+    {
+      auto& victim = *workers_[(start + i) % count];
+      if (&victim == _pWorker) continue;
+
+      RingSlot* pSlot = nullptr;
+      if (victim.deque.Steal(pSlot))
+      {
+        releaseSlot(*pSlot, _queued);
+        pending_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  auto JobSystem::takeSlot(Worker& _worker) -> RingSlot&
+  {
+    //  at most JobCapacity slots sit in the deque, the rest are only held
+    //  by threads copying a job out, so this finds one within a few steps
+    while (true)
+    {
+      auto& slot = _worker.ring[_worker.ringIndex++ % _worker.ring.size()];
+      //  only the owner ever marks a slot taken, so no exchange is needed
+      if (slot.isFree.load(std::memory_order_acquire))
+      {
+        slot.isFree.store(false, std::memory_order_relaxed);
+        return slot;
+      }
+    }
+  }
+
+  void JobSystem::releaseSlot(RingSlot& _slot, QueuedJob& _queued)
+  {
+    //  copied before the release, the owner may refill it right after
+    _queued = _slot.queued;
+    _slot.isFree.store(true, std::memory_order_release);
+  }
+
+  void JobSystem::execute(QueuedJob const& _queued)
+  {
+    _queued.job.function(_queued.job.pData);
+    finish(*_queued.pCounter);
+  }
+
+  void JobSystem::finish(JobCounter& _counter)
+  {
+    if (_counter.value_.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+
+#if TRISKERVILLE_FIBERS_ENABLED
+    //  the counter may already be gone, only its address is compared here
+    uint woken = 0;
+    {
+      std::lock_guard<std::mutex> lock(fiberLock_);
+      auto it = waitingFibers_.begin();
+      while (it != waitingFibers_.end())
+      {
+        if (it->second != &_counter) { ++it; continue; }
+
+        readyFibers_.push_back(it->first);
+        *it = waitingFibers_.back();
+        waitingFibers_.pop_back();
+        ++woken;
+      }
+      //  counted under the lock, takeFiber may pop them the moment it's free
+      pending_.fetch_add(woken, std::memory_order_acq_rel);
+    }
+
+    if (woken) wake(woken);
+#endif
+  }
+
+  void JobSystem::help(JobCounter& _counter)
+  {
+    while (not _counter.IsDone())
+    {
+      QueuedJob queued;
+      if (findJob(currentWorker(), queued))
+        execute(queued);
+      else
+        std::this_thread::yield();
+    }
+  }
+
+  void JobSystem::idle()
+  {
+    std::unique_lock<std::mutex> lock(sleepLock_);
+    wake_.wait(lock, [this]
+      {
+        return not isRunning_.load(std::memory_order_acquire) or
+               pending_.load(std::memory_order_acquire) > 0;
+      });
+  }
+
+  void JobSystem::wake(uint _count)
+  {
+    //  taking the lock orders this wake with a worker checking pending_
+    { std::lock_guard<std::mutex> lock(sleepLock_); }
+
+    if (_count == 1)
+      wake_.notify_one();
+    else
+      wake_.notify_all();
+  }
+
+  auto JobSystem::currentWorker() -> Worker*
+  {
+    return pCurrentWorker_;
+  }
+
+#if TRISKERVILLE_FIBERS_ENABLED
+  void __stdcall JobSystem::fiberMain(void* _pSystem)
+  {
+    auto pSystem = static_cast<JobSystem*>(_pSystem);
+    pSystem->afterSwitch();
+    pSystem->schedulerLoop();
+    //  shutting down, give the thread back to the fiber it started on
+    SwitchToFiber(currentWorker()->pThreadFiber);
+  }
+
+  void* JobSystem::takeFiber(bool _readyOnly)
+  {
+    std::lock_guard<std::mutex> lock(fiberLock_);
+    if (not readyFibers_.empty())
+    {
+      void* pFiber = readyFibers_.front();
+      readyFibers_.pop_front();
+      pending_.fetch_sub(1, std::memory_order_relaxed);
+      return pFiber;
+    }
+
+    if (_readyOnly or freeFibers_.empty()) return nullptr;
+
+    void* pFiber = freeFibers_.back();
+    freeFibers_.pop_back();
+    return pFiber;
+  }
+
+  void JobSystem::afterSwitch()
+  {
+    //  the fiber we left can only be touched once we are off its stack,
+    //  which is now. the worker may differ from the one before the switch
+    Worker* pWorker = currentWorker();
+    bool isReady = false;
+    {
+      std::lock_guard<std::mutex> lock(fiberLock_);
+      if (pWorker->pFreedFiber)
+      {
+        freeFibers_.push_back(pWorker->pFreedFiber);
+        pWorker->pFreedFiber = nullptr;
+      }
+
+      if (pWorker->pWaitingFiber)
+      {
+        //  finish() checks under the same lock, so a counter hitting 0 while
+        //  we were switching can't be missed
+        if (pWorker->pWaitCounter->IsDone())
+        {
+          readyFibers_.push_back(pWorker->pWaitingFiber);
+          pending_.fetch_add(1, std::memory_order_acq_rel);
+          isReady = true;
+        }
+        else
+        {
+          waitingFibers_.emplace_back(
+            pWorker->pWaitingFiber, pWorker->pWaitCounter);
+        }
+        pWorker->pWaitingFiber = nullptr;
+        pWorker->pWaitCounter = nullptr;
+      }
+    }
+
+    if (isReady) wake(1);
+  }
+#endif
+}
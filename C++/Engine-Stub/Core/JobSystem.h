@@ -0,0 +1,177 @@
+// file:    JobSystem.h
+// author:  Tristan Baskerville
+// brief:   Fine-grained job system. Jobs are plain function pointers that are
+//          spread across workers with work-stealing deques, and grouped by
+//          counters that can be waited on like fences.
+//
+//          Building with TRISKERVILLE_JOB_FIBERS on Windows runs jobs on
+//          fibers, so a job waiting on a counter parks its fiber and the
+//          worker moves on to other jobs instead of blocking. Fibers move
+//          between threads, so that build also needs fiber-safe TLS (/GT).
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#pragma once
+
+#include <Interfaces/INoCopy.h>
+
+#if defined(_WIN32) && defined(TRISKERVILLE_JOB_FIBERS)
+  #define TRISKERVILLE_FIBERS_ENABLED 1
+#else
+  #define TRISKERVILLE_FIBERS_ENABLED 0
+#endif
+
+namespace triskerville
+{
+  /// Counts jobs that have not finished yet. A counter must outlive every
+  /// job run against it, the usual way is a local that is waited on before
+  /// it goes out of scope.
+  class JobCounter : public virtual INoCopy
+  {
+  public:
+    JobCounter() = default;
+    bool IsDone() const;
+  private:
+    friend class JobSystem;
+    std::atomic<uint> value_{ 0 };
+  };
+
+  /// Owns the worker threads and their deques. Any thread may run jobs and
+  /// wait on counters, waiting threads help by running other jobs.
+  ///
+  /// \author Tristan Baskerville
+  /// \date 3/09/2022
+  class JobSystem : public virtual INoCopy
+  {
+  public:
+    using JobFunction = void(*)(void*);
+
+    struct Job
+    {
+      JobFunction function{ nullptr };
+      void* pData{ nullptr };
+    };
+
+    /// Number of jobs each worker can hold before Run starts running jobs
+    /// inline on the calling thread.
+    static constexpr uint JobCapacity = 4096;
+
+    explicit JobSystem(uint _workerCount = DefaultWorkerCount());
+    ~JobSystem();
+
+    /// Queues jobs and adds them to a counter.
+    ///
+    /// \param _pJobs     Jobs to run, copied before this returns.
+    /// \param _count     Number of jobs in _pJobs.
+    /// \param _counter   Decremented as each job finishes.
+    void Run(Job const* _pJobs, uint _count, JobCounter& _counter);
+    void Run(Job const& _job, JobCounter& _counter);
+
+    /// Returns once every job run against the counter has finished. Jobs
+    /// on a fiber are parked, every other thread runs jobs while it waits.
+    void Wait(JobCounter& _counter);
+
+    /// Splits [0, _count) into ranges of at most _grain elements and calls
+    /// _function(begin, end) for each range across the workers. Blocks until
+    /// every range has been processed.
+    template <typename F>
+    void ParallelFor(uint _count, uint _grain, F&& _function);
+
+    uint GetWorkerCount() const;
+    static uint DefaultWorkerCount();
+
+  private:
+    struct QueuedJob
+    {
+      Job job{};
+      JobCounter* pCounter{ nullptr };
+    };
+    //  a queued job parked in its worker's ring while the deque holds it
+    struct RingSlot
+    {
+      QueuedJob queued{};
+      std::atomic<bool> isFree{ true };
+    };
+    struct Worker;
+
+    void workerMain(uint);
+    void schedulerLoop();
+    bool findJob(Worker*, QueuedJob&);
+    bool popInjected(QueuedJob&);
+    bool steal(Worker*, QueuedJob&);
+    RingSlot& takeSlot(Worker&);
+    void releaseSlot(RingSlot&, QueuedJob&);
+    void execute(QueuedJob const&);
+    void finish(JobCounter&);
+    void help(JobCounter&);
+    void idle();
+    void wake(uint);
+
+#if TRISKERVILLE_FIBERS_ENABLED
+    static void __stdcall fiberMain(void*);
+    void* takeFiber(bool _readyOnly);
+    void afterSwitch();
+#endif
+
+    static Worker* currentWorker();
+
+    std::vector<UPointer<Worker>> workers_{};
+    std::vector<std::thread> threads_{};
+
+    //  jobs run from threads that aren't workers land here first
+    std::mutex injectLock_{};
+    std::deque<QueuedJob> injected_{};
+
+    //  queued jobs plus parked fibers that are ready, idle workers sleep
+    //  while this is 0
+    std::atomic<uint> pending_{ 0 };
+    std::mutex sleepLock_{};
+    std::condition_variable wake_{};
+    std::atomic<bool> isRunning_{ true };
+
+#if TRISKERVILLE_FIBERS_ENABLED
+    static constexpr uint FiberCount = 128;
+    static constexpr size_t FiberStackSize = 64 * 1024;
+
+    std::mutex fiberLock_{};
+    std::vector<void*> fibers_{};
+    std::vector<void*> freeFibers_{};
+    std::deque<void*> readyFibers_{};
+    std::vector<std::pair<void*, JobCounter*>> waitingFibers_{};
+#endif
+
+    static thread_local Worker* pCurrentWorker_;
+  };
+}
+
+template <typename F>
+void triskerville::JobSystem::ParallelFor(uint _count, uint _grain, F&& _function)
+{
+  if (_count == 0) return;
+  if (_grain == 0) _grain = 1;
+
+  struct Range
+  {
+    std::remove_reference_t<F>* pFunction;
+    uint begin, end;
+  };
+
+  uint rangeCount = (_count + _grain - 1) / _grain;
+  std::vector<Range> ranges(rangeCount);
+  std::vector<Job> jobs(rangeCount);
+  for (uint i = 0; i < rangeCount; ++i)
+  {
+    uint begin = i * _grain;
+    ranges[i] = { &_function, begin, std::min(begin + _grain, _count) };
+    jobs[i] = { +[](void* _pData)
+      {
+        auto pRange = static_cast<Range*>(_pData);
+        (*pRange->pFunction)(pRange->begin, pRange->end);
+      }, &ranges[i] };
+  }
+
+  //  ranges live on this stack, so we can't return until they are done
+  JobCounter counter;
+  Run(jobs.data(), rangeCount, counter);
+  Wait(counter);
+}
@@ -0,0 +1,189 @@
+// file:    MessageQueue.cpp
+// author:  Tristan Baskerville
+// brief:
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#include <stdafx.h>
+#include <Core/MessageQueue.h>
+
+namespace triskerville
+{
+  static_assert((MessageQueue::MessageCapacity &
+                (MessageQueue::MessageCapacity - 1)) == 0,
+                "MessageQueue capacity must be a power of two.");
+  static_assert(std::is_trivially_copyable<Hash>::value,
+                "Queued messages are copied into ring slots as bytes.");
+
+  //  every payload starts on a boundary any type is happy with
+  static constexpr size_t PayloadAlignment = alignof(std::max_align_t);
+
+  MessageQueue::MessageQueue()
+    : pSlots_(std::make_unique<Slot[]>(MessageCapacity))
+  {
+    //  a slot is free for the producer whose position matches its sequence
+    for (uint i = 0; i < MessageCapacity; ++i)
+      pSlots_[i].sequence.store(i, std::memory_order_relaxed);
+
+    for (auto& arena : arenas_)
+      arena.pMemory = std::make_unique<byte[]>(ArenaCapacity);
+  }
+
+  bool MessageQueue::Post(Hash _hash, MessageService::Observer _observer,
+                          void const* _pPayload, size_t _size)
+  {
+    //  join the active arena. if Dispatch swapped it out from under us, step
+    //  back out and join the new one, Dispatch is waiting for us to leave
+    uint index;
+    while (true)
+    {
+      index = activeArena_.load(std::memory_order_seq_cst);
+      arenas_[index].writers.fetch_add(1, std::memory_order_seq_cst);
+      if (activeArena_.load(std::memory_order_seq_cst) == index) break;
+      arenas_[index].writers.fetch_sub(1, std::memory_order_release);
+    }
+    auto& arena = arenas_[index];
+
+    void* pPayload = nullptr;
+    bool isQueued = true;
+    if (_pPayload)
+    {
+      size_t size = (_size + PayloadAlignment - 1) & ~(PayloadAlignment - 1);
+      size_t offset = arena.used.fetch_add(size, std::memory_order_relaxed);
+      if (offset + size <= ArenaCapacity)
+      {
+        pPayload = arena.pMemory.get() + offset;
+        std::memcpy(pPayload, _pPayload, _size);
+      }
+      else
+      {
+        isQueued = false;
+      }
+    }
+
+    if (isQueued)
+      isQueued = enqueue({ _hash, _observer, pPayload });
+
+    arena.writers.fetch_sub(1, std::memory_order_release);
+
+    if (not isQueued) dropped_.fetch_add(1, std::memory_order_relaxed);
+    return isQueued;
+  }
+
+  void MessageQueue::Dispatch()
+  {
+    //  new posts go to the other arena, then wait out anyone still copying
+    //  into this one. their messages are in the ring once they leave
+    uint front = activeArena_.load(std::memory_order_relaxed);
+    activeArena_.store(front ^ 1u, std::memory_order_seq_cst);
+    while (arenas_[front].writers.load(std::memory_order_seq_cst) != 0)
+      std::this_thread::yield();
+
+    batch_.clear();
+    while (dequeue()) {}
+
+    //  count each Hash in order of first appearance, a frame only ever has
+    //  a handful of message types so a linear search beats a map here
+    groups_.clear();
+    for (auto const& queued : batch_)
+    {
+      auto it = std::find_if(groups_.begin(), groups_.end(),
+        [&queued](auto const& _group) { return _group.first == queued.hash; });
+
+      if (it == groups_.end())
+        groups_.emplace_back(queued.hash, 1u);
+      else
+        ++it->second;
+    }
+
+    //  counting sort into runs of the same Hash, stable within each run
+    uint offset = 0;
+    for (auto& group : groups_)
+      offset += std::exchange(group.second, offset);
+
+    order_.resize(batch_.size());
+    for (uint i = 0; i < batch_.size(); ++i)
+    {
+      auto const& hash = batch_[i].hash;
+      auto it = std::find_if(groups_.begin(), groups_.end(),
+        [&hash](auto const& _group) { return _group.first == hash; });
+      order_[it->second++] = i;
+    }
+
+    for (uint i : order_)
+    {
+      auto const& queued = batch_[i];
+      Send_Message(queued.hash, queued.observer, queued.pPayload);
+    }
+
+    //  every payload in the front arena has been sent, recycle it
+    arenas_[front].used.store(0, std::memory_order_relaxed);
+  }
+
+  uint MessageQueue::GetDroppedCount() const
+  {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+  bool MessageQueue::enqueue(Message const& _message)
+  {
+    size_t position = enqueue_.load(std::memory_order_relaxed);
+    while (true)
+    {
+      auto& slot = pSlots_[position & (MessageCapacity - 1)];
+      size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      auto difference = static_cast<std::intptr_t>(sequence) -
+                        static_cast<std::intptr_t>(position);
+
+      if (difference == 0)
+      {
+        //  the slot is ours if nobody else claimed this position first
+        if (enqueue_.compare_exchange_weak(position, position + 1,
+                                           std::memory_order_relaxed))
+        {
+          std::memcpy(slot.message, &_message, sizeof(Message));
+          slot.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      //  the consumer hasn't freed this slot yet, the ring is full
+      else if (difference < 0)
+      {
+        return false;
+      }
+      else
+      {
+        position = enqueue_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool MessageQueue::dequeue()
+  {
+    auto& slot = pSlots_[dequeue_ & (MessageCapacity - 1)];
+    size_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != dequeue_ + 1) return false;
+
+    batch_.push_back(*std::launder(reinterpret_cast<Message*>(slot.message)));
+    //  hand the slot back to the producer one lap ahead of us
+    slot.sequence.store(dequeue_ + MessageCapacity, std::memory_order_release);
+    ++dequeue_;
+    return true;
+  }
+
+  bool Post_Message(Hash _hash, MessageService::Observer _observer)
+  {
+    return GetMessageQueue().Post(_hash, _observer);
+  }
+
+  void Dispatch_Messages()
+  {
+    GetMessageQueue().Dispatch();
+  }
+
+  MessageQueue& GetMessageQueue()
+  {
+    static MessageQueue queue;
+    return queue;
+  }
+}
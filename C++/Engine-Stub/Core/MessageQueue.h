@@ -0,0 +1,115 @@
+// file:    MessageQueue.h
+// author:  Tristan Baskerville
+// brief:   Deferred messages. Any thread can post a message without locks,
+//          its payload is copied into a per-frame arena, and the whole frame
+//          of messages is sent in one batch, grouped by Hash, whenever the
+//          queue is dispatched.
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#pragma once
+
+#include <Interfaces/INoCopy.h>
+#include <Services/MessageService.h>
+
+namespace triskerville
+{
+  /// Bounded multi-producer, single-consumer queue of messages. Producers
+  /// claim ring slots and arena space with atomics only. The two payload
+  /// arenas swap on every Dispatch, so a payload stays valid until every
+  /// observer of the batch it was sent in has returned.
+  ///
+  /// \author Tristan Baskerville
+  /// \date 3/16/2022
+  class MessageQueue : public virtual INoCopy
+  {
+  public:
+    //  must be powers of two
+    static constexpr uint MessageCapacity = 4096;
+    static constexpr uint ArenaCapacity = 64 * 1024;
+
+    MessageQueue();
+
+    /// Copies a payload and queues the message. Safe from any thread.
+    ///
+    /// \param _hash      Message type, same as Send_Message.
+    /// \param _observer  Target of the message, same as Send_Message.
+    /// \param _pPayload  Bytes to copy, nullptr is sent as nullptr.
+    /// \param _size      Number of bytes to copy.
+    ///
+    /// \returns  False if this frame's ring or arena is full. The message
+    ///           is dropped and counted in GetDroppedCount().
+    bool Post(Hash _hash, MessageService::Observer _observer,
+              void const* _pPayload = nullptr, size_t _size = 0);
+
+    /// Sends every queued message through Send_Message. Messages with the
+    /// same Hash are sent together, in the order they were posted. Only one
+    /// thread may dispatch, messages posted by observers wait for the next
+    /// Dispatch.
+    void Dispatch();
+
+    uint GetDroppedCount() const;
+
+  private:
+    struct Message
+    {
+      Hash hash;
+      MessageService::Observer observer;
+      void* pPayload;
+    };
+
+    struct Slot
+    {
+      std::atomic<size_t> sequence{ 0 };
+      //  Hash need not be default constructible, so messages live as bytes
+      alignas(Message) byte message[sizeof(Message)];
+    };
+
+    struct Arena
+    {
+      UPointer<byte[]> pMemory{ nullptr };
+      std::atomic<size_t> used{ 0 };
+      //  producers still copying into this arena, Dispatch waits on it
+      std::atomic<uint> writers{ 0 };
+    };
+
+    bool enqueue(Message const&);
+    bool dequeue();
+
+    //  the consumer only touches dequeue_, keep producers off its line
+    alignas(64) std::atomic<size_t> enqueue_{ 0 };
+    alignas(64) size_t dequeue_{ 0 };
+    UPointer<Slot[]> pSlots_{ nullptr };
+
+    std::array<Arena, 2> arenas_{};
+    std::atomic<uint> activeArena_{ 0 };
+    std::atomic<uint> dropped_{ 0 };
+
+    //  reused between dispatches so batching never allocates once warm
+    std::vector<Message> batch_{};
+    std::vector<std::pair<Hash, uint>> groups_{};
+    std::vector<uint> order_{};
+  };
+
+  /// Queues a message on the engine's deferred queue. The payload is copied,
+  /// so it is fine to pass a local. Safe from any thread.
+  template <typename T>
+  bool Post_Message(Hash _hash, MessageService::Observer _observer,
+                    T const& _payload);
+  bool Post_Message(Hash _hash, MessageService::Observer _observer);
+
+  /// Sends every message posted since the last call. Called once a frame by
+  /// WindowService, right after it has polled for input.
+  void Dispatch_Messages();
+
+  MessageQueue& GetMessageQueue();
+}
+
+template <typename T>
+inline bool triskerville::Post_Message(
+  Hash _hash, MessageService::Observer _observer, T const& _payload)
+{
+  static_assert(std::is_trivially_copyable<T>::value,
+                "Posted payloads are copied as bytes.");
+  return GetMessageQueue().Post(_hash, _observer, &_payload, sizeof(T));
+}
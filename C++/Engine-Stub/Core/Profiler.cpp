@@ -0,0 +1,244 @@
+// file:    Profiler.cpp
+// author:  Tristan Baskerville
+// brief:
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#include <stdafx.h>
+#include <Core/Profiler.h>
+
+#if defined(__GNUG__)
+  #include <cxxabi.h>
+#endif
+
+namespace triskerville
+{
+  //  each thread finds its ring without a lock after the first zone
+  static thread_local void* pThreadBuffer = nullptr;
+
+  //  zone names are user strings, keep the JSON valid whatever they hold
+  static void writeEscaped(std::ostream& _out, char const* _str)
+  {
+    for (; *_str; ++_str)
+    {
+      char c = *_str;
+      if (c == '"' or c == '\\') _out << '\\' << c;
+      else if (static_cast<byte>(c) < 0x20) _out << ' ';
+      else _out << c;
+    }
+  }
+
+  Profiler& Profiler::Get()
+  {
+    static Profiler profiler;
+    return profiler;
+  }
+
+  Profiler::Profiler()
+    : epoch_(std::chrono::steady_clock::now())
+  {
+  }
+
+  void Profiler::SetEnabled(bool _isEnabled)
+  {
+    isEnabled_.store(_isEnabled, std::memory_order_relaxed);
+  }
+
+  bool Profiler::IsEnabled() const
+  {
+    return isEnabled_.load(std::memory_order_relaxed);
+  }
+
+  void Profiler::SetThreadName(char const* _name)
+  {
+    threadBuffer().name = _name;
+  }
+
+  std::string Profiler::GetTypeName(std::type_index _type)
+  {
+#if defined(__GNUG__)
+    int status = 0;
+    std::unique_ptr<char, void(*)(void*)> pName{
+      abi::__cxa_demangle(_type.name(), nullptr, nullptr, &status),
+      std::free };
+    if (status == 0 and pName) return pName.get();
+    return _type.name();
+#else
+    //  MSVC names are readable already, apart from the class/struct prefix
+    std::string name = _type.name();
+    for (char const* prefix : { "class ", "struct " })
+    {
+      size_t length = std::strlen(prefix);
+      if (name.compare(0, length, prefix) == 0) return name.substr(length);
+    }
+    return name;
+#endif
+  }
+
+  uint Profiler::RegisterCounter(std::string const& _name)
+  {
+    std::lock_guard<std::mutex> lock(counterLock_);
+    uint index = counterCount_.load(std::memory_order_relaxed);
+    if (index == MaxCounters) return NoCounter;
+
+    counterNames_.push_back(_name);
+    counters_[index].name = counterNames_.back().c_str();
+    counterCount_.store(index + 1, std::memory_order_release);
+    return index;
+  }
+
+  char const* Profiler::GetCounterName(uint _counter) const
+  {
+    if (_counter >= counterCount_.load(std::memory_order_acquire))
+      return nullptr;
+    return counters_[_counter].name;
+  }
+
+  void Profiler::RecordSample(uint _counter, std::uint64_t _ns)
+  {
+    if (_counter >= MaxCounters or not IsEnabled()) return;
+
+    //  one writer per counter is the norm, but a shared counter only risks
+    //  two samples landing in the same slot
+    auto& counter = counters_[_counter];
+    uint index = counter.written.fetch_add(1, std::memory_order_relaxed);
+    counter.samples[index % SampleCapacity] = _ns;
+  }
+
+  void Profiler::RecordZone(
+    char const* _name, std::uint64_t _beginNs, std::uint64_t _endNs)
+  {
+    if (not IsEnabled()) return;
+
+    auto& buffer = threadBuffer();
+    auto head = buffer.head.load(std::memory_order_relaxed);
+    buffer.events[head % EventCapacity] = { _name, _beginNs, _endNs };
+    buffer.head.store(head + 1, std::memory_order_release);
+  }
+
+  std::uint64_t Profiler::Now() const
+  {
+    auto elapsed = std::chrono::steady_clock::now() - epoch_;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      elapsed).count();
+  }
+
+  auto Profiler::GetStats() const -> std::vector<Stats>
+  {
+    std::vector<Stats> stats;
+    std::vector<std::uint64_t> samples;
+
+    uint count = counterCount_.load(std::memory_order_acquire);
+    for (uint i = 0; i < count; ++i)
+    {
+      auto const& counter = counters_[i];
+      uint written = counter.written.load(std::memory_order_relaxed);
+      uint size = std::min(written, SampleCapacity);
+      if (size == 0) continue;
+
+      samples.assign(counter.samples.begin(), counter.samples.begin() + size);
+      auto sum = std::accumulate(samples.begin(), samples.end(),
+                                 std::uint64_t{ 0 });
+      auto low = *std::min_element(samples.begin(), samples.end());
+      //  nearest-rank p99, only the one element needs to be in place
+      auto rank = samples.begin() + (size * 99 + 99) / 100 - 1;
+      std::nth_element(samples.begin(), rank, samples.end());
+
+      constexpr double toMs = 1.0 / 1'000'000.0;
+      stats.push_back({ counter.name, size,
+                        low * toMs, sum * toMs / size, *rank * toMs });
+    }
+    return stats;
+  }
+
+  void Profiler::WriteChromeTrace(std::ostream& _out) const
+  {
+    std::lock_guard<std::mutex> lock(threadLock_);
+
+    //  complete ("X") events in microseconds, nesting is implied by time.
+    //  fixed keeps nanoseconds, the default 6 digits turn minutes into
+    //  milliseconds and collapse every zone of a frame onto one timestamp
+    auto flags = _out.flags(std::ios::fixed);
+    auto precision = _out.precision(3);
+    _out << "{\"traceEvents\":[";
+    bool isFirst = true;
+    for (auto const& pBuffer : threads_)
+    {
+      if (pBuffer->name)
+      {
+        _out << (isFirst ? "" : ",")
+             << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":"
+             << pBuffer->id << ",\"args\":{\"name\":\"";
+        writeEscaped(_out, pBuffer->name);
+        _out << "\"}}";
+        isFirst = false;
+      }
+
+      auto head = pBuffer->head.load(std::memory_order_acquire);
+      auto begin = head > EventCapacity ? head - EventCapacity : 0;
+      for (auto i = begin; i < head; ++i)
+      {
+        auto const& event = pBuffer->events[i % EventCapacity];
+        _out << (isFirst ? "" : ",") << "{\"name\":\"";
+        writeEscaped(_out, event.name);
+        _out << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << pBuffer->id
+             << ",\"ts\":" << event.beginNs / 1000.0
+             << ",\"dur\":" << (event.endNs - event.beginNs) / 1000.0 << "}";
+        isFirst = false;
+      }
+    }
+    _out << "],\"displayTimeUnit\":\"ms\"}\n";
+    _out.flags(flags);
+    _out.precision(precision);
+  }
+
+  void Profiler::WriteStatsTable(std::ostream& _out) const
+  {
+    auto stats = GetStats();
+
+    size_t width = 4;
+    for (auto const& stat : stats)
+      width = std::max(width, std::strlen(stat.name));
+
+    char line[256];
+    stbsp_snprintf(line, sizeof(line), "%-*s %8s %10s %10s %10s\n",
+                   static_cast<int>(width), "Name",
+                   "Samples", "Min ms", "Avg ms", "P99 ms");
+    _out << line;
+    for (auto const& stat : stats)
+    {
+      stbsp_snprintf(line, sizeof(line), "%-*s %8u %10.3f %10.3f %10.3f\n",
+                     static_cast<int>(width), stat.name, stat.samples,
+                     stat.minMs, stat.avgMs, stat.p99Ms);
+      _out << line;
+    }
+  }
+
+  auto Profiler::threadBuffer() -> ThreadBuffer&
+  {
+    if (pThreadBuffer) return *static_cast<ThreadBuffer*>(pThreadBuffer);
+
+    //  buffers outlive their threads, so a dump still sees finished work
+    std::lock_guard<std::mutex> lock(threadLock_);
+    auto pBuffer = std::make_unique<ThreadBuffer>();
+    pBuffer->id = static_cast<uint>(threads_.size());
+    pThreadBuffer = pBuffer.get();
+    threads_.emplace_back(std::move(pBuffer));
+    return *static_cast<ThreadBuffer*>(pThreadBuffer);
+  }
+
+  ProfileZone::ProfileZone(char const* _name, uint _counter)
+    : name_(_name)
+    , counter_(_counter)
+    , beginNs_(Profiler::Get().Now())
+  {
+  }
+
+  ProfileZone::~ProfileZone()
+  {
+    auto& profiler = Profiler::Get();
+    auto endNs = profiler.Now();
+    profiler.RecordZone(name_, beginNs_, endNs);
+    profiler.RecordSample(counter_, endNs - beginNs_);
+  }
+}
@@ -0,0 +1,149 @@
+// file:    Profiler.h
+// author:  Tristan Baskerville
+// brief:   Built-in frame profiler. Scoped zones are written to a ring per
+//          thread without locks, and can be dumped as a Chrome trace that
+//          chrome://tracing and Perfetto open directly. Counters keep a
+//          rolling window of samples for min/avg/p99 timings.
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#pragma once
+
+#include <Interfaces/INoCopy.h>
+
+namespace triskerville
+{
+  /// Collects zones from every thread and samples for named counters.
+  /// ServiceScheduler times every FrameBegin/FrameEnd through here, user
+  /// code adds its own zones with TRISKERVILLE_PROFILE_ZONE. Defining
+  /// TRISKERVILLE_NO_PROFILER compiles every zone out.
+  ///
+  /// \author Tristan Baskerville
+  /// \date 3/30/2022
+  class Profiler : public virtual INoCopy
+  {
+  public:
+    //  zones kept per thread, older zones are overwritten
+    static constexpr uint EventCapacity = 16384;
+    //  samples kept per counter, roughly four seconds at 60 fps
+    static constexpr uint SampleCapacity = 256;
+    static constexpr uint MaxCounters = 256;
+    static constexpr uint NoCounter = ~0u;
+
+    struct Stats
+    {
+      char const* name;
+      uint samples;
+      double minMs;
+      double avgMs;
+      double p99Ms;
+    };
+
+    static Profiler& Get();
+
+    void SetEnabled(bool);
+    bool IsEnabled() const;
+
+    /// Labels the calling thread in traces.
+    ///
+    /// \param _name  Must outlive the profiler, a literal is ideal.
+    void SetThreadName(char const* _name);
+
+    /// Human readable name of a type for counters and zones. GCC and Clang
+    /// mangle type_info names, so they are demangled here.
+    ///
+    /// \param _type Type to name.
+    static std::string GetTypeName(std::type_index _type);
+
+    /// Registers a counter, normally once during set-up.
+    ///
+    /// \returns  Index for RecordSample, NoCounter if all are taken.
+    uint RegisterCounter(std::string const& _name);
+    char const* GetCounterName(uint _counter) const;
+
+    void RecordSample(uint _counter, std::uint64_t _ns);
+
+    /// \param _name  Must outlive the profiler, a literal is ideal.
+    void RecordZone(char const* _name, std::uint64_t _beginNs,
+                    std::uint64_t _endNs);
+
+    /// Nanoseconds since the profiler was created.
+    std::uint64_t Now() const;
+
+    //  dumps read the rings while threads may be writing to them. call
+    //  between frames, or expect the newest few zones to be torn
+    std::vector<Stats> GetStats() const;
+    void WriteChromeTrace(std::ostream&) const;
+    void WriteStatsTable(std::ostream&) const;
+
+  private:
+    struct Event
+    {
+      char const* name;
+      std::uint64_t beginNs;
+      std::uint64_t endNs;
+    };
+
+    struct ThreadBuffer
+    {
+      uint id{ 0 };
+      char const* name{ nullptr };
+      //  only the owning thread writes, readers stop at head
+      std::atomic<std::uint64_t> head{ 0 };
+      std::array<Event, EventCapacity> events{};
+    };
+
+    struct Counter
+    {
+      char const* name{ nullptr };
+      std::atomic<uint> written{ 0 };
+      std::array<std::uint64_t, SampleCapacity> samples{};
+    };
+
+    Profiler();
+    ThreadBuffer& threadBuffer();
+
+    std::chrono::steady_clock::time_point epoch_{};
+    std::atomic<bool> isEnabled_{ true };
+
+    mutable std::mutex threadLock_{};
+    std::vector<UPointer<ThreadBuffer>> threads_{};
+
+    //  names are registered once, samples are written lock-free after that.
+    //  the deque only owns the strings, counters point into it
+    std::mutex counterLock_{};
+    std::deque<std::string> counterNames_{};
+    std::array<Counter, MaxCounters> counters_{};
+    std::atomic<uint> counterCount_{ 0 };
+  };
+
+  /// Times the enclosing scope as a zone, and optionally as a counter sample.
+  class ProfileZone
+  {
+  public:
+    explicit ProfileZone(char const* _name,
+                         uint _counter = Profiler::NoCounter);
+    ~ProfileZone();
+
+    ProfileZone(ProfileZone const&) = delete;
+    ProfileZone& operator=(ProfileZone const&) = delete;
+  private:
+    char const* name_;
+    uint counter_;
+    std::uint64_t beginNs_;
+  };
+}
+
+#define TRISKERVILLE_CONCAT_IMPL(a, b) a##b
+#define TRISKERVILLE_CONCAT(a, b) TRISKERVILLE_CONCAT_IMPL(a, b)
+
+#if defined(TRISKERVILLE_NO_PROFILER)
+  #define TRISKERVILLE_PROFILE_ZONE(name)
+  #define TRISKERVILLE_PROFILE_COUNTER_ZONE(name, counter)
+#else
+  #define TRISKERVILLE_PROFILE_ZONE(name) \
+    ::triskerville::ProfileZone TRISKERVILLE_CONCAT(profileZone_, __LINE__){ name }
+  #define TRISKERVILLE_PROFILE_COUNTER_ZONE(name, counter) \
+    ::triskerville::ProfileZone TRISKERVILLE_CONCAT(profileZone_, __LINE__){ \
+      name, counter }
+#endif
@@ -0,0 +1,217 @@
+// file:    ServiceScheduler.cpp
+// author:  Tristan Baskerville
+// brief:
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#include <stdafx.h>
+#include <Core/ServiceScheduler.h>
+#include <Core/ThreadPool.h>
+#include <Core/Profiler.h>
+#include <Interfaces/IService.h>
+
+namespace triskerville
+{
+  ServiceScheduler::ServiceScheduler(ThreadPool& _pool)
+    : pool_(_pool)
+  {
+  }
+
+  void ServiceScheduler::AddService(
+    std::type_index _type, IService* _pService,
+    std::vector<std::type_index> const& _dependencies)
+  {
+    uint index = static_cast<uint>(nodes_.size());
+
+    Node node;
+    node.pService = _pService;
+    node.affinity = _pService->GetThreadAffinity();
+
+#if !defined(TRISKERVILLE_NO_PROFILER)
+    //  the profiler keeps the names alive, zones only store the pointer
+    auto& profiler = Profiler::Get();
+    std::string name = Profiler::GetTypeName(_type);
+    node.beginCounter = profiler.RegisterCounter(name + "::FrameBegin");
+    node.fixedCounter = profiler.RegisterCounter(name + "::FixedUpdate");
+    node.endCounter = profiler.RegisterCounter(name + "::FrameEnd");
+    node.beginName = profiler.GetCounterName(node.beginCounter);
+    node.fixedName = profiler.GetCounterName(node.fixedCounter);
+    node.endName = profiler.GetCounterName(node.endCounter);
+    //  out of counters, still label the zones
+    if (not node.beginName) node.beginName = _type.name();
+    if (not node.fixedName) node.fixedName = _type.name();
+    if (not node.endName) node.endName = _type.name();
+#endif
+    for (auto const& dependency : _dependencies)
+    {
+      //  fails fast if a dependency was never added, same as InstallService
+      uint dependencyIndex = nodeIndices_.at(dependency);
+      node.dependencies.push_back(dependencyIndex);
+      nodes_[dependencyIndex].dependents.push_back(index);
+    }
+
+    nodes_.emplace_back(std::move(node));
+    nodeIndices_.emplace(_type, index);
+
+    //  atomics can't be moved, so the counters are reallocated on every add.
+    //  this only happens while the application is being set up
+    pending_ = std::make_unique<std::atomic<uint>[]>(nodes_.size());
+  }
+
+  bool ServiceScheduler::FrameBegin(float _dt)
+  {
+    dt_ = _dt;
+    isTerminating_.store(false, std::memory_order_relaxed);
+    runPhase(Phase::Begin);
+    return not isTerminating_.load(std::memory_order_relaxed);
+  }
+
+  bool ServiceScheduler::FixedUpdate(float _step)
+  {
+    dt_ = _step;
+    isTerminating_.store(false, std::memory_order_relaxed);
+    runPhase(Phase::Fixed);
+    return not isTerminating_.load(std::memory_order_relaxed);
+  }
+
+  void ServiceScheduler::FrameEnd()
+  {
+    runPhase(Phase::End);
+  }
+
+  void ServiceScheduler::SetInterpolationAlpha(float _alpha)
+  {
+    //  only called between phases, nothing is reading it right now
+    for (auto& node : nodes_)
+      node.pService->interpolationAlpha_ = _alpha;
+  }
+
+  void ServiceScheduler::runPhase(Phase _phase)
+  {
+    if (nodes_.empty()) return;
+
+    //  roots come from the graph, not the counters. once the first root is
+    //  dispatched its dependents start counting down, and a counter that
+    //  reached zero would be dispatched a second time by this loop
+    uint count = static_cast<uint>(nodes_.size());
+    std::vector<uint> roots;
+    for (uint i = 0; i < count; ++i)
+    {
+      auto const& node = nodes_[i];
+      auto edges = (_phase == Phase::End)
+        ? node.dependents.size()
+        : node.dependencies.size();
+      pending_[i].store(static_cast<uint>(edges), std::memory_order_relaxed);
+      if (edges == 0) roots.push_back(i);
+    }
+    remaining_.store(count, std::memory_order_release);
+
+    //  kick off every service with nothing to wait on
+    for (uint index : roots)
+      dispatch(index, _phase);
+
+    //  the calling thread owns the GL context, so it runs pinned services
+    //  as they become ready until the whole phase is done
+    std::unique_lock<std::mutex> lock(mainLock_);
+    while (true)
+    {
+      mainReady_.wait(lock, [this]
+        {
+          return not mainQueue_.empty() or
+                 remaining_.load(std::memory_order_acquire) == 0;
+        });
+
+      if (mainQueue_.empty()) break;
+
+      uint index = mainQueue_.front();
+      mainQueue_.pop_front();
+      lock.unlock();
+      execute(index, _phase);
+      lock.lock();
+    }
+
+    //  hand a failing service's exception back to Application::Run
+    if (pException_)
+    {
+      auto pException = pException_;
+      pException_ = nullptr;
+      std::rethrow_exception(pException);
+    }
+  }
+
+  void ServiceScheduler::dispatch(uint _index, Phase _phase)
+  {
+    //  without any workers everything falls back to the calling thread
+    if (nodes_[_index].affinity == ThreadAffinity::Any and
+        pool_.GetWorkerCount() > 0)
+    {
+      pool_.Submit([this, _index, _phase] { execute(_index, _phase); });
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mainLock_);
+      mainQueue_.push_back(_index);
+    }
+    mainReady_.notify_one();
+  }
+
+  void ServiceScheduler::execute(uint _index, Phase _phase)
+  {
+    auto& node = nodes_[_index];
+
+    //  once a service wants to stop, nothing else needs to begin this frame
+    if (not isTerminating_.load(std::memory_order_acquire))
+    {
+      try
+      {
+        if (_phase == Phase::Begin)
+        {
+          {
+            TRISKERVILLE_PROFILE_COUNTER_ZONE(node.beginName, node.beginCounter);
+            node.pService->FrameBegin(dt_);
+          }
+          if (node.pService->ShouldTerminate())
+            isTerminating_.store(true, std::memory_order_release);
+        }
+        else if (_phase == Phase::Fixed)
+        {
+          {
+            TRISKERVILLE_PROFILE_COUNTER_ZONE(node.fixedName, node.fixedCounter);
+            node.pService->FixedUpdate(dt_);
+          }
+          if (node.pService->ShouldTerminate())
+            isTerminating_.store(true, std::memory_order_release);
+        }
+        else
+        {
+          TRISKERVILLE_PROFILE_COUNTER_ZONE(node.endName, node.endCounter);
+          node.pService->FrameEnd();
+        }
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(mainLock_);
+        if (not pException_) pException_ = std::current_exception();
+        isTerminating_.store(true, std::memory_order_release);
+      }
+    }
+
+    //  release whoever was waiting on us. FrameEnd walks the edges backwards
+    auto const& next = (_phase == Phase::End)
+      ? node.dependencies
+      : node.dependents;
+    for (uint index : next)
+    {
+      if (pending_[index].fetch_sub(1, std::memory_order_acq_rel) == 1)
+        dispatch(index, _phase);
+    }
+
+    //  last one out wakes the calling thread. the count drops under the
+    //  lock, so the calling thread can't see zero, return and let the
+    //  scheduler be destroyed while this thread still touches mainLock_
+    std::lock_guard<std::mutex> lock(mainLock_);
+    if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      mainReady_.notify_one();
+  }
+}
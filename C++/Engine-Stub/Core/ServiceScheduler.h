@@ -0,0 +1,102 @@
+// file:    ServiceScheduler.h
+// author:  Tristan Baskerville
+// brief:   Runs a frame of IServices as a dependency graph instead of a list.
+//          Services that don't depend on each other run at the same time on
+//          a ThreadPool, services pinned to the main thread run on the thread
+//          that calls FrameBegin/FrameEnd.
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#pragma once
+
+#include <triskerville_fwd.h>
+#include <Interfaces/INoCopy.h>
+#include <Interfaces/IService.h>
+
+namespace triskerville
+{
+  /// Orders services by the IDependencyList each one was installed with.
+  /// FrameBegin runs a service only after all of its dependencies have run
+  /// theirs, FrameEnd runs the other way around, matching the install order
+  /// and reverse install order Application used when running on one thread.
+  ///
+  /// \author Tristan Baskerville
+  /// \date 3/02/2022
+  class ServiceScheduler : public virtual INoCopy
+  {
+  public:
+    explicit ServiceScheduler(ThreadPool&);
+
+    /// Adds a service to the graph. Dependencies must already be added,
+    /// which InstallService guarantees, so the graph can't have cycles.
+    ///
+    /// \param _type          Key the service was installed with.
+    /// \param _pService      Service to run, must outlive the scheduler.
+    /// \param _dependencies  Keys of the services it depends on.
+    void AddService(std::type_index _type, IService* _pService,
+                    std::vector<std::type_index> const& _dependencies);
+
+    /// Runs FrameBegin on every service, blocking until all have finished.
+    ///
+    /// \param _dt  Delta time handed to each service.
+    ///
+    /// \returns  False if any service asked to terminate. Services that
+    ///           depend on that service are skipped.
+    bool FrameBegin(float _dt);
+
+    /// Runs one fixed step on every service, in the same order as
+    /// FrameBegin, blocking until all have finished.
+    ///
+    /// \param _step Fixed timestep handed to each service.
+    ///
+    /// \returns  False if any service asked to terminate.
+    bool FixedUpdate(float _step);
+
+    /// Runs FrameEnd on every service, blocking until all have finished.
+    void FrameEnd();
+
+    /// Hands every service the interpolation alpha for this frame.
+    void SetInterpolationAlpha(float _alpha);
+
+  private:
+    enum class Phase { Begin, Fixed, End };
+
+    struct Node
+    {
+      IService* pService{ nullptr };
+      ThreadAffinity affinity{ ThreadAffinity::Any };
+      //  every phase is timed as a profiler zone and counter
+      char const* beginName{ nullptr };
+      char const* fixedName{ nullptr };
+      char const* endName{ nullptr };
+      uint beginCounter{ 0 };
+      uint fixedCounter{ 0 };
+      uint endCounter{ 0 };
+      //  edges in both directions, FrameEnd walks the graph backwards
+      std::vector<uint> dependencies{};
+      std::vector<uint> dependents{};
+    };
+
+    void runPhase(Phase);
+    void dispatch(uint, Phase);
+    void execute(uint, Phase);
+
+    ThreadPool& pool_;
+
+    std::vector<Node> nodes_{};
+    std::unordered_map<std::type_index, uint> nodeIndices_{};
+    //  per-node count of edges still waiting on this phase
+    UPointer<std::atomic<uint>[]> pending_{ nullptr };
+
+    //  main-thread services that are ready to run, and work left this phase
+    std::mutex mainLock_{};
+    std::condition_variable mainReady_{};
+    std::deque<uint> mainQueue_{};
+    std::atomic<uint> remaining_{ 0 };
+
+    float dt_{ 0.f };
+    std::atomic<bool> isTerminating_{ false };
+    //  first exception thrown by a service, rethrown on the calling thread
+    std::exception_ptr pException_{ nullptr };
+  };
+}
@@ -0,0 +1,131 @@
+// file:    ThreadPool.cpp
+// author:  Tristan Baskerville
+// brief:
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#include <stdafx.h>
+#include <Core/ThreadPool.h>
+#include <Core/Profiler.h>
+
+namespace triskerville
+{
+  thread_local ThreadPool const* ThreadPool::pCurrentPool_ = nullptr;
+  thread_local uint ThreadPool::currentWorker_ = 0;
+
+  ThreadPool::ThreadPool(uint _workerCount)
+  {
+    //  every deque must exist before any worker starts stealing from them
+    workers_.reserve(_workerCount);
+    for (uint i = 0; i < _workerCount; ++i)
+      workers_.emplace_back(std::make_unique<Worker>());
+
+    threads_.reserve(_workerCount);
+    for (uint i = 0; i < _workerCount; ++i)
+      threads_.emplace_back(&ThreadPool::workerLoop, this, i);
+  }
+
+  ThreadPool::~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(sleepLock_);
+      isStopping_ = true;
+    }
+    wake_.notify_all();
+
+    //  workers finish whatever is still queued before they exit
+    for (auto& thread : threads_)
+      thread.join();
+  }
+
+  void ThreadPool::Submit(Task&& _task)
+  {
+    if (workers_.empty()) return;
+
+    //  our own workers push to their own deque, everyone else round-robins
+    uint index = (pCurrentPool_ == this)
+      ? currentWorker_
+      : nextWorker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+
+    {
+      auto& worker = *workers_[index];
+      std::lock_guard<std::mutex> lock(worker.lock);
+      worker.tasks.emplace_back(std::move(_task));
+    }
+    queued_.fetch_add(1, std::memory_order_release);
+
+    //  taking the lock orders this wake with a worker checking queued_
+    { std::lock_guard<std::mutex> lock(sleepLock_); }
+    wake_.notify_one();
+  }
+
+  uint ThreadPool::GetWorkerCount() const
+  {
+    return static_cast<uint>(workers_.size());
+  }
+
+  uint ThreadPool::DefaultWorkerCount()
+  {
+    //  hardware_concurrency is allowed to return 0 if it can't tell
+    uint cores = std::thread::hardware_concurrency();
+    return cores > 1 ? cores - 1 : 0;
+  }
+
+  void ThreadPool::workerLoop(uint _index)
+  {
+    pCurrentPool_ = this;
+    currentWorker_ = _index;
+    Profiler::Get().SetThreadName("Service Worker");
+
+    while (true)
+    {
+      Task task;
+      if (tryPop(_index, task) or trySteal(_index, task))
+      {
+        task();
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(sleepLock_);
+      wake_.wait(lock, [this]
+        {
+          return isStopping_ or queued_.load(std::memory_order_acquire) > 0;
+        });
+
+      if (isStopping_ and queued_.load(std::memory_order_acquire) == 0)
+        return;
+    }
+  }
+
+  bool ThreadPool::tryPop(uint _index, Task& _task)
+  {
+    auto& worker = *workers_[_index];
+    std::lock_guard<std::mutex> lock(worker.lock);
+    if (worker.tasks.empty()) return false;
+
+    //  newest first, its data is most likely still in this core's cache
+    _task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    queued_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  bool ThreadPool::trySteal(uint _index, Task& _task)
+  {
+    uint count = static_cast<uint>(workers_.size());
+    //  start at our neighbour so thieves don't all pile onto worker 0
+    for (uint i = 1; i < count; ++i)
+    {
+      auto& victim = *workers_[(_index + i) % count];
+      std::lock_guard<std::mutex> lock(victim.lock);
+      if (victim.tasks.empty()) continue;
+
+      //  oldest first, it is the one the owner is least likely to want
+      _task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      queued_.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+    return false;
+  }
+}
@@ -0,0 +1,69 @@
+// file:    ThreadPool.h
+// author:  Tristan Baskerville
+// brief:   Work-stealing thread pool. Every worker owns a deque of tasks,
+//          runs its newest task first, and steals the oldest task of another
+//          worker once its own deque runs dry.
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#pragma once
+
+#include <Interfaces/INoCopy.h>
+
+namespace triskerville
+{
+  /// A fixed set of worker threads that run submitted tasks. Tasks submitted
+  /// from a worker go to that worker's own deque, so follow-up work stays on
+  /// a warm cache. Tasks from any other thread are spread across the workers.
+  ///
+  /// \author Tristan Baskerville
+  /// \date 3/02/2022
+  class ThreadPool : public virtual INoCopy
+  {
+  public:
+    using Task = std::function<void()>;
+
+    /// Starts the workers. A pool with no workers is valid, but every task
+    /// submitted to it is dropped, so callers must check GetWorkerCount().
+    ///
+    /// \param _workerCount Number of threads to start.
+    explicit ThreadPool(uint _workerCount = DefaultWorkerCount());
+    ~ThreadPool();
+
+    /// Queues a task to run on one of the workers.
+    ///
+    /// \param _task Callable to run, must not throw.
+    void Submit(Task&& _task);
+
+    uint GetWorkerCount() const;
+
+    /// One worker per hardware thread, minus the main thread.
+    static uint DefaultWorkerCount();
+
+  private:
+    struct Worker
+    {
+      std::mutex lock;
+      std::deque<Task> tasks;
+    };
+
+    void workerLoop(uint);
+    bool tryPop(uint, Task&);
+    bool trySteal(uint, Task&);
+
+    std::vector<UPointer<Worker>> workers_{};
+    std::vector<std::thread> threads_{};
+
+    //  counts tasks sitting in any deque, idle workers sleep while it is 0
+    std::atomic<uint> queued_{ 0 };
+    std::atomic<uint> nextWorker_{ 0 };
+
+    std::mutex sleepLock_{};
+    std::condition_variable wake_{};
+    bool isStopping_{ false };
+
+    //  lets Submit know if it is being called from one of our own workers
+    static thread_local ThreadPool const* pCurrentPool_;
+    static thread_local uint currentWorker_;
+  };
+}
@@ -0,0 +1,41 @@
+// file:    TypeHash.h
+// author:  Tristan Baskerville
+// brief:   Compile-time hash of a type's name, so types can be used as keys
+//          without RTTI or a registration step.
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#pragma once
+
+namespace triskerville
+{
+  //  FNV-1a, simple enough to run at compile time and good enough for names
+  constexpr std::uint64_t HashString(char const* _str, size_t _length)
+  {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < _length; ++i)
+    {
+      hash ^= static_cast<byte>(_str[i]);
+      hash *= 1099511628211ull;
+    }
+    return hash;
+  }
+
+  /// Hashes the compiler's signature for this function, which spells out T.
+  /// Two types only share a hash if their names collide, and the result may
+  /// change between compilers, so it must never be saved to disk.
+  ///
+  /// \tparam T Type to hash, cv and reference qualifiers are part of it.
+  template <typename T>
+  constexpr std::uint64_t TypeHash()
+  {
+#if defined(_MSC_VER)
+    constexpr char const* signature = __FUNCSIG__;
+    constexpr size_t length = sizeof(__FUNCSIG__) - 1;
+#else
+    constexpr char const* signature = __PRETTY_FUNCTION__;
+    constexpr size_t length = sizeof(__PRETTY_FUNCTION__) - 1;
+#endif
+    return HashString(signature, length);
+  }
+}
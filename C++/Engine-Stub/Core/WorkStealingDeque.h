@@ -0,0 +1,87 @@
+// file:    WorkStealingDeque.h
+// author:  Tristan Baskerville
+// brief:   Fixed-size Chase-Lev deque. The owning thread pushes and pops at
+//          the bottom without locks, any other thread may steal from the top.
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#pragma once
+
+namespace triskerville
+{
+  /// Lock-free single-owner deque, following "Correct and Efficient
+  /// Work-Stealing for Weak Memory Models" (Le et al. 2013). Only the owner
+  /// may call Push and Pop, any thread may call Steal.
+  ///
+  /// \tparam T         Trivially copyable element, normally a pointer.
+  /// \tparam Capacity  Number of slots, must be a power of two.
+  template <typename T, uint Capacity>
+  class WorkStealingDeque
+  {
+    static_assert((Capacity & (Capacity - 1)) == 0,
+                  "WorkStealingDeque capacity must be a power of two.");
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "WorkStealingDeque elements must be trivially copyable.");
+  public:
+    /// \returns  False if the deque is full, the caller keeps the element.
+    inline bool Push(T _element)
+    {
+      auto bottom = bottom_.load(std::memory_order_relaxed);
+      auto top = top_.load(std::memory_order_acquire);
+      if (bottom - top >= static_cast<std::int64_t>(Capacity)) return false;
+
+      slots_[bottom & Mask].store(_element, std::memory_order_relaxed);
+      //  the element must be visible before a thief can see the new bottom
+      std::atomic_thread_fence(std::memory_order_release);
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return true;
+    }
+
+    /// \returns  False if the deque is empty, or a thief won the last element.
+    inline bool Pop(T& _element)
+    {
+      auto bottom = bottom_.load(std::memory_order_relaxed) - 1;
+      bottom_.store(bottom, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      auto top = top_.load(std::memory_order_relaxed);
+
+      if (top > bottom)
+      {
+        //  already empty, undo our claim on the bottom
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        return false;
+      }
+
+      _element = slots_[bottom & Mask].load(std::memory_order_relaxed);
+      if (top != bottom) return true;
+
+      //  last element, race the thieves for it through top
+      bool won = top_.compare_exchange_strong(top, top + 1,
+        std::memory_order_seq_cst, std::memory_order_relaxed);
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return won;
+    }
+
+    /// \returns  False if the deque is empty, or another thread got there
+    ///           first. Either way the thief should move on.
+    inline bool Steal(T& _element)
+    {
+      auto top = top_.load(std::memory_order_acquire);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      auto bottom = bottom_.load(std::memory_order_acquire);
+      if (top >= bottom) return false;
+
+      _element = slots_[top & Mask].load(std::memory_order_relaxed);
+      return top_.compare_exchange_strong(top, top + 1,
+        std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+  private:
+    static constexpr std::int64_t Mask = Capacity - 1;
+
+    //  thieves hammer top, the owner hammers bottom. keep them apart
+    alignas(64) std::atomic<std::int64_t> top_{ 0 };
+    alignas(64) std::atomic<std::int64_t> bottom_{ 0 };
+    alignas(64) std::array<std::atomic<T>, Capacity> slots_{};
+  };
+}
@@ -0,0 +1,144 @@
+// file:    InstanceBuffer.cpp
+// author:  Tristan Baskerville
+// brief:   
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#include <stdafx.h>
+#include <Graphics/InstanceBuffer.h>
+
+namespace triskerville::Graphics
+{
+  static size_t alignUp(size_t _size, size_t _alignment)
+  {
+    return (_size + _alignment - 1) / _alignment * _alignment;
+  }
+
+  InstanceBuffer::InstanceBuffer(uint _capacity)
+  {
+#if !defined(TRISKERVILLE_HEADLESS)
+    //  every bound range has to start on this boundary
+    GLint alignment = 0;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    alignment_ = std::max<size_t>(alignment, alignof(glm::mat4));
+#endif
+    Reserve(_capacity, 1);
+  }
+
+  InstanceBuffer::~InstanceBuffer()
+  {
+    release();
+  }
+
+  void InstanceBuffer::BeginFrame()
+  {
+    region_ = (region_ + 1) % RegionCount;
+    cursor_ = 0;
+
+#if !defined(TRISKERVILLE_HEADLESS)
+    auto& fence = fences_[region_];
+    if (fence == nullptr) return;
+
+    //  flush once, in case the fence hasn't even reached the GPU yet
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (true)
+    {
+      GLenum result = glClientWaitSync(fence, flags, 1'000'000);
+      if (result == GL_ALREADY_SIGNALED or result == GL_CONDITION_SATISFIED or
+          result == GL_WAIT_FAILED)
+        break;
+      flags = 0;
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+#endif
+  }
+
+  void InstanceBuffer::EndFrame()
+  {
+#if !defined(TRISKERVILLE_HEADLESS)
+    fences_[region_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#endif
+  }
+
+  void InstanceBuffer::Reserve(uint _instanceCount, uint _batchCount)
+  {
+    //  every batch may need padding to start on the alignment
+    size_t size = _instanceCount * sizeof(glm::mat4) +
+                  _batchCount * alignment_;
+    if (size <= regionSize_) return;
+
+    //  grow in powers of two so a scene that keeps growing settles quickly
+    size_t regionSize = std::max<size_t>(regionSize_, alignment_);
+    while (regionSize < size)
+      regionSize *= 2;
+
+    release();
+    allocate(regionSize);
+    capacity_ = static_cast<uint>(regionSize / sizeof(glm::mat4));
+  }
+
+  size_t InstanceBuffer::Write(glm::mat4 const* _pInstances, uint _count)
+  {
+    size_t offset = region_ * regionSize_ + alignUp(cursor_, alignment_);
+    size_t size = _count * sizeof(glm::mat4);
+    std::memcpy(pMapped_ + offset, _pInstances, size);
+    cursor_ = offset - region_ * regionSize_ + size;
+    return offset;
+  }
+
+  void InstanceBuffer::BindRange(size_t _offset, uint _count) const
+  {
+#if !defined(TRISKERVILLE_HEADLESS)
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, Binding, handle_,
+                      static_cast<GLintptr>(_offset),
+                      static_cast<GLsizeiptr>(_count * sizeof(glm::mat4)));
+#endif
+  }
+
+  uint InstanceBuffer::GetCapacity() const
+  {
+    return capacity_;
+  }
+
+  void InstanceBuffer::allocate(size_t _regionSize)
+  {
+    regionSize_ = _regionSize;
+    size_t size = regionSize_ * RegionCount;
+
+#if defined(TRISKERVILLE_HEADLESS)
+    pMemory_ = std::make_unique<byte[]>(size);
+    pMapped_ = pMemory_.get();
+#else
+    //  coherent, so writes are visible to the GPU without explicit flushes
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT |
+                       GL_MAP_COHERENT_BIT;
+    glCreateBuffers(1, &handle_);
+    glNamedBufferStorage(handle_, static_cast<GLsizeiptr>(size), nullptr, flags);
+    pMapped_ = static_cast<byte*>(glMapNamedBufferRange(
+      handle_, 0, static_cast<GLsizeiptr>(size), flags));
+#endif
+  }
+
+  void InstanceBuffer::release()
+  {
+#if defined(TRISKERVILLE_HEADLESS)
+    pMemory_.reset();
+#else
+    if (handle_ == 0) return;
+
+    //  the GPU may still be reading any region, let it finish first
+    for (auto& fence : fences_)
+    {
+      if (fence == nullptr) continue;
+      glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+      glDeleteSync(fence);
+      fence = nullptr;
+    }
+    glUnmapNamedBuffer(handle_);
+    glDeleteBuffers(1, &handle_);
+    handle_ = 0;
+#endif
+    pMapped_ = nullptr;
+  }
+}
@@ -0,0 +1,72 @@
+// file:    InstanceBuffer.h
+// author:  Tristan Baskerville
+// brief:   Per-instance transforms for instanced draws. The buffer is mapped
+//          once and stays mapped, split into one region per frame in flight
+//          so the CPU never writes what the GPU may still be reading.
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#pragma once
+
+#include <Interfaces/IRenderable.h>
+
+namespace triskerville::Graphics
+{
+  /// Shader storage buffer of mat4s, persistently and coherently mapped.
+  /// Shaders read it as
+  ///
+  ///   layout(std430, binding = 1) readonly buffer Instances { mat4 models[]; };
+  ///
+  /// indexed by gl_InstanceID. Headless builds keep the regions in plain
+  /// memory so the copies still cost what they would.
+  ///
+  /// \author Tristan Baskerville
+  /// \date 4/27/2022
+  class InstanceBuffer : public IRenderable
+  {
+  public:
+    //  the shader storage binding shaders read instances from
+    static constexpr uint Binding = 1;
+    //  frames the CPU may run ahead of the GPU
+    static constexpr uint RegionCount = 3;
+
+    explicit InstanceBuffer(uint _capacity = 4096);
+    ~InstanceBuffer();
+
+    /// Moves on to the next region, waiting for the GPU if it is still
+    /// reading it from RegionCount frames ago.
+    void BeginFrame();
+    /// Fences the region written this frame.
+    void EndFrame();
+
+    /// Makes sure a region fits the instances and batches about to be
+    /// written. Growing waits for the GPU and reallocates, so call it before
+    /// the frame's first Write.
+    void Reserve(uint _instanceCount, uint _batchCount);
+
+    /// Copies instances into this frame's region.
+    ///
+    /// \returns  Byte offset of the copy, for BindRange.
+    size_t Write(glm::mat4 const* _pInstances, uint _count);
+    void BindRange(size_t _offset, uint _count) const;
+
+    uint GetCapacity() const;
+
+  private:
+    void allocate(size_t _regionSize);
+    void release();
+
+    uint capacity_{ 0 };
+    size_t alignment_{ 16 };
+    size_t regionSize_{ 0 };
+    uint region_{ 0 };
+    size_t cursor_{ 0 };
+
+    byte* pMapped_{ nullptr };
+#if defined(TRISKERVILLE_HEADLESS)
+    UPointer<byte[]> pMemory_{ nullptr };
+#else
+    std::array<GLsync, RegionCount> fences_{};
+#endif
+  };
+}
@@ -0,0 +1,144 @@
+// file:    GLRenderer.cpp
+// author:  Tristan Baskerville
+// brief:
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#include <stdafx.h>
+
+//  headless builds have no GL context, NullRenderer takes these calls
+#if !defined(TRISKERVILLE_HEADLESS)
+
+#include <Graphics/Platform/GLRenderer.h>
+#include <Graphics/Common.h>
+#include <Graphics/Framebuffer.h>
+#include <Graphics/Texture/Texture2D.h>
+#include <Graphics/Texture/Cubemap.h>
+
+namespace triskerville::Graphics::Platform
+{
+  GLRenderer::GLRenderer()
+    : pRenderer_(CreateRenderer())
+  {
+    glEnable(GL_CULL_FACE);
+    glDepthFunc(GL_LEQUAL);
+  }
+
+  GLRenderer::~GLRenderer() = default;
+
+  void GLRenderer::BeginFrame()
+  {
+    //  just make sure these get emptied every frame
+    for (auto& pTarget : targets_)
+      if (pTarget) pTarget->Clear();
+  }
+
+  void GLRenderer::SetViewport(int _width, int _height)
+  {
+    size_ = { _width, _height };
+    pRenderer_->SetViewport(_width, _height);
+    //  OpenGL is a lil busted, so for now, just reallocate the FBOs
+    reallocateTargets();
+  }
+
+  void GLRenderer::SetState(RenderState _state, bool _isEnabled)
+  {
+    switch (_state)
+    {
+    case RenderState::DepthTest:
+      if (_isEnabled) glEnable(GL_DEPTH_TEST);
+      else            glDisable(GL_DEPTH_TEST);
+      break;
+    case RenderState::DepthWrite:
+      glDepthMask(_isEnabled ? GL_TRUE : GL_FALSE);
+      break;
+    case RenderState::Blend:
+      if (_isEnabled)
+      {
+        glBlendFunc(GL_ONE, GL_ONE);
+        glEnable(GL_BLEND);
+      }
+      else
+      {
+        glDisable(GL_BLEND);
+      }
+      break;
+    case RenderState::CullFront:
+      glCullFace(_isEnabled ? GL_FRONT : GL_BACK);
+      break;
+    }
+  }
+
+  void GLRenderer::BindTarget(RenderTarget _target)
+  {
+    if (_target == boundTarget_) return;
+
+    if (auto& pBound = targets_[static_cast<size_t>(boundTarget_)])
+      pBound->Unbind();
+    if (auto& pTarget = targets_[static_cast<size_t>(_target)])
+      pTarget->Bind();
+    boundTarget_ = _target;
+  }
+
+  void GLRenderer::CopyDepth(RenderTarget _from)
+  {
+    targets_[static_cast<size_t>(boundTarget_)]->CopyDepth(
+      targets_[static_cast<size_t>(_from)]);
+  }
+
+  auto GLRenderer::GetTargetTextures(RenderTarget _target) const
+    -> std::vector<Texture2D> const&
+  {
+    return targets_[static_cast<size_t>(_target)]->GetTextures();
+  }
+
+  SPointer<Shader> GLRenderer::CreateShader(
+    std::string const& _vertexPath, std::string const& _fragmentPath)
+  {
+    return std::make_shared<Shader>(Shader{ _vertexPath, _fragmentPath });
+  }
+
+  void GLRenderer::BindShader(SPointer<Shader> const& _pShader)
+  {
+    if (_pShader == pShader_) return;
+
+    if (pShader_) pShader_->Unbind();
+    pShader_ = _pShader;
+    if (pShader_) pShader_->Bind();
+  }
+
+  void GLRenderer::SetTextures(RenderTarget _target)
+  {
+    //  the last texture is depth, no pass samples it
+    auto const& textures = GetTargetTextures(_target);
+    for (uint i = 0; i + 1 < textures.size(); ++i)
+      pShader_->SetUniform(i, textures[i]);
+  }
+
+  void GLRenderer::BindCubemap(Cubemap const& _cubemap)
+  {
+    _cubemap.Bind();
+  }
+
+  void GLRenderer::reallocateTargets()
+  {
+    //  a target bound across the resize would be unbound after it's gone
+    BindTarget(RenderTarget::Screen);
+
+    targets_[static_cast<size_t>(RenderTarget::GBuffer)] =
+      std::make_shared<Framebuffer>(
+        Framebuffer::Builder{ size_ }
+          .WithColorBuffer(Common::Layout::RGBA_Float, "gPosition")
+          .WithColorBuffer(Common::Layout::RGBA_Float, "gNormal")
+          .WithColorBuffer(Common::Layout::RGBA_Float, "gAlbedoSpec")
+          .Build());
+
+    targets_[static_cast<size_t>(RenderTarget::Scene)] =
+      std::make_shared<Framebuffer>(
+        Framebuffer::Builder{ size_ }
+          .WithColorBuffer(Common::Layout::RGBA_Float, "gScene")
+          .Build());
+  }
+}
+
+#endif
@@ -0,0 +1,102 @@
+// file:    GLRenderer.h
+// author:  Tristan Baskerville
+// brief:   OpenGL rendering backend. Wraps the platform Renderer's draw calls
+//          and owns the state, shaders and render targets RenderingService
+//          used to drive with raw gl* calls.
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#pragma once
+
+#include <triskerville_fwd.h>
+#include <Interfaces/INoCopy.h>
+#include <Graphics/Platform/RenderState.h>
+#include <Graphics/Platform/Renderer.h>
+#include <Graphics/Shader.h>
+
+namespace triskerville::Graphics::Platform
+{
+  /// Backend for windowed builds, NullRenderer takes the same calls when the
+  /// engine is built with TRISKERVILLE_HEADLESS.
+  ///
+  /// \author Tristan Baskerville
+  /// \date 4/12/2022
+  class GLRenderer : public virtual INoCopy
+  {
+  public:
+    GLRenderer();
+    ~GLRenderer();
+
+    //  clears every offscreen target
+    void BeginFrame();
+
+    //  offscreen targets are reallocated to match
+    void SetViewport(int, int);
+    void SetState(RenderState, bool);
+
+    void BindTarget(RenderTarget);
+    //  copies a target's depth into the bound one
+    void CopyDepth(RenderTarget _from);
+    std::vector<Texture2D> const& GetTargetTextures(RenderTarget) const;
+
+    SPointer<Shader> CreateShader(std::string const& _vertexPath,
+                                  std::string const& _fragmentPath);
+    //  nullptr unbinds, binding the bound shader again does nothing
+    void BindShader(SPointer<Shader> const&);
+
+    //  uniforms go to the bound shader
+    template <typename T>
+    inline void SetUniform(T const&, char const*);
+    //  a target's color textures in sampler slots 0 and up, depth excluded
+    void SetTextures(RenderTarget);
+    void BindCubemap(Cubemap const&);
+
+    template <typename... Args>
+    inline void RenderToWorld(Args const&...);
+    template <typename... Args>
+    inline void RenderToScreen(Args const&...);
+
+    inline auto GetUniformBuffer(std::string const&);
+
+  private:
+    static constexpr size_t TargetCount =
+      static_cast<size_t>(RenderTarget::Count);
+
+    void reallocateTargets();
+
+    UPointer<Renderer> pRenderer_{ nullptr };
+    SPointer<Shader> pShader_{ nullptr };
+
+    //  the screen has no framebuffer, its slot stays empty
+    std::array<SPointer<Framebuffer>, TargetCount> targets_{};
+    RenderTarget boundTarget_{ RenderTarget::Screen };
+    glm::ivec2 size_{};
+  };
+}
+
+template <typename T>
+inline void triskerville::Graphics::Platform::GLRenderer::SetUniform(
+  T const& _value, char const* _name)
+{
+  pShader_->SetUniform(_value, _name);
+}
+
+template <typename... Args>
+inline void triskerville::Graphics::Platform::GLRenderer::RenderToWorld(
+  Args const&... _args)
+{
+  pRenderer_->RenderToWorld(_args...);
+}
+
+template <typename... Args>
+inline void triskerville::Graphics::Platform::GLRenderer::RenderToScreen(
+  Args const&... _args)
+{
+  pRenderer_->RenderToScreen(_args...);
+}
+
+inline auto triskerville::Graphics::Platform::GLRenderer::GetUniformBuffer(
+  std::string const& _name)
+{
+  return pRenderer_->GetUniformBuffer(_name);
+}
@@ -0,0 +1,132 @@
+// file:    NullRenderer.cpp
+// author:  Tristan Baskerville
+// brief:   
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#include <stdafx.h>
+#include <Graphics/Platform/NullRenderer.h>
+#include <Graphics/Texture/Texture2D.h>
+
+namespace triskerville::Graphics::Platform
+{
+  void CommandLog::Record(RenderCommand const& _command)
+  {
+    commands_.push_back(_command);
+    ++counts_[static_cast<size_t>(_command.type)];
+  }
+
+  void CommandLog::Clear()
+  {
+    //  keeps its capacity, a warm log doesn't allocate
+    commands_.clear();
+    counts_.fill(0);
+  }
+
+  std::vector<RenderCommand> const& CommandLog::GetCommands() const
+  {
+    return commands_;
+  }
+
+  uint CommandLog::GetCount(Type _type) const
+  {
+    return counts_[static_cast<size_t>(_type)];
+  }
+
+  uint CommandLog::GetDrawCount() const
+  {
+    return GetCount(Type::DrawMesh) + GetCount(Type::DrawMeshInstanced) +
+           GetCount(Type::DrawQuads) + GetCount(Type::DrawScreenQuad);
+  }
+
+  NullUniformBuffer::NullUniformBuffer(
+    CommandLog& _log, std::string const& _name)
+    : log_(_log)
+    , name_(_name)
+  {
+  }
+
+  void NullRenderer::BeginFrame()
+  {
+    log_.Clear();
+  }
+
+  void NullRenderer::SetViewport(int _width, int _height)
+  {
+    log_.Record({ RenderCommand::Type::SetViewport, nullptr, nullptr,
+                  static_cast<uint>(_width), static_cast<uint>(_height) });
+  }
+
+  void NullRenderer::SetState(RenderState _state, bool _isEnabled)
+  {
+    log_.Record({ RenderCommand::Type::SetState, nullptr, nullptr,
+                  static_cast<uint>(_state), _isEnabled ? 1u : 0u });
+  }
+
+  void NullRenderer::BindTarget(RenderTarget _target)
+  {
+    log_.Record({ RenderCommand::Type::BindTarget, nullptr, nullptr,
+                  static_cast<uint>(_target) });
+  }
+
+  void NullRenderer::CopyDepth(RenderTarget _from)
+  {
+    log_.Record({ RenderCommand::Type::CopyDepth, nullptr, nullptr,
+                  static_cast<uint>(_from) });
+  }
+
+  auto NullRenderer::GetTargetTextures(RenderTarget) const
+    -> std::vector<Texture2D> const&
+  {
+    static std::vector<Texture2D> const noTextures{};
+    return noTextures;
+  }
+
+  SPointer<Shader> NullRenderer::CreateShader(
+    std::string const&, std::string const&)
+  {
+    return nullptr;
+  }
+
+  void NullRenderer::BindShader(SPointer<Shader> const& _pShader)
+  {
+    log_.Record({ RenderCommand::Type::BindShader, _pShader.get() });
+  }
+
+  void NullRenderer::SetTextures(RenderTarget _target)
+  {
+    log_.Record({ RenderCommand::Type::BindTextures, nullptr, nullptr,
+                  static_cast<uint>(_target) });
+  }
+
+  void NullRenderer::BindCubemap(Cubemap const& _cubemap)
+  {
+    log_.Record({ RenderCommand::Type::BindCubemap, &_cubemap });
+  }
+
+  void NullRenderer::RenderToWorld(
+    std::vector<Primitive::Quad3D> const& _quads)
+  {
+    log_.Record({ RenderCommand::Type::DrawQuads, _quads.data(), nullptr,
+                  static_cast<uint>(_quads.size()) });
+  }
+
+  void NullRenderer::RenderToScreen(Primitive::Quad2D const& _quad)
+  {
+    log_.Record({ RenderCommand::Type::DrawScreenQuad, &_quad });
+  }
+
+  NullUniformBuffer* NullRenderer::GetUniformBuffer(std::string const& _name)
+  {
+    //  buffers are made on first use, the same as the real renderer's
+    auto& pBuffer = buffers_[_name];
+    if (not pBuffer)
+      pBuffer = std::make_unique<NullUniformBuffer>(log_, _name);
+    return pBuffer.get();
+  }
+
+  CommandLog const& NullRenderer::GetCommandLog() const
+  {
+    return log_;
+  }
+}
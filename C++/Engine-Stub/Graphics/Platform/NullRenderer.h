@@ -0,0 +1,151 @@
+// file:    NullRenderer.h
+// author:  Tristan Baskerville
+// brief:   Headless rendering backend. Takes the same calls RenderingService
+//          makes on the platform Renderer, and records them into a command
+//          log instead of talking to a GPU.
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#pragma once
+
+#include <triskerville_fwd.h>
+#include <Graphics/Platform/RenderState.h>
+#include <Primitive/Quad.h>
+
+namespace triskerville::Graphics::Platform
+{
+  struct RenderCommand
+  {
+    enum class Type
+    {
+      SetViewport,
+      SetState,
+      BindTarget,
+      CopyDepth,
+      BindShader,
+      SetUniform,
+      BindTextures,
+      BindCubemap,
+      UpdateBuffer,
+      DrawMesh,
+      DrawMeshInstanced,
+      DrawQuads,
+      DrawScreenQuad,
+      Count
+    };
+
+    Type type;
+    //  identity of the shader, mesh, texture or buffer, never dereferenced
+    void const* pObject{ nullptr };
+    //  uniform or buffer name
+    char const* name{ nullptr };
+    //  viewport size, state and value, target, element, instance or byte
+    //  count
+    uint x{ 0 };
+    uint y{ 0 };
+  };
+
+  /// Everything the renderer was asked to do since the last BeginFrame.
+  class CommandLog
+  {
+  public:
+    using Type = RenderCommand::Type;
+
+    void Record(RenderCommand const&);
+    void Clear();
+
+    std::vector<RenderCommand> const& GetCommands() const;
+    uint GetCount(Type) const;
+    uint GetDrawCount() const;
+
+  private:
+    std::vector<RenderCommand> commands_{};
+    std::array<uint, static_cast<size_t>(Type::Count)> counts_{};
+  };
+
+  class NullUniformBuffer
+  {
+  public:
+    NullUniformBuffer(CommandLog&, std::string const&);
+
+    template <typename T>
+    inline void SetData(T const* _pData, size_t _count);
+
+  private:
+    CommandLog& log_;
+    std::string name_;
+  };
+
+  /// Stands in for GLRenderer when the engine is built with
+  /// TRISKERVILLE_HEADLESS. Takes the same calls and records each of them,
+  /// there are no shaders or offscreen targets without a GPU.
+  class NullRenderer
+  {
+  public:
+    //  starts a new log, the last frame's commands are dropped
+    void BeginFrame();
+
+    void SetViewport(int, int);
+    void SetState(RenderState, bool);
+
+    void BindTarget(RenderTarget);
+    void CopyDepth(RenderTarget _from);
+    //  always empty, nothing is rendered to read back
+    std::vector<Texture2D> const& GetTargetTextures(RenderTarget) const;
+
+    //  nothing to compile, built-in shaders are nullptr when headless
+    SPointer<Shader> CreateShader(std::string const&, std::string const&);
+    void BindShader(SPointer<Shader> const&);
+
+    template <typename T>
+    inline void SetUniform(T const&, char const*);
+    void SetTextures(RenderTarget);
+    void BindCubemap(Cubemap const&);
+
+    void RenderToWorld(std::vector<Primitive::Quad3D> const&);
+    template <typename MeshPointer>
+    inline void RenderToWorld(MeshPointer const&);
+    template <typename MeshPointer>
+    inline void RenderToWorld(MeshPointer const&, uint _instanceCount);
+    void RenderToScreen(Primitive::Quad2D const&);
+
+    NullUniformBuffer* GetUniformBuffer(std::string const&);
+
+    CommandLog const& GetCommandLog() const;
+
+  private:
+    CommandLog log_{};
+    std::unordered_map<std::string, UPointer<NullUniformBuffer>> buffers_{};
+  };
+}
+
+template <typename T>
+inline void triskerville::Graphics::Platform::NullUniformBuffer::SetData(
+  T const*, size_t _count)
+{
+  log_.Record({ RenderCommand::Type::UpdateBuffer, this, name_.c_str(),
+                static_cast<uint>(sizeof(T) * _count) });
+}
+
+template <typename T>
+inline void triskerville::Graphics::Platform::NullRenderer::SetUniform(
+  T const&, char const* _name)
+{
+  log_.Record({ RenderCommand::Type::SetUniform, nullptr, _name,
+                static_cast<uint>(sizeof(T)) });
+}
+
+template <typename MeshPointer>
+inline void triskerville::Graphics::Platform::NullRenderer::RenderToWorld(
+  MeshPointer const& _pMesh)
+{
+  log_.Record({ RenderCommand::Type::DrawMesh, &*_pMesh });
+}
+
+template <typename MeshPointer>
+inline void triskerville::Graphics::Platform::NullRenderer::RenderToWorld(
+  MeshPointer const& _pMesh, uint _instanceCount)
+{
+  log_.Record({ RenderCommand::Type::DrawMeshInstanced, &*_pMesh, nullptr,
+                _instanceCount });
+}
@@ -0,0 +1,23 @@
+// file:    RenderBackend.h
+// author:  Tristan Baskerville
+// brief:   Picks the renderer backend at compile time. Every backend takes
+//          the same calls, so RenderingService is written once for both.
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#pragma once
+
+#if defined(TRISKERVILLE_HEADLESS)
+  #include <Graphics/Platform/NullRenderer.h>
+#else
+  #include <Graphics/Platform/GLRenderer.h>
+#endif
+
+namespace triskerville::Graphics::Platform
+{
+#if defined(TRISKERVILLE_HEADLESS)
+  using RenderBackend = NullRenderer;
+#else
+  using RenderBackend = GLRenderer;
+#endif
+}
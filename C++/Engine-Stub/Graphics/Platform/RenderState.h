@@ -0,0 +1,30 @@
+// file:    RenderState.h
+// author:  Tristan Baskerville
+// brief:   State and targets RenderingService asks a renderer backend for.
+//          Shared by every backend, so the service never sees a gl* call.
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#pragma once
+
+namespace triskerville::Graphics::Platform
+{
+  //  fixed-function state RenderingService toggles between passes
+  enum class RenderState
+  {
+    DepthTest,
+    DepthWrite,
+    //  additive, the only blending the light pass needs
+    Blend,
+    CullFront
+  };
+
+  //  where draws land. the offscreen targets are sized to the viewport
+  enum class RenderTarget
+  {
+    Screen,
+    GBuffer,
+    Scene,
+    Count
+  };
+}
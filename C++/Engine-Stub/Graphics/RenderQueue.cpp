@@ -0,0 +1,112 @@
+// file:    RenderQueue.cpp
+// author:  Tristan Baskerville
+// brief:   
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#include <stdafx.h>
+#include <Graphics/RenderQueue.h>
+
+namespace triskerville::Graphics
+{
+  static_assert(RenderQueue::ShaderBits + RenderQueue::MeshBits +
+                RenderQueue::MaterialBits == 64,
+                "RenderQueue keys must fill exactly 64 bits.");
+
+  static constexpr std::uint64_t mask(uint _bits)
+  {
+    return (std::uint64_t{ 1 } << _bits) - 1;
+  }
+
+  std::uint64_t RenderQueue::MakeKey(uint _shader, uint _mesh, uint _material)
+  {
+    //  a field that doesn't fit would bleed into the one above it, or be
+    //  masked into another resource's id
+    assert(_shader <= mask(ShaderBits) and "Shader id overflows its key bits.");
+    assert(_mesh <= mask(MeshBits) and "Mesh id overflows its key bits.");
+    assert(_material <= mask(MaterialBits) and
+           "Material id overflows its key bits.");
+    return ((_shader & mask(ShaderBits)) << (MeshBits + MaterialBits)) |
+           ((_mesh & mask(MeshBits)) << MaterialBits) |
+           (_material & mask(MaterialBits));
+  }
+
+  uint RenderQueue::GetShader(std::uint64_t _key)
+  {
+    return static_cast<uint>(_key >> (MeshBits + MaterialBits));
+  }
+
+  uint RenderQueue::GetMesh(std::uint64_t _key)
+  {
+    return static_cast<uint>((_key >> MaterialBits) & mask(MeshBits));
+  }
+
+  uint RenderQueue::GetMaterial(std::uint64_t _key)
+  {
+    return static_cast<uint>(_key & mask(MaterialBits));
+  }
+
+  void RenderQueue::Clear()
+  {
+    items_.clear();
+    pushed_.clear();
+    sorted_.clear();
+    batches_.clear();
+  }
+
+  void RenderQueue::Push(std::uint64_t _key, glm::mat4 const& _instance)
+  {
+    items_.emplace_back(_key, static_cast<uint>(pushed_.size()));
+    pushed_.push_back(_instance);
+  }
+
+  void RenderQueue::Build(uint _maxInstances)
+  {
+    //  the push order breaks ties, so equal keys stay in push order
+    std::sort(items_.begin(), items_.end());
+
+    //  gather the transforms in sorted order, each batch becomes one
+    //  contiguous range that is copied to the GPU as is
+    sorted_.resize(items_.size());
+    batches_.clear();
+    std::uint64_t previous = 0;
+    for (uint i = 0; i < items_.size(); ++i)
+    {
+      auto [key, pushed] = items_[i];
+      sorted_[i] = pushed_[pushed];
+
+      if (not batches_.empty() and batches_.back().key == key and
+          batches_.back().instanceCount < _maxInstances)
+      {
+        ++batches_.back().instanceCount;
+        continue;
+      }
+
+      byte changes = 0;
+      if (batches_.empty() or GetShader(key) != GetShader(previous))
+        changes |= ShaderChange;
+      if (batches_.empty() or GetMesh(key) != GetMesh(previous))
+        changes |= MeshChange;
+      if (batches_.empty() or GetMaterial(key) != GetMaterial(previous))
+        changes |= MaterialChange;
+
+      batches_.push_back({ key, i, 1, changes });
+      previous = key;
+    }
+  }
+
+  auto RenderQueue::GetBatches() const -> std::vector<Batch> const&
+  {
+    return batches_;
+  }
+
+  glm::mat4 const* RenderQueue::GetInstances() const
+  {
+    return sorted_.data();
+  }
+
+  uint RenderQueue::GetInstanceCount() const
+  {
+    return static_cast<uint>(sorted_.size());
+  }
+}
@@ -0,0 +1,121 @@
+// file:    RenderQueue.h
+// author:  Tristan Baskerville
+// brief:   Sorts a frame's draws by a packed (shader, mesh, material) key and
+//          collapses runs of the same key into instanced batches. Pure CPU,
+//          nothing in here talks to the GPU.
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#pragma once
+
+#include <Interfaces/INoCopy.h>
+
+namespace triskerville::Graphics
+{
+  /// Draws are pushed with a key and a per-instance transform. Build() sorts
+  /// them so every shader is bound once, then every mesh once per shader, and
+  /// hands back batches that each index a contiguous run of transforms.
+  ///
+  /// \author Tristan Baskerville
+  /// \date 4/27/2022
+  class RenderQueue : public virtual INoCopy
+  {
+  public:
+    //  shader in the top bits, so it is the first thing sorted on
+    static constexpr uint ShaderBits = 16;
+    static constexpr uint MeshBits = 24;
+    static constexpr uint MaterialBits = 24;
+
+    //  what a batch changes compared to the one before it
+    enum Change : byte
+    {
+      ShaderChange   = 1 << 0,
+      MeshChange     = 1 << 1,
+      MaterialChange = 1 << 2
+    };
+
+    struct Batch
+    {
+      std::uint64_t key;
+      uint firstInstance;
+      uint instanceCount;
+      byte changes;
+    };
+
+    /// \param _shader    Less than 2^ShaderBits.
+    /// \param _mesh      Less than 2^MeshBits.
+    /// \param _material  Less than 2^MaterialBits.
+    static std::uint64_t MakeKey(uint _shader, uint _mesh, uint _material);
+    static uint GetShader(std::uint64_t _key);
+    static uint GetMesh(std::uint64_t _key);
+    static uint GetMaterial(std::uint64_t _key);
+
+    //  keeps capacity, a warm queue doesn't allocate
+    void Clear();
+    void Push(std::uint64_t _key, glm::mat4 const& _instance);
+
+    /// Sorts what was pushed since Clear. Equal keys keep the order they were
+    /// pushed in, and are collapsed into one batch.
+    ///
+    /// \param _maxInstances  Longest batch, longer runs are split in two.
+    void Build(uint _maxInstances = ~0u);
+
+    std::vector<Batch> const& GetBatches() const;
+    //  sorted transforms, batches index into this
+    glm::mat4 const* GetInstances() const;
+    uint GetInstanceCount() const;
+
+  private:
+    //  key and the order it was pushed in
+    std::vector<std::pair<std::uint64_t, uint>> items_{};
+    std::vector<glm::mat4> pushed_{};
+    std::vector<glm::mat4> sorted_{};
+    std::vector<Batch> batches_{};
+  };
+
+  /// Hands out small, dense ids for resources so they fit in a sort key, and
+  /// maps the ids back to the resources when batches are drawn.
+  template <typename T>
+  class ResourceTable
+  {
+  public:
+    uint Intern(SPointer<T> const& _pResource);
+    SPointer<T> const& Get(uint _id) const;
+    uint GetCount() const;
+    void Clear();
+
+  private:
+    std::unordered_map<T const*, uint> ids_{};
+    std::vector<SPointer<T>> resources_{};
+  };
+}
+
+template <typename T>
+inline uint triskerville::Graphics::ResourceTable<T>::Intern(
+  SPointer<T> const& _pResource)
+{
+  auto [it, isNew] = ids_.try_emplace(
+    _pResource.get(), static_cast<uint>(resources_.size()));
+  if (isNew) resources_.push_back(_pResource);
+  return it->second;
+}
+
+template <typename T>
+inline SPointer<T> const& triskerville::Graphics::ResourceTable<T>::Get(
+  uint _id) const
+{
+  return resources_[_id];
+}
+
+template <typename T>
+inline uint triskerville::Graphics::ResourceTable<T>::GetCount() const
+{
+  return static_cast<uint>(resources_.size());
+}
+
+template <typename T>
+inline void triskerville::Graphics::ResourceTable<T>::Clear()
+{
+  ids_.clear();
+  resources_.clear();
+}
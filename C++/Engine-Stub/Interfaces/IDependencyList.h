@@ -22,6 +22,13 @@ namespace triskerville
     using DependencyList = IDependencyList<Service...>;
     static constexpr uint DependencyCount = sizeof...(Service);
 
+    //  the same list as runtime keys, so a scheduler can order services
+    //  without knowing their types
+    static std::vector<std::type_index> GetDependencyTypes()
+    {
+      return { std::type_index(typeid(Service))... };
+    }
+
     IDependencyList(Tuple&& t) : pServicesTuple_(std::forward<Tuple>(t)) {}
     IDependencyList(DependencyList&&) = default;
     virtual ~IDependencyList() = default;
@@ -14,4 +14,14 @@ namespace triskerville
     //  if the services wishes to stop running, terminate the process
     return not isRunning_;
   }
+
+  float IService::GetInterpolationAlpha() const
+  {
+    return interpolationAlpha_;
+  }
+
+  ThreadAffinity IService::GetThreadAffinity() const
+  {
+    return threadAffinity_;
+  }
 }
\ No newline at end of file
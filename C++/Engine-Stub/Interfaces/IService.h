@@ -12,20 +12,40 @@
 
 namespace triskerville
 {
+  //  Which threads the ServiceScheduler may run a service on. Anything that
+  //  touches the GL context or GLFW must stay on the thread that made it.
+  enum class ThreadAffinity
+  {
+    Any,
+    MainThread
+  };
+
   class IService : public virtual INoCopy
   {
   public:
     //  allows for IService to be managed by a parent class
     friend class Application;
+    friend class ServiceScheduler;
     //  polymorphic classes must always use a virtual destructor
     virtual ~IService() = default;
+
+    ThreadAffinity GetThreadAffinity() const;
   protected:
     //  We do not want outside classes to touch these functions,
     //  so we tuck them away to only allow Application to access them.
     virtual void FrameBegin(float) = 0;
     virtual void FrameEnd() {};
+    //  Runs zero or more times a frame, always with the same timestep.
+    //  Called after FrameBegin and before FrameEnd
+    virtual void FixedUpdate(float) {};
+    //  How far this frame is between the last fixed update and the next
+    //  one, in [0, 1). Render state can blend the last two fixed states by it
+    float GetInterpolationAlpha() const;
     //  Determines if a service needs to stop running
     bool ShouldTerminate();
     bool isRunning_{ true };
+    float interpolationAlpha_{ 0.f };
+    //  services are free to run on any worker unless they say otherwise
+    ThreadAffinity threadAffinity_{ ThreadAffinity::Any };
   };
 }
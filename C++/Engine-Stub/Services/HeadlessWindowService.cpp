@@ -0,0 +1,109 @@
+// file:    HeadlessWindowService.cpp
+// author:  Tristan Baskerville
+// brief:   WindowService for TRISKERVILLE_HEADLESS builds. There is no window
+//          or GL context, only a fixed size, so the engine runs on machines
+//          without a display or GPU.
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#include <stdafx.h>
+#include <Services/WindowService.h>
+#include <Services/MessageService.h>
+#include <Core/MessageQueue.h>
+#include <Graphics/Common.h>
+
+#if defined(TRISKERVILLE_HEADLESS)
+
+namespace triskerville
+{
+  uint WindowService::windowCount_ = 0;
+
+  WindowService::WindowService(DependencyList&& _dependencies)
+    : DependencyList(std::forward<DependencyList>(_dependencies))
+    , size_{ Graphics::Common::INIT_WIDTH, Graphics::Common::INIT_HEIGHT }
+  {
+    //  same affinity as the real window, so services see the same ordering
+    threadAffinity_ = ThreadAffinity::MainThread;
+
+    //  nothing can close a window that doesn't exist, so benchmark and CI
+    //  runs set how many frames they want up front
+    if (char const* frames = std::getenv("TRISKERVILLE_HEADLESS_FRAMES"))
+      frameLimit_ = std::strtoull(frames, nullptr, 10);
+
+    incrementWindowCount();
+  }
+
+  WindowService::~WindowService()
+  {
+    decrementWindowCount();
+  }
+
+  WindowService::WindowService(WindowService&& _other) noexcept
+    : DependencyList(std::move(_other))
+  {
+    std::swap(this->size_, _other.size_);
+    std::swap(this->frameLimit_, _other.frameLimit_);
+    std::swap(this->framesRun_, _other.framesRun_);
+    std::swap(this->isClosing_, _other.isClosing_);
+    incrementWindowCount();
+  }
+
+  void WindowService::SetSize(glm::ivec2 const& _size)
+  {
+    size_ = _size;
+  }
+
+  glm::ivec2 WindowService::GetSize() const
+  {
+    return size_;
+  }
+
+  float WindowService::GetAspectRatio() const
+  {
+    return static_cast<float>(size_.x) / size_.y;
+  }
+
+  void WindowService::Close()
+  {
+    isClosing_ = true;
+  }
+
+  void WindowService::Bind() const
+  {
+  }
+
+  void WindowService::Unbind() const
+  {
+  }
+
+  void WindowService::FrameBegin(float)
+  {
+    //  a failed FrameBegin ends the loop before that frame runs, so the
+    //  limit is hit on the begin after the last frame
+    if (isClosing_ or (frameLimit_ != 0 and framesRun_++ == frameLimit_))
+    {
+      isRunning_ = false;
+      return;
+    }
+
+    //  no input arrives, but anything posted by other services still does
+    Dispatch_Messages();
+  }
+
+  GLFWwindow* WindowService::GetInternalPointer() const
+  {
+    return nullptr;
+  }
+
+  void WindowService::incrementWindowCount()
+  {
+    ++windowCount_;
+  }
+
+  void WindowService::decrementWindowCount()
+  {
+    --windowCount_;
+  }
+}
+
+#endif
@@ -0,0 +1,26 @@
+// file:    JobService.cpp
+// author:  Tristan Baskerville
+// brief:   
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#include <stdafx.h>
+#include <Services/JobService.h>
+
+namespace triskerville
+{
+  JobService::JobService(DependencyList&& _dependencies)
+    : DependencyList(std::forward<DependencyList>(_dependencies))
+    , pJobSystem_(std::make_unique<JobSystem>())
+  {
+  }
+
+  JobSystem& JobService::GetJobSystem()
+  {
+    return *pJobSystem_;
+  }
+
+  void JobService::FrameBegin(float)
+  {
+  }
+}
@@ -0,0 +1,32 @@
+// file:    JobService.h
+// author:  Tristan Baskerville
+// brief:   Hands the engine's JobSystem to any service that lists JobService
+//          as a dependency, so work can fan out across cores.
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#pragma once
+
+#include <triskerville_fwd.h>
+#include <Interfaces/IService.h>
+#include <Interfaces/IDependencyList.h>
+#include <Core/JobSystem.h>
+
+namespace triskerville
+{
+  class JobService :
+    public IService,
+    //  the job system is the bottom of the stack, it depends on nothing
+    public IDependencyList<>
+  {
+  public:
+    JobService(DependencyList&&);
+
+    JobSystem& GetJobSystem();
+  private:
+    //  workers run on their own, there is nothing to do per frame
+    void FrameBegin(float) override;
+
+    UPointer<JobSystem> pJobSystem_{ nullptr };
+  };
+}
@@ -8,35 +8,44 @@
 #include <Services/RenderingService.h>
 #include <Services/MessageService.h>
 #include <Services/WindowService.h>
-#include <Services/GUIService.h>
 
 #include <Core/EResult.h>
+#include <Core/Channel.h>
 #include <Core/InputEvent.h>
 
 #include <Graphics/Common.h>
 #include <Graphics/VertexArray.h>
 #include <Graphics/Buffer.h>
-#include <Graphics/Framebuffer.h>
 #include <Graphics/Texture/Texture2D.h>
 #include <Graphics/Shader.h>
 #include <Graphics/Mesh.h>
 #include <Graphics/ObjectData.h>
 #include <Graphics/Texture/Cubemap.h>
+#include <Graphics/InstanceBuffer.h>
 
 #include <Primitive/Quad.h>
 
-#include <World/Entity.h>
 #include <World/Camera.h>
 #include <World/LocalLight.h>
+#include <World/Registry.h>
+#include <World/Transform.h>
+#include <World/TransformSystem.h>
 
 namespace triskerville
 {
+  using Graphics::Platform::RenderState;
+  using Graphics::Platform::RenderTarget;
+
   static void onCameraUpdate(MessageService::Observer, Hash, void*);
 
   RenderingService::RenderingService(DependencyList&& _dependencies)
     : DependencyList(std::forward<DependencyList>(_dependencies))
   {
-    pRenderer_ = Graphics::Platform::CreateRenderer();
+    //  the GL context is only current on the main thread
+    threadAffinity_ = ThreadAffinity::MainThread;
+
+    pRenderer_ = std::make_unique<Renderer>();
+    pInstances_ = std::make_unique<Graphics::InstanceBuffer>();
 
     auto pWindowService = this->GetService<WindowService>();
 
@@ -47,27 +56,24 @@ namespace triskerville
         SetViewport(_size);
       });
 
-    quad3DShader_ = std::make_shared<Graphics::Shader>(
-      Graphics::Shader
-      {
-        "./Input/Shaders/points.vert",
-        "./Input/Shaders/points.frag"
-      }
-    );
-    gBufferShader_ = std::make_shared<Graphics::Shader>(
-      Graphics::Shader
-      {
-        "./Input/Shaders/gbuffer.vert",
-        "./Input/Shaders/gbuffer.frag"
-      }
-    );
+    quad3DShader_ = pRenderer_->CreateShader(
+      "./Input/Shaders/points.vert", "./Input/Shaders/points.frag");
+    gBufferShader_ = pRenderer_->CreateShader(
+      "./Input/Shaders/gbuffer.vert", "./Input/Shaders/gbuffer.frag");
 
+    Channel<CameraUpdate>::Subscribe<&RenderingService::HandleCameraUpdate>(this);
+    //  senders still using Hash("CameraUpdate") are forwarded to the channel
     auto pMessageService = GetService<MessageService>();
     pMessageService->Register(this, Hash("CameraUpdate"), onCameraUpdate);
 
-    glEnable(GL_CULL_FACE);
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LEQUAL);
+    pRenderer_->SetState(RenderState::CullFront, false);
+    pRenderer_->SetState(RenderState::DepthTest, true);
+  }
+
+  RenderingService::~RenderingService()
+  {
+    //  the channel holds a raw pointer to us, it can't outlive this
+    Channel<CameraUpdate>::Unsubscribe<&RenderingService::HandleCameraUpdate>(this);
   }
 
   void RenderingService::OnCameraUpdate(World::Camera const& _camera)
@@ -85,94 +91,47 @@ namespace triskerville
 
   void RenderingService::FrameBegin(float)
   {
-    //  just make sure this gets emptied every frame
-    for (auto& [name, pFramebuffer] : framebufferMap_)
-      pFramebuffer->Clear();
+    pRenderer_->BeginFrame();
   }
 
   void RenderingService::FrameEnd()
   {
-    auto fboDeferred = framebufferMap_.at("gbuffer");
     //  deferred rendering pass for world entities
-    fboDeferred->Bind();
-    while (!renderList_.empty())
-    {
-      RenderEntity(renderList_.front());
-      renderList_.pop_front();
-    }
-    fboDeferred->Unbind();
-
-    auto& textures = fboDeferred->GetTextures();
-    auto fboScene = framebufferMap_.at("scene");
-    fboScene->Bind();
-    RenderFSQ(textures);
-    fboScene->CopyDepth(fboDeferred);
-    RenderLocalLights(textures);
-    RenderSkybox();
-    fboScene->Unbind();
+    pRenderer_->BindTarget(RenderTarget::GBuffer);
+    RenderEntities();
 
-    //  TODO (Tristan): Move GUI stuff outside
-    {
-      auto gbuffer = Editor::Window::Builder{ "G-Buffer" }
-        .WithFlag(Editor::WindowFlags::NoScroll)
-        .Build();
-
-      if (gbuffer.Bind())
-      {
-        for (auto& texture : textures)
-        {
-          gbuffer.Image(texture);
-        }
-      }
-      gbuffer.Unbind();
-
-      auto sceneWindow = Editor::Window::Builder{ "Scene" }
-        .WithFlag(Editor::WindowFlags::AutoResize)
-        .WithFlag(Editor::WindowFlags::NoScroll)
-        .Build();
-
-      if (sceneWindow.Bind())
-      {
-        using namespace Editor;
-        sceneWindow.Image(fboScene->GetTextures()[0]);
-
-        sceneWinCache_ = { ImGui::GetItemRectMin(), ImGui::GetItemRectSize() };
-        isMouseHoveringScene_ = ImGui::IsItemHovered() ? TRUE : FALSE;
-      }
-      sceneWindow.Unbind();
-    }
-  }
+    pRenderer_->BindTarget(RenderTarget::Scene);
+    RenderFSQ();
+    pRenderer_->CopyDepth(RenderTarget::GBuffer);
+    RenderLocalLights();
+    RenderSkybox();
+    pRenderer_->BindShader(nullptr);
+    pRenderer_->BindTarget(RenderTarget::Screen);
 
-  //  we are going to store the pointer and render this later
-  void RenderingService::PushEntity(SPointer<const World::Entity> _pEntity)
-  {
-    renderList_.push_back(_pEntity);
+    RenderEditorWindows();
   }
 
-  void RenderingService::PushSkybox(
-    SPointer<const World::Entity> _pEntity,
-    SPointer<const Graphics::Cubemap> _pCubemap)
+  void RenderingService::SetRegistry(World::Registry const* _pRegistry)
   {
-    skybox_ = std::make_pair(_pEntity, _pCubemap);
+    pRegistry_ = _pRegistry;
   }
 
-  void RenderingService::PushLocalLight(
-    SPointer<const World::Entity> _pEntity, 
-    SPointer<const World::LocalLight> _pLocalLight)
+  void RenderingService::SetTransformSystem(
+    World::TransformSystem const* _pTransforms)
   {
-    localLights_.push_back(std::make_pair(_pEntity, _pLocalLight));
+    pTransforms_ = _pTransforms;
   }
 
   void RenderingService::RenderQuads(
     std::vector<Primitive::Quad3D> const& _quads)
   {
-    framebufferMap_.at("gbuffer")->Bind();
-    quad3DShader_->Bind();
+    pRenderer_->BindTarget(RenderTarget::GBuffer);
+    pRenderer_->BindShader(quad3DShader_);
 
     pRenderer_->RenderToWorld(_quads);
 
-    quad3DShader_->Unbind();
-    framebufferMap_.at("gbuffer")->Unbind();
+    pRenderer_->BindShader(nullptr);
+    pRenderer_->BindTarget(RenderTarget::Screen);
   }
 
   SceneWindow RenderingService::GetSceneWindowCache() const
@@ -190,103 +149,169 @@ namespace triskerville
     return cameraMatrices_;
   }
 
-  void RenderingService::RenderEntity(SPointer<const World::Entity> _pEntity)
+  auto RenderingService::GetRenderer() const -> Renderer const&
   {
-    _pEntity->pShader_->Bind();
-    _pEntity->pShader_->SetUniform(_pEntity->transform_.GetMatrix(), "model");
-
-    pRenderer_->RenderToWorld(_pEntity->pMesh_);
-
-    _pEntity->pShader_->Unbind();
+    return *pRenderer_;
   }
 
-  void RenderingService::RenderLocalLights(
-    std::vector<Graphics::Texture2D> const& _textures)
+  void RenderingService::RenderEntities()
   {
-    glDisable(GL_DEPTH_TEST);
-    glBlendFunc(GL_ONE, GL_ONE);
-    glCullFace(GL_FRONT);
-    glEnable(GL_BLEND);
-    while (!localLights_.empty())
+    if (not pRegistry_) return;
+
+    using Graphics::RenderQueue;
+    renderQueue_.Clear();
+    shaderIds_.Clear();
+    meshIds_.Clear();
+
+    //  lights and the skybox share these components but get their own pass
+    pRegistry_->Each<World::Transform, World::MeshComponent,
+                     World::ShaderComponent>(
+      World::Exclude<World::LocalLight, World::SkyboxComponent>{},
+      [this](World::EntityId, World::Transform const& _transform,
+             World::MeshComponent const& _mesh,
+             World::ShaderComponent const& _shader)
+      {
+        //  there are no materials yet, everything shares material 0
+        auto key = RenderQueue::MakeKey(shaderIds_.Intern(_shader.pShader),
+                                        meshIds_.Intern(_mesh.pMesh), 0);
+        renderQueue_.Push(key, _transform.GetMatrix());
+      });
+    //  same pass for hierarchy transforms, their matrices are already built
+    if (pTransforms_)
     {
-      SPointer<const World::Entity> pEntity;
-      SPointer<const World::LocalLight> pLocalLight;
-      std::tie(pEntity, pLocalLight) = localLights_.front();
-
-      auto shader = pEntity->pShader_;
-      //  bind all textures aside from the depth texture
-      for (uint i = 0; i < _textures.size() - 1; ++i)
-        shader->SetUniform(i, _textures[i]);
-
-      shader->SetUniform(viewportSize_, "viewport");
-      shader->SetUniform(pLocalLight->color, "color");
-      shader->SetUniform(pEntity->transform_.GetTranslation(), "lightPosition");
-      shader->SetUniform(pEntity->transform_.GetScale().x/2.f, "lightRadius");
-      shader->SetUniform(pLocalLight->brightness, "lightBrightness");
-      RenderEntity(pEntity);
-      localLights_.pop_front();
+      pRegistry_->Each<World::TransformId, World::MeshComponent,
+                       World::ShaderComponent>(
+        World::Exclude<World::LocalLight, World::SkyboxComponent>{},
+        [this](World::EntityId, World::TransformId const& _transform,
+               World::MeshComponent const& _mesh,
+               World::ShaderComponent const& _shader)
+        {
+          auto key = RenderQueue::MakeKey(shaderIds_.Intern(_shader.pShader),
+                                          meshIds_.Intern(_mesh.pMesh), 0);
+          renderQueue_.Push(key, pTransforms_->GetWorldMatrix(_transform));
+        });
+    }
+    renderQueue_.Build();
+
+    auto const& batches = renderQueue_.GetBatches();
+    pInstances_->BeginFrame();
+    pInstances_->Reserve(renderQueue_.GetInstanceCount(),
+                         static_cast<uint>(batches.size()));
+
+    //  one bind per shader, one draw per run of the same mesh
+    for (auto const& batch : batches)
+    {
+      if (batch.changes & RenderQueue::ShaderChange)
+      {
+        pRenderer_->BindShader(
+          shaderIds_.Get(RenderQueue::GetShader(batch.key)));
+      }
+
+      size_t offset = pInstances_->Write(
+        renderQueue_.GetInstances() + batch.firstInstance, batch.instanceCount);
+      pInstances_->BindRange(offset, batch.instanceCount);
+      pRenderer_->RenderToWorld(meshIds_.Get(RenderQueue::GetMesh(batch.key)),
+                                batch.instanceCount);
     }
-    glCullFace(GL_BACK);
-    glDisable(GL_BLEND);
-    glEnable(GL_DEPTH_TEST);
+    pInstances_->EndFrame();
+  }
+
+  void RenderingService::RenderEntity(World::Transform const& _transform,
+                                      World::MeshComponent const& _mesh,
+                                      World::ShaderComponent const& _shader)
+  {
+    //  uniforms belong to the program, a shader drawing the same unchanged
+    //  transform again still has the right matrix
+    auto& upload = modelUploads_[_shader.pShader.get()];
+    bool isSameShader = not upload.pShader.owner_before(_shader.pShader) and
+                        not _shader.pShader.owner_before(upload.pShader);
+    bool isUploaded = isSameShader and
+                      upload.version == _transform.GetVersion();
+    if (not isUploaded)
+      upload = { _shader.pShader, _transform.GetVersion() };
+
+    pRenderer_->BindShader(_shader.pShader);
+    if (not isUploaded)
+      pRenderer_->SetUniform(_transform.GetMatrix(), "model");
+
+    pRenderer_->RenderToWorld(_mesh.pMesh);
+  }
+
+  void RenderingService::RenderLocalLights()
+  {
+    if (not pRegistry_) return;
+
+    pRenderer_->SetState(RenderState::DepthTest, false);
+    pRenderer_->SetState(RenderState::CullFront, true);
+    pRenderer_->SetState(RenderState::Blend, true);
+    pRegistry_->Each<World::Transform, World::MeshComponent,
+                     World::ShaderComponent, World::LocalLight>(
+      [&](World::EntityId, World::Transform const& _transform,
+          World::MeshComponent const& _mesh,
+          World::ShaderComponent const& _shader,
+          World::LocalLight const& _localLight)
+      {
+        pRenderer_->BindShader(_shader.pShader);
+        pRenderer_->SetTextures(RenderTarget::GBuffer);
+
+        pRenderer_->SetUniform(viewportSize_, "viewport");
+        pRenderer_->SetUniform(_localLight.color, "color");
+        pRenderer_->SetUniform(_transform.GetTranslation(), "lightPosition");
+        pRenderer_->SetUniform(_transform.GetScale().x/2.f, "lightRadius");
+        pRenderer_->SetUniform(_localLight.brightness, "lightBrightness");
+        RenderEntity(_transform, _mesh, _shader);
+      });
+    pRenderer_->SetState(RenderState::CullFront, false);
+    pRenderer_->SetState(RenderState::Blend, false);
+    pRenderer_->SetState(RenderState::DepthTest, true);
   }
 
   void RenderingService::RenderSkybox()
   {
-    glDepthMask(GL_FALSE);
-    auto entity = skybox_.first;
-    auto cubemap = skybox_.second;
-    cubemap->Bind();
-    RenderEntity(entity);
-    glDepthMask(GL_TRUE);
+    if (not pRegistry_) return;
+
+    bool isDrawn = false;
+    pRegistry_->Each<World::Transform, World::MeshComponent,
+                     World::ShaderComponent, World::SkyboxComponent>(
+      [&](World::EntityId, World::Transform const& _transform,
+          World::MeshComponent const& _mesh,
+          World::ShaderComponent const& _shader,
+          World::SkyboxComponent const& _skybox)
+      {
+        if (std::exchange(isDrawn, true)) return;
+
+        pRenderer_->SetState(RenderState::DepthWrite, false);
+        pRenderer_->BindCubemap(*_skybox.pCubemap);
+        RenderEntity(_transform, _mesh, _shader);
+        pRenderer_->SetState(RenderState::DepthWrite, true);
+      });
   }
 
-  void RenderingService::RenderFSQ(
-    std::vector<Graphics::Texture2D> const& _textures)
+  void RenderingService::RenderFSQ()
   {
-    gBufferShader_->Bind();
-    for (uint i = 0; i < _textures.size() - 1; ++i)
-      gBufferShader_->SetUniform(i, _textures[i]);
+    pRenderer_->BindShader(gBufferShader_);
+    pRenderer_->SetTextures(RenderTarget::GBuffer);
 
     //  crate a quad in NDC space that maps to all four corners
     auto viewport = Primitive::MakeQuad2D(glm::vec2(0.f), glm::vec2(2.f));
     pRenderer_->RenderToScreen(viewport);
-
-    gBufferShader_->Unbind();
   }
 
-  void RenderingService::ReallocateFramebuffers()
+  void RenderingService::HandleCameraUpdate(CameraUpdate const& _message)
   {
-    //  all framebuffers need to be reallocated, so we'll just clear the map
-    framebufferMap_.clear();
-    framebufferMap_.emplace("gbuffer", std::make_shared<Graphics::Framebuffer>(
-      Graphics::Framebuffer::Builder{ viewportSize_ }
-        .WithColorBuffer(Graphics::Common::Layout::RGBA_Float, "gPosition")
-        .WithColorBuffer(Graphics::Common::Layout::RGBA_Float, "gNormal")
-        .WithColorBuffer(Graphics::Common::Layout::RGBA_Float, "gAlbedoSpec")
-        .Build())
-    );
-
-    framebufferMap_.emplace("scene", std::make_shared<Graphics::Framebuffer>(
-      Graphics::Framebuffer::Builder{ viewportSize_ }
-        .WithColorBuffer(Graphics::Common::Layout::RGBA_Float, "gScene")
-        .Build())
-    );
+    OnCameraUpdate(_message.Camera);
   }
 
   void RenderingService::SetViewport(glm::ivec2 const& _size)
   {
     viewportSize_ = _size;
     pRenderer_->SetViewport(_size.x, _size.y);
-    //  OpenGL is a lil busted, so for now, just reallocate the FBO
-    ReallocateFramebuffers();
   }
 
   void onCameraUpdate(
     MessageService::Observer _observer, Hash _hash, void* _payload)
   {
-    RenderingService* pRenderingService = (RenderingService*)_observer;
     World::Camera* pCamera = (World::Camera*)_payload;
-    pRenderingService->OnCameraUpdate(*pCamera);
+    Channel<CameraUpdate>::Publish({ *pCamera });
   }
 }
@@ -9,7 +9,9 @@
 #include <triskerville_fwd.h>
 #include <Interfaces/IService.h>
 #include <Interfaces/IDependencyList.h>
-#include <Graphics/Platform/Renderer.h>
+#include <World/Components.h>
+#include <Graphics/RenderQueue.h>
+#include <Graphics/Platform/RenderBackend.h>
 
 namespace triskerville
 {
@@ -19,11 +21,26 @@ namespace triskerville
     glm::vec2 Size{ 0.f };
   };
 
+  //  published on Channel<CameraUpdate> whenever the active camera moves
+  struct CameraUpdate
+  {
+    World::Camera const& Camera;
+  };
+
+  //  headless builds have no window for the editor to draw into, so they
+  //  don't install a GUIService at all
+#if defined(TRISKERVILLE_HEADLESS)
+  using RenderingDependencies = IDependencyList<MessageService, WindowService>;
+#else
+  using RenderingDependencies =
+    IDependencyList<MessageService, WindowService, GUIService>;
+#endif
+
   class RenderingService :
     public IService,
     //  Attempting to construct a RenderingService instance before any of its
     //  dependencies emits a compiler error.
-    public IDependencyList<MessageService, WindowService, GUIService>
+    public RenderingDependencies
   {
   public:
     //  The GPU needs this struct to be 16-byte aligned or it gets read incorrectly
@@ -34,15 +51,28 @@ namespace triskerville
       glm::vec2 nearFarPlanes;
     };
 
+    //  NullRenderer in headless builds, GLRenderer otherwise
+    using Renderer = Graphics::Platform::RenderBackend;
+
     RenderingService(DependencyList&&);
+    ~RenderingService();
 
     void OnCameraUpdate(World::Camera const&);
 
-    void PushEntity(SPointer<const World::Entity>);
-    void PushSkybox(SPointer<const World::Entity>, 
-                    SPointer<const Graphics::Cubemap>);
-    void PushLocalLight(SPointer<const World::Entity>, 
-                        SPointer<const World::LocalLight>);
+    /// Scene drawn every frame. Entities with a Transform, MeshComponent and
+    /// ShaderComponent are drawn, adding a LocalLight or SkyboxComponent
+    /// moves them to that pass instead.
+    ///
+    /// \param _pRegistry  Must outlive this, or be replaced first. nullptr
+    ///                    draws nothing.
+    void SetRegistry(World::Registry const* _pRegistry);
+    /// Entities may carry a TransformId into this in place of a Transform,
+    /// they're drawn with its world matrix. Whoever moves them calls Update
+    /// before the frame ends.
+    ///
+    /// \param _pTransforms  Same lifetime rules as the registry. nullptr
+    ///                      skips those entities.
+    void SetTransformSystem(World::TransformSystem const* _pTransforms);
 
     void RenderQuads(std::vector<Primitive::Quad3D> const&);
 
@@ -50,35 +80,54 @@ namespace triskerville
     bool IsMouseHoveringScene() const;
     CameraMatrices const& GetCameraMatrices() const;
 
+    //  headless builds read back the frame's commands through this
+    Renderer const& GetRenderer() const;
+
   private:
-    void RenderEntity(SPointer<const World::Entity>);
-    void RenderLocalLights(std::vector<Graphics::Texture2D> const&);
+    void RenderEntities();
+    void RenderEntity(World::Transform const&, World::MeshComponent const&,
+                      World::ShaderComponent const&);
+    void RenderLocalLights();
     void RenderSkybox();
-    void RenderFSQ(std::vector<Graphics::Texture2D> const&);
+    void RenderFSQ();
+    //  g-buffer and scene views, does nothing in headless builds
+    void RenderEditorWindows();
+
+    void HandleCameraUpdate(CameraUpdate const&);
 
     //  helper methods for common functionality
-    void ReallocateFramebuffers();
     void SetViewport(glm::ivec2 const&);
 
     //  Application manages these calls, no public access
     void FrameBegin(float) override;
     void FrameEnd() override;
 
-    UPointer<Graphics::Platform::Renderer> pRenderer_{ nullptr };
-    std::unordered_map<
-      std::string, SPointer<Graphics::Framebuffer>> framebufferMap_{ };
+    UPointer<Renderer> pRenderer_{ nullptr };
 
     glm::ivec2 viewportSize_{};
 
     SPointer<Graphics::Shader> quad3DShader_{ nullptr };
     SPointer<Graphics::Shader> gBufferShader_{ nullptr };
 
-    //  TODO: clean this
-    std::pair<SPointer<const World::Entity>,
-      SPointer<const Graphics::Cubemap>> skybox_{ nullptr, nullptr };
-    std::list<std::pair<SPointer<const World::Entity>,
-      SPointer<const World::LocalLight>>> localLights_{};
-    std::list<SPointer<const World::Entity>> renderList_;
+    World::Registry const* pRegistry_{ nullptr };
+    World::TransformSystem const* pTransforms_{ nullptr };
+
+    //  the g-buffer pass is sorted and drawn instanced, the per-frame tables
+    //  turn resources into ids small enough for a sort key
+    Graphics::RenderQueue renderQueue_{};
+    Graphics::ResourceTable<Graphics::Shader> shaderIds_{};
+    Graphics::ResourceTable<Graphics::Mesh> meshIds_{};
+    UPointer<Graphics::InstanceBuffer> pInstances_{ nullptr };
+
+    //  the transform version each shader's model uniform was last set from.
+    //  the weak pointer tells a new shader apart from a dead one at the
+    //  same address
+    struct ModelUpload
+    {
+      std::weak_ptr<Graphics::Shader> pShader{};
+      std::uint64_t version{ 0 };
+    };
+    std::unordered_map<Graphics::Shader const*, ModelUpload> modelUploads_{};
     
     bool isMouseHoveringScene_{ false };
     SceneWindow sceneWinCache_;
@@ -0,0 +1,67 @@
+// file:    RenderingServiceEditor.cpp
+// author:  Tristan Baskerville
+// brief:   Editor windows RenderingService shows its render targets in. Kept
+//          apart so TRISKERVILLE_HEADLESS builds compile without the editor,
+//          there is no GUIService or window to draw into there.
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#include <stdafx.h>
+#include <Services/RenderingService.h>
+
+#if defined(TRISKERVILLE_HEADLESS)
+
+namespace triskerville
+{
+  void RenderingService::RenderEditorWindows()
+  {
+  }
+}
+
+#else
+
+#include <Services/GUIService.h>
+#include <Graphics/Texture/Texture2D.h>
+
+namespace triskerville
+{
+  using Graphics::Platform::RenderTarget;
+
+  void RenderingService::RenderEditorWindows()
+  {
+    //  a renderer without targets has nothing for the editor to show
+    auto const& textures = pRenderer_->GetTargetTextures(RenderTarget::GBuffer);
+    if (textures.empty()) return;
+
+    auto gbuffer = Editor::Window::Builder{ "G-Buffer" }
+      .WithFlag(Editor::WindowFlags::NoScroll)
+      .Build();
+
+    if (gbuffer.Bind())
+    {
+      for (auto& texture : textures)
+      {
+        gbuffer.Image(texture);
+      }
+    }
+    gbuffer.Unbind();
+
+    auto sceneWindow = Editor::Window::Builder{ "Scene" }
+      .WithFlag(Editor::WindowFlags::AutoResize)
+      .WithFlag(Editor::WindowFlags::NoScroll)
+      .Build();
+
+    auto const& scene = pRenderer_->GetTargetTextures(RenderTarget::Scene);
+    if (sceneWindow.Bind() and not scene.empty())
+    {
+      using namespace Editor;
+      sceneWindow.Image(scene[0]);
+
+      sceneWinCache_ = { ImGui::GetItemRectMin(), ImGui::GetItemRectSize() };
+      isMouseHoveringScene_ = ImGui::IsItemHovered() ? TRUE : FALSE;
+    }
+    sceneWindow.Unbind();
+  }
+}
+
+#endif
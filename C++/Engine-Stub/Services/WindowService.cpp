@@ -10,8 +10,12 @@
 #include <Services/SceneLogic.h>
 #include <Core/EResult.h>
 #include <Core/InputEvent.h>
+#include <Core/MessageQueue.h>
 #include <Graphics/Common.h>
 
+//  headless builds get their WindowService from HeadlessWindowService.cpp
+#if !defined(TRISKERVILLE_HEADLESS)
+
 namespace triskerville
 {
   //  used to help keep track of GLFW/Glad initialization
@@ -21,6 +25,9 @@ namespace triskerville
     : DependencyList(std::forward<DependencyList>(_dependencies))
     , size_{ Graphics::Common::INIT_WIDTH, Graphics::Common::INIT_HEIGHT }
   {
+    //  GLFW must be polled on the thread that created the window
+    threadAffinity_ = ThreadAffinity::MainThread;
+
     incrementWindowCount();
     //  creates a core OpenGL context with version 4.6
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
@@ -50,10 +57,10 @@ namespace triskerville
       {
         ButtonEvent info = { key, mod };
         switch (action) {
-          case GLFW_PRESS: { Send_Message(Hash("ButtonPress"), MessageService::AllObservers, &info); }
+          case GLFW_PRESS: { Post_Message(Hash("ButtonPress"), MessageService::AllObservers, info); }
           break;
 
-          case GLFW_RELEASE: { Send_Message(Hash("ButtonRelease"), MessageService::AllObservers, &info); }
+          case GLFW_RELEASE: { Post_Message(Hash("ButtonRelease"), MessageService::AllObservers, info); }
           break;
 
           default: {}
@@ -66,10 +73,10 @@ namespace triskerville
       {
           ButtonEvent info = { button, mod };
           switch (action) {
-              case GLFW_PRESS: { Send_Message(Hash("ButtonPress"), MessageService::AllObservers, &info); }
+              case GLFW_PRESS: { Post_Message(Hash("ButtonPress"), MessageService::AllObservers, info); }
               break;
 
-              case GLFW_RELEASE: { Send_Message(Hash("ButtonRelease"), MessageService::AllObservers, &info); }
+              case GLFW_RELEASE: { Post_Message(Hash("ButtonRelease"), MessageService::AllObservers, info); }
               break;
 
               default: {}
@@ -80,14 +87,18 @@ namespace triskerville
     glfwSetCursorEnterCallback(pWindow_, 
       [](GLFWwindow* window, int is_hovering_window) 
       {
-          Send_Message(Hash("MouseEnterWindow"), MessageService::AllObservers, is_hovering_window ? &is_hovering_window : nullptr); // NOTE: Payload acts as bool =]
+          // NOTE: Payload acts as bool =]
+          if (is_hovering_window)
+            Post_Message(Hash("MouseEnterWindow"), MessageService::AllObservers, is_hovering_window);
+          else
+            Post_Message(Hash("MouseEnterWindow"), MessageService::AllObservers);
       }
     );
     glfwSetScrollCallback(pWindow_, 
       [](GLFWwindow* window, double d_x, double d_y) 
       {
           ScrollEvent info = { d_x, d_y };
-          Send_Message(Hash("Scroll"), MessageService::AllObservers, &info);
+          Post_Message(Hash("Scroll"), MessageService::AllObservers, info);
       }
     );
 
@@ -136,6 +147,11 @@ namespace triskerville
     return static_cast<float>(size_.x) / size_.y;
   }
 
+  void WindowService::Close()
+  {
+    glfwSetWindowShouldClose(pWindow_, GLFW_TRUE);
+  }
+
   void WindowService::Bind() const
   {
     glfwMakeContextCurrent(pWindow_);
@@ -164,8 +180,12 @@ namespace triskerville
     cursor_ = info.Pos;
     if (glm::abs(info.Delta.x) >= DBL_EPSILON || glm::abs(info.Delta.y) >= DBL_EPSILON) 
     {
-      Send_Message(Hash("MouseMove"), MessageService::AllObservers, &info);
+      Post_Message(Hash("MouseMove"), MessageService::AllObservers, info);
     }
+
+    //  input callbacks only queue their events while glfw polls, this is
+    //  where the frame's messages actually reach their observers
+    Dispatch_Messages();
   }
 
   GLFWwindow* WindowService::GetInternalPointer() const
@@ -193,3 +213,5 @@ namespace triskerville
     }
   }
 }
+
+#endif
@@ -29,6 +29,9 @@ namespace triskerville
     glm::ivec2 GetSize() const;
     float GetAspectRatio() const;
 
+    //  asks the window to close, the engine stops at the next FrameBegin
+    void Close();
+
     //  exposing another internal so the GUI can hook glfw calls.
     //  not ideal, but no other options here
     GLFWwindow* GetInternalPointer() const;
@@ -46,5 +49,12 @@ namespace triskerville
     GLFWwindow* pWindow_{ nullptr };
     glm::ivec2 size_{};
     glm::dvec2 cursor_{};
+
+#if defined(TRISKERVILLE_HEADLESS)
+    //  frames to run before the headless window closes itself, 0 runs forever
+    std::uint64_t frameLimit_{ 0 };
+    std::uint64_t framesRun_{ 0 };
+    bool isClosing_{ false };
+#endif
   };
 }
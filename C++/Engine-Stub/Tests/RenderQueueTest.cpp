@@ -0,0 +1,188 @@
+// file:    RenderQueueTest.cpp
+// author:  Tristan Baskerville
+// brief:   Tests for Graphics::RenderQueue. Covers how keys order, how runs
+//          of one key are split into batches, and which change flags each
+//          batch reports. RenderQueue never touches the GPU, so this runs
+//          without a window or context.
+//
+//          Every check is an assert, so build with asserts on, using the
+//          engine's include paths.
+//            g++ -std=c++17 -I. Tests/RenderQueueTest.cpp
+//              Graphics/RenderQueue.cpp -o renderqueuetest
+//            ./renderqueuetest
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#undef NDEBUG
+#include <stdafx.h>
+#include <Graphics/RenderQueue.h>
+
+namespace
+{
+  using triskerville::Graphics::RenderQueue;
+
+  //  every flag, what the first batch of a frame reports
+  constexpr byte AllChanges = RenderQueue::ShaderChange |
+                              RenderQueue::MeshChange |
+                              RenderQueue::MaterialChange;
+
+  //  instance transforms carry the order they were pushed in, so the
+  //  sorted instances can be traced back to their push
+  glm::mat4 makeInstance(uint _pushed)
+  {
+    glm::mat4 instance(1.f);
+    instance[3][0] = static_cast<float>(_pushed);
+    return instance;
+  }
+
+  uint getPushed(glm::mat4 const& _instance)
+  {
+    return static_cast<uint>(_instance[3][0]);
+  }
+
+  void testKeyFields()
+  {
+    uint maxShader = (1u << RenderQueue::ShaderBits) - 1;
+    uint maxMesh = (1u << RenderQueue::MeshBits) - 1;
+    uint maxMaterial = (1u << RenderQueue::MaterialBits) - 1;
+
+    auto key = RenderQueue::MakeKey(maxShader, maxMesh, maxMaterial);
+    assert(key == ~std::uint64_t{ 0 });
+    assert(RenderQueue::GetShader(key) == maxShader);
+    assert(RenderQueue::GetMesh(key) == maxMesh);
+    assert(RenderQueue::GetMaterial(key) == maxMaterial);
+
+    //  fields don't leak into their neighbours
+    key = RenderQueue::MakeKey(3, 0, 5);
+    assert(RenderQueue::GetShader(key) == 3);
+    assert(RenderQueue::GetMesh(key) == 0);
+    assert(RenderQueue::GetMaterial(key) == 5);
+
+    std::cout << "key fields: passed" << std::endl;
+  }
+
+  void testKeyOrdering()
+  {
+    uint maxMesh = (1u << RenderQueue::MeshBits) - 1;
+    uint maxMaterial = (1u << RenderQueue::MaterialBits) - 1;
+
+    //  shader outranks mesh, mesh outranks material
+    assert(RenderQueue::MakeKey(1, 0, 0) >
+           RenderQueue::MakeKey(0, maxMesh, maxMaterial));
+    assert(RenderQueue::MakeKey(0, 1, 0) >
+           RenderQueue::MakeKey(0, 0, maxMaterial));
+
+    //  pushed out of order, with duplicates spread apart
+    RenderQueue queue;
+    std::uint64_t const keys[] =
+    {
+      RenderQueue::MakeKey(2, 0, 0), RenderQueue::MakeKey(0, 1, 0),
+      RenderQueue::MakeKey(1, 0, 0), RenderQueue::MakeKey(0, 1, 0),
+      RenderQueue::MakeKey(0, 0, 7), RenderQueue::MakeKey(2, 0, 0),
+      RenderQueue::MakeKey(0, 1, 0)
+    };
+    uint const count = static_cast<uint>(std::size(keys));
+    for (uint i = 0; i < count; ++i)
+      queue.Push(keys[i], makeInstance(i));
+    queue.Build();
+
+    auto const& batches = queue.GetBatches();
+    assert(batches.size() == 4);
+    assert(queue.GetInstanceCount() == count);
+    for (uint i = 1; i < batches.size(); ++i)
+      assert(batches[i - 1].key < batches[i].key);
+
+    //  batches tile the instances, equal keys stay in push order
+    uint next = 0;
+    for (auto const& batch : batches)
+    {
+      assert(batch.firstInstance == next);
+      next += batch.instanceCount;
+
+      uint previous = 0;
+      for (uint i = 0; i < batch.instanceCount; ++i)
+      {
+        uint pushed = getPushed(queue.GetInstances()[batch.firstInstance + i]);
+        assert(keys[pushed] == batch.key);
+        assert(i == 0 or pushed > previous);
+        previous = pushed;
+      }
+    }
+    assert(next == count);
+
+    assert(batches[1].key == RenderQueue::MakeKey(0, 1, 0));
+    assert(batches[1].instanceCount == 3);
+
+    std::cout << "key ordering: passed" << std::endl;
+  }
+
+  void testBatchSplitting()
+  {
+    RenderQueue queue;
+    auto key = RenderQueue::MakeKey(1, 1, 1);
+    for (uint i = 0; i < 10; ++i)
+      queue.Push(key, makeInstance(i));
+
+    queue.Build(4);
+    auto const& batches = queue.GetBatches();
+    assert(batches.size() == 3);
+
+    uint const counts[] = { 4, 4, 2 };
+    for (uint i = 0; i < batches.size(); ++i)
+    {
+      assert(batches[i].key == key);
+      assert(batches[i].firstInstance == i * 4);
+      assert(batches[i].instanceCount == counts[i]);
+      //  a split keeps everything bound, nothing to change
+      assert(batches[i].changes == (i == 0 ? AllChanges : 0));
+    }
+
+    //  without a limit the whole run is one batch
+    queue.Build();
+    assert(batches.size() == 1);
+    assert(batches[0].instanceCount == 10);
+
+    std::cout << "batch splitting: passed" << std::endl;
+  }
+
+  void testChangeFlags()
+  {
+    RenderQueue queue;
+    queue.Push(RenderQueue::MakeKey(1, 1, 1), makeInstance(0));
+    queue.Push(RenderQueue::MakeKey(0, 1, 1), makeInstance(1));
+    queue.Push(RenderQueue::MakeKey(0, 0, 1), makeInstance(2));
+    queue.Push(RenderQueue::MakeKey(0, 0, 0), makeInstance(3));
+    queue.Push(RenderQueue::MakeKey(1, 0, 0), makeInstance(4));
+    queue.Build();
+
+    //  sorted: (0,0,0) (0,0,1) (0,1,1) (1,0,0) (1,1,1)
+    auto const& batches = queue.GetBatches();
+    assert(batches.size() == 5);
+    assert(batches[0].changes == AllChanges);
+    assert(batches[1].changes == RenderQueue::MaterialChange);
+    assert(batches[2].changes == RenderQueue::MeshChange);
+    assert(batches[3].changes == AllChanges);
+    assert(batches[4].changes ==
+           (RenderQueue::MeshChange | RenderQueue::MaterialChange));
+
+    //  a cleared queue starts over, its first batch changes everything
+    queue.Clear();
+    assert(queue.GetBatches().empty());
+    queue.Push(RenderQueue::MakeKey(1, 1, 1), makeInstance(0));
+    queue.Build();
+    assert(queue.GetBatches().size() == 1);
+    assert(queue.GetBatches()[0].changes == AllChanges);
+    assert(queue.GetInstanceCount() == 1);
+
+    std::cout << "change flags: passed" << std::endl;
+  }
+}
+
+int main()
+{
+  testKeyFields();
+  testKeyOrdering();
+  testBatchSplitting();
+  testChangeFlags();
+  std::cout << "all RenderQueue tests passed" << std::endl;
+}
@@ -0,0 +1,30 @@
+// file:    Components.h
+// author:  Tristan Baskerville
+// brief:   Plain data components the engine's own systems understand.
+//          World::Transform and World::LocalLight are components as they are.
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#pragma once
+
+#include <triskerville_fwd.h>
+
+namespace triskerville::World
+{
+  //  meshes and shaders are shared resources, entities only point at them
+  struct MeshComponent
+  {
+    SPointer<Graphics::Mesh> pMesh{ nullptr };
+  };
+
+  struct ShaderComponent
+  {
+    SPointer<Graphics::Shader> pShader{ nullptr };
+  };
+
+  //  drawn last, behind everything else. only the first one found is drawn
+  struct SkyboxComponent
+  {
+    SPointer<const Graphics::Cubemap> pCubemap{ nullptr };
+  };
+}
@@ -0,0 +1,64 @@
+// file:    Registry.cpp
+// author:  Tristan Baskerville
+// brief:   
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#include <stdafx.h>
+#include <World/Registry.h>
+
+namespace triskerville::World
+{
+  bool ISparseSet::Contains(uint _index) const
+  {
+    return _index < sparse_.size() and sparse_[_index] != Absent;
+  }
+
+  uint ISparseSet::GetSize() const
+  {
+    return static_cast<uint>(dense_.size());
+  }
+
+  uint const* ISparseSet::GetEntities() const
+  {
+    return dense_.data();
+  }
+
+  EntityId Registry::Create()
+  {
+    ++entityCount_;
+    if (not freeIndices_.empty())
+    {
+      uint index = freeIndices_.back();
+      freeIndices_.pop_back();
+      return { index, generations_[index] };
+    }
+
+    generations_.push_back(0);
+    return { static_cast<uint>(generations_.size() - 1), 0 };
+  }
+
+  void Registry::Destroy(EntityId _entity)
+  {
+    if (not IsAlive(_entity)) return;
+
+    for (auto& [type, pSet] : sets_)
+      pSet->Remove(_entity.index);
+
+    //  bumping the generation is what makes old ids stale
+    ++generations_[_entity.index];
+    freeIndices_.push_back(_entity.index);
+    --entityCount_;
+  }
+
+  bool Registry::IsAlive(EntityId _entity) const
+  {
+    return _entity.index < generations_.size() and
+           generations_[_entity.index] == _entity.generation;
+  }
+
+  uint Registry::GetEntityCount() const
+  {
+    return entityCount_;
+  }
+}
@@ -0,0 +1,351 @@
+// file:    Registry.h
+// author:  Tristan Baskerville
+// brief:   Entity/component storage. Every component type lives in its own
+//          sparse set, a packed array of components next to a packed array
+//          of the entities that own them, so systems walk plain arrays.
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#pragma once
+
+#include <Interfaces/INoCopy.h>
+
+namespace triskerville::World
+{
+  struct EntityId
+  {
+    uint index{ InvalidIndex };
+    uint generation{ 0 };
+
+    static constexpr uint InvalidIndex = ~0u;
+
+    bool operator==(EntityId const& _other) const
+    {
+      return index == _other.index and generation == _other.generation;
+    }
+    bool operator!=(EntityId const& _other) const
+    {
+      return not (*this == _other);
+    }
+  };
+
+  //  tag for Registry::Each, skips entities with any of Ts
+  template <typename... Ts>
+  struct Exclude {};
+
+  /// Packed storage for one component type. The sparse array maps an entity
+  /// index to its position in the packed arrays, removing swaps the last
+  /// component into the hole so the arrays never have gaps.
+  ///
+  /// \author Tristan Baskerville
+  /// \date 4/13/2022
+  class ISparseSet : public virtual INoCopy
+  {
+  public:
+    virtual ~ISparseSet() = default;
+    virtual void Remove(uint _index) = 0;
+    bool Contains(uint _index) const;
+    uint GetSize() const;
+    //  entity indices, in the same order as the components
+    uint const* GetEntities() const;
+
+  protected:
+    static constexpr uint Absent = ~0u;
+
+    std::vector<uint> sparse_{};
+    std::vector<uint> dense_{};
+  };
+
+  template <typename T>
+  class SparseSet final : public ISparseSet
+  {
+  public:
+    template <typename... Args>
+    T& Emplace(uint _index, Args&&... _args);
+    void Remove(uint _index) override;
+
+    T& Get(uint _index);
+    T const& Get(uint _index) const;
+    T* GetComponents();
+    T const* GetComponents() const;
+
+  private:
+    std::vector<T> components_{};
+  };
+
+  /// Owns every entity and component of a scene. Entities are only an index
+  /// and a generation, so a destroyed entity's id goes stale instead of
+  /// pointing at whatever reuses its slot.
+  ///
+  /// \author Tristan Baskerville
+  /// \date 4/13/2022
+  class Registry : public virtual INoCopy
+  {
+  public:
+    EntityId Create();
+    //  removes every component of the entity, stale ids are ignored
+    void Destroy(EntityId _entity);
+    bool IsAlive(EntityId _entity) const;
+    uint GetEntityCount() const;
+
+    /// Adds a component, or replaces the one the entity already has. The
+    /// entity must be alive.
+    template <typename T, typename... Args>
+    T& Add(EntityId _entity, Args&&... _args);
+    //  the entity must be alive, not having the component is fine
+    template <typename T>
+    void Remove(EntityId _entity);
+
+    template <typename T>
+    bool Has(EntityId _entity) const;
+    //  the entity must be alive and have the component
+    template <typename T>
+    T& Get(EntityId _entity);
+    template <typename T>
+    T const& Get(EntityId _entity) const;
+    //  nullptr if the entity doesn't have the component
+    template <typename T>
+    T* TryGet(EntityId _entity);
+    template <typename T>
+    T const* TryGet(EntityId _entity) const;
+
+    /// Calls _fn(EntityId, Ts&...) for every entity with all of Ts. Walks the
+    /// smallest of the sets and looks the others up, so it's linear in the
+    /// rarest component. _fn may change components or destroy the entity it
+    /// was given, but must not add or remove components of Ts elsewhere.
+    template <typename... Ts, typename Fn>
+    void Each(Fn&& _fn);
+    template <typename... Ts, typename Fn>
+    void Each(Fn&& _fn) const;
+    /// Same as above, minus entities with any of Xs. Each excluded set is
+    /// found once per call rather than once per entity.
+    template <typename... Ts, typename... Xs, typename Fn>
+    void Each(Exclude<Xs...>, Fn&& _fn);
+    template <typename... Ts, typename... Xs, typename Fn>
+    void Each(Exclude<Xs...>, Fn&& _fn) const;
+
+  private:
+    template <typename T>
+    SparseSet<T>* findSet() const;
+    template <typename T>
+    SparseSet<T>& getSet();
+
+    template <typename... Ts, typename... Xs, typename Fn>
+    void each(Exclude<Xs...>, Fn&& _fn) const;
+
+    std::vector<uint> generations_{};
+    std::vector<uint> freeIndices_{};
+    uint entityCount_{ 0 };
+
+    std::unordered_map<std::type_index, UPointer<ISparseSet>> sets_{};
+  };
+}
+
+template <typename T>
+template <typename... Args>
+inline T& triskerville::World::SparseSet<T>::Emplace(
+  uint _index, Args&&... _args)
+{
+  if (_index >= sparse_.size())
+    sparse_.resize(_index + 1, Absent);
+
+  if (sparse_[_index] != Absent)
+  {
+    T& component = components_[sparse_[_index]];
+    component = T{ std::forward<Args>(_args)... };
+    return component;
+  }
+
+  sparse_[_index] = static_cast<uint>(dense_.size());
+  dense_.push_back(_index);
+  return components_.emplace_back(T{ std::forward<Args>(_args)... });
+}
+
+template <typename T>
+inline void triskerville::World::SparseSet<T>::Remove(uint _index)
+{
+  if (not Contains(_index)) return;
+
+  //  move the last component into the hole, then drop the last slot
+  uint position = sparse_[_index];
+  uint last = dense_.back();
+  if (position != dense_.size() - 1)
+  {
+    components_[position] = std::move(components_.back());
+    dense_[position] = last;
+    sparse_[last] = position;
+  }
+  components_.pop_back();
+  dense_.pop_back();
+  sparse_[_index] = Absent;
+}
+
+template <typename T>
+inline T& triskerville::World::SparseSet<T>::Get(uint _index)
+{
+  return components_[sparse_[_index]];
+}
+
+template <typename T>
+inline T const& triskerville::World::SparseSet<T>::Get(uint _index) const
+{
+  return components_[sparse_[_index]];
+}
+
+template <typename T>
+inline T* triskerville::World::SparseSet<T>::GetComponents()
+{
+  return components_.data();
+}
+
+template <typename T>
+inline T const* triskerville::World::SparseSet<T>::GetComponents() const
+{
+  return components_.data();
+}
+
+template <typename T, typename... Args>
+inline T& triskerville::World::Registry::Add(
+  EntityId _entity, Args&&... _args)
+{
+  assert(IsAlive(_entity) and "Add on a destroyed entity.");
+  return getSet<T>().Emplace(_entity.index, std::forward<Args>(_args)...);
+}
+
+template <typename T>
+inline void triskerville::World::Registry::Remove(EntityId _entity)
+{
+  assert(IsAlive(_entity) and "Remove on a destroyed entity.");
+  if (auto pSet = findSet<T>())
+    pSet->Remove(_entity.index);
+}
+
+template <typename T>
+inline bool triskerville::World::Registry::Has(EntityId _entity) const
+{
+  auto pSet = findSet<T>();
+  return pSet and IsAlive(_entity) and pSet->Contains(_entity.index);
+}
+
+template <typename T>
+inline T& triskerville::World::Registry::Get(EntityId _entity)
+{
+  assert(Has<T>(_entity) and "Get on an entity without the component.");
+  return findSet<T>()->Get(_entity.index);
+}
+
+template <typename T>
+inline T const& triskerville::World::Registry::Get(EntityId _entity) const
+{
+  assert(Has<T>(_entity) and "Get on an entity without the component.");
+  return findSet<T>()->Get(_entity.index);
+}
+
+template <typename T>
+inline T* triskerville::World::Registry::TryGet(EntityId _entity)
+{
+  return Has<T>(_entity) ? &findSet<T>()->Get(_entity.index) : nullptr;
+}
+
+template <typename T>
+inline T const* triskerville::World::Registry::TryGet(EntityId _entity) const
+{
+  return Has<T>(_entity) ? &findSet<T>()->Get(_entity.index) : nullptr;
+}
+
+template <typename... Ts, typename Fn>
+inline void triskerville::World::Registry::Each(Fn&& _fn)
+{
+  each<Ts...>(Exclude<>{}, std::forward<Fn>(_fn));
+}
+
+template <typename... Ts, typename Fn>
+inline void triskerville::World::Registry::Each(Fn&& _fn) const
+{
+  each<Ts const...>(Exclude<>{}, std::forward<Fn>(_fn));
+}
+
+template <typename... Ts, typename... Xs, typename Fn>
+inline void triskerville::World::Registry::Each(
+  Exclude<Xs...> _exclude, Fn&& _fn)
+{
+  each<Ts...>(_exclude, std::forward<Fn>(_fn));
+}
+
+template <typename... Ts, typename... Xs, typename Fn>
+inline void triskerville::World::Registry::Each(
+  Exclude<Xs...> _exclude, Fn&& _fn) const
+{
+  each<Ts const...>(_exclude, std::forward<Fn>(_fn));
+}
+
+template <typename T>
+inline auto triskerville::World::Registry::findSet() const -> SparseSet<T>*
+{
+  auto it = sets_.find(typeid(std::remove_const_t<T>));
+  if (it == sets_.end()) return nullptr;
+  return static_cast<SparseSet<T>*>(it->second.get());
+}
+
+template <typename T>
+inline auto triskerville::World::Registry::getSet() -> SparseSet<T>&
+{
+  auto& pSet = sets_[typeid(T)];
+  if (not pSet)
+    pSet = std::make_unique<SparseSet<T>>();
+  return static_cast<SparseSet<T>&>(*pSet);
+}
+
+template <typename... Ts, typename... Xs, typename Fn>
+inline void triskerville::World::Registry::each(
+  Exclude<Xs...>, Fn&& _fn) const
+{
+  static_assert(sizeof...(Ts) > 0, "Each needs at least one component.");
+
+  //  sets are looked up once, not once per entity
+  std::tuple<SparseSet<std::remove_const_t<Ts>>*...> sets{
+    findSet<std::remove_const_t<Ts>>()... };
+  bool isMissing = false;
+  ISparseSet const* pSmallest = nullptr;
+  std::apply([&](auto*... _pSets)
+    {
+      for (ISparseSet const* pSet : { static_cast<ISparseSet const*>(_pSets)... })
+      {
+        if (not pSet)
+          isMissing = true;
+        else if (not pSmallest or pSet->GetSize() < pSmallest->GetSize())
+          pSmallest = pSet;
+      }
+    }, sets);
+  //  nobody has ever had one of the components
+  if (isMissing) return;
+
+  //  a set nobody has used yet excludes nothing
+  std::array<ISparseSet const*, sizeof...(Xs)> excluded{ findSet<Xs>()... };
+
+  //  walked backwards, destroying the current entity swaps in one we've
+  //  already visited instead of one we haven't
+  uint const* pEntities = pSmallest->GetEntities();
+  for (uint i = pSmallest->GetSize(); i-- > 0;)
+  {
+    uint index = pEntities[i];
+    bool hasAll = std::apply([index](auto*... _pSets)
+      {
+        return (_pSets->Contains(index) and ...);
+      }, sets);
+    if (not hasAll) continue;
+
+    bool isExcluded = std::any_of(excluded.begin(), excluded.end(),
+      [index](ISparseSet const* _pSet)
+      {
+        return _pSet and _pSet->Contains(index);
+      });
+    if (isExcluded) continue;
+
+    EntityId entity{ index, generations_[index] };
+    std::apply([&](auto*... _pSets)
+      {
+        _fn(entity, static_cast<Ts&>(_pSets->Get(index))...);
+      }, sets);
+  }
+}
@@ -10,11 +10,29 @@
 
 namespace triskerville::World
 {
-  glm::mat4 Transform::GetMatrix() const
+  //  shared by every transform, so no two changes ever get the same version
+  static std::atomic<std::uint64_t> versionCounter{ 0 };
+
+  glm::mat4 const& Transform::GetMatrix() const
+  {
+    if (dirty_ & MatrixDirty)
+    {
+      matrix_ = glm::translate(glm::mat4(1.0f), translation_) *
+                glm::scale(glm::mat4(1.0f), scale_) *
+                glm::mat4_cast(GetQuaternion());
+      dirty_ &= ~MatrixDirty;
+    }
+    return matrix_;
+  }
+
+  glm::quat const& Transform::GetQuaternion() const
   {
-    return glm::translate(glm::mat4(1.0f), translation_) *
-           glm::scale(glm::mat4(1.0f), scale_) *
-           glm::mat4_cast(glm::quat(glm::radians(rotation_)));
+    if (dirty_ & QuaternionDirty)
+    {
+      quaternion_ = glm::quat(glm::radians(rotation_));
+      dirty_ &= ~QuaternionDirty;
+    }
+    return quaternion_;
   }
 
   glm::vec3 Transform::GetTranslation() const
@@ -34,53 +52,86 @@ namespace triskerville::World
 
   glm::vec3 Transform::GetForward() const 
   {
-    // TODO (Tristan): This is in the wrong direction
-    return glm::normalize(glm::quat(glm::radians(rotation_)) * glm::vec3(0.f, 0.f, 11.f));
+    if (dirty_ & BasisDirty)
+    {
+      auto const& quaternion = GetQuaternion();
+      // TODO (Tristan): This is in the wrong direction
+      forward_ = glm::normalize(quaternion * glm::vec3(0.f, 0.f, 11.f));
+      up_ = glm::normalize(quaternion * glm::vec3(0.f, 1.f, 0.f));
+      right_ = glm::normalize(quaternion * glm::vec3(1.f, 0.f, 0.f));
+      dirty_ &= ~BasisDirty;
+    }
+    return forward_;
   }
 
   glm::vec3 Transform::GetUp() const 
   {
-    return glm::normalize(glm::quat(glm::radians(rotation_)) * glm::vec3(0.f, 1.f, 0.f));
+    //  all three basis vectors are refreshed together
+    GetForward();
+    return up_;
   }
 
   glm::vec3 Transform::GetRight() const 
   {
-    return glm::normalize(glm::quat(glm::radians(rotation_)) * glm::vec3(1.f, 0.f, 0.f));
+    GetForward();
+    return right_;
   }
 
   void Transform::SetTranslation(glm::vec3 const& _translation)
   {
+    if (translation_ == _translation) return;
+
     translation_ = _translation;
+    onChanged(MatrixDirty);
   }
 
   void Transform::SetScale(glm::vec3 const& _scale)
   {
+    if (scale_ == _scale) return;
+
     scale_ = _scale;
+    onChanged(MatrixDirty);
   }
 
   void Transform::SetRotation(glm::vec3 const& _rotation)
   {
+    if (rotation_ == _rotation) return;
+
     rotation_ = _rotation;
+    onChanged(AllDirty);
+  }
+
+  std::uint64_t Transform::GetVersion() const
+  {
+    return version_;
+  }
+
+  void Transform::onChanged(byte _dirty)
+  {
+    dirty_ |= _dirty;
+    version_ = versionCounter.fetch_add(1, std::memory_order_relaxed) + 1;
+
+    if (ChangedDelegate) ChangedDelegate(*this);
   }
 
   auto Transform::Builder::WithTranslation(glm::vec3 const& _translation) 
     -> Builder&
   {
-    instance_.translation_ = _translation;
+    instance_.SetTranslation(_translation);
 
     return *this;
   }
 
   auto Transform::Builder::WithScale(glm::vec3 const& _scale) -> Builder&
   {
-    instance_.scale_ = _scale;
+    instance_.SetScale(_scale);
 
     return *this;
   }
 
   auto Transform::Builder::WithRotation(glm::vec3 const& _rotation) -> Builder&
   {
-    instance_.rotation_ = _rotation;
+    instance_.SetRotation(_rotation);
 
     return *this;
   }
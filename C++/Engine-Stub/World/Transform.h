@@ -7,14 +7,27 @@
 #pragma once
 
 #include <Interfaces/IBuilder.h>
+#include <Core/InlineDelegate.h>
 
 namespace triskerville::World
 {
+  /// Translation, scale and Euler rotation. The matrix, quaternion and basis
+  /// vectors are derived lazily and cached until the next change, so a
+  /// transform that doesn't move costs nothing to read.
+  ///
+  /// Reading fills the caches, so two threads must not read the same
+  /// transform at the same time unless it has already been read once
+  /// since its last change.
   class Transform
   {
   public:
     class Builder;
-    glm::mat4 GetMatrix() const;
+
+    //  called after every change that bumps the version
+    InlineDelegate<void(Transform const&)> ChangedDelegate{};
+
+    glm::mat4 const& GetMatrix() const;
+    glm::quat const& GetQuaternion() const;
     glm::vec3 GetTranslation() const;
     glm::vec3 GetScale() const;
     glm::vec3 GetRotation() const;
@@ -24,10 +37,32 @@ namespace triskerville::World
     void SetTranslation(glm::vec3 const&);
     void SetScale(glm::vec3 const&);
     void SetRotation(glm::vec3 const&);
+
+    /// Changes whenever the transform does, setting the same value again
+    /// doesn't count. Versions are unique across every transform, so a
+    /// version seen before always means the exact same values.
+    std::uint64_t GetVersion() const;
+
   private:
+    enum DirtyFlags : byte
+    {
+      MatrixDirty     = 1 << 0,
+      QuaternionDirty = 1 << 1,
+      BasisDirty      = 1 << 2,
+      AllDirty        = MatrixDirty | QuaternionDirty | BasisDirty
+    };
+
+    void onChanged(byte _dirty);
+
     glm::vec3 translation_{};
     glm::vec3 scale_{ 1.f };
     glm::vec3 rotation_{};
+    std::uint64_t version_{ 0 };
+
+    mutable byte dirty_{ AllDirty };
+    mutable glm::quat quaternion_{};
+    mutable glm::mat4 matrix_{};
+    mutable glm::vec3 forward_{}, up_{}, right_{};
   };
 
   class Transform::Builder : public IBuilder<Transform>
@@ -0,0 +1,343 @@
+// file:    TransformSystem.cpp
+// author:  Tristan Baskerville
+// brief:   
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#include <stdafx.h>
+#include <World/TransformSystem.h>
+
+#if defined(__SSE2__) or defined(_M_X64) or \
+    (defined(_M_IX86_FP) and _M_IX86_FP >= 2)
+  #define TRISKERVILLE_TRANSFORM_SSE
+  #include <emmintrin.h>
+#endif
+
+namespace triskerville::World
+{
+  TransformId TransformSystem::Create(glm::vec3 const& _translation,
+                                      glm::quat const& _rotation,
+                                      glm::vec3 const& _scale,
+                                      TransformId _parent)
+  {
+    //  checked up front, a new transform has no children so a live parent
+    //  can't make a loop
+    if (_parent != Root and not IsAlive(_parent)) return Root;
+
+    uint index;
+    if (not freeTransforms_.empty())
+    {
+      index = freeTransforms_.back();
+      freeTransforms_.pop_back();
+    }
+    else
+    {
+      index = static_cast<uint>(parents_.size());
+
+      //  grow a whole batch at a time, padding holds the identity
+      size_t size = (index / BatchWidth + 1) * BatchWidth;
+      if (translationX_.size() < size)
+      {
+        for (auto* pArray : { &translationX_, &translationY_, &translationZ_,
+                              &rotationX_, &rotationY_, &rotationZ_ })
+          pArray->resize(size, 0.f);
+        for (auto* pArray : { &rotationW_, &scaleX_, &scaleY_, &scaleZ_ })
+          pArray->resize(size, 1.f);
+        isLocalDirty_.resize(size, 0);
+        localMatrices_.resize(size, glm::mat4(1.f));
+      }
+
+      parents_.push_back(NoParent);
+      generations_.push_back(0);
+      isAlive_.push_back(0);
+      isWorldDirty_.push_back(0);
+      worldMatrices_.emplace_back(1.f);
+    }
+
+    isAlive_[index] = 1;
+    parents_[index] = _parent.index;
+    TransformId transform{ index, generations_[index] };
+    SetTranslation(transform, _translation);
+    SetRotation(transform, _rotation);
+    SetScale(transform, _scale);
+    ++count_;
+    isOrderDirty_ = true;
+    return transform;
+  }
+
+  void TransformSystem::Destroy(TransformId _transform)
+  {
+    if (not IsAlive(_transform)) return;
+
+    uint index = _transform.index;
+    for (uint child = 0; child < parents_.size(); ++child)
+      if (parents_[child] == index)
+      {
+        parents_[child] = NoParent;
+        markDirty(child);
+      }
+
+    //  bumping the generation is what makes old ids stale
+    ++generations_[index];
+    isAlive_[index] = 0;
+    isLocalDirty_[index] = 0;
+    parents_[index] = NoParent;
+    freeTransforms_.push_back(index);
+    --count_;
+    isOrderDirty_ = true;
+  }
+
+  bool TransformSystem::IsAlive(TransformId _transform) const
+  {
+    return _transform.index < isAlive_.size() and
+           isAlive_[_transform.index] and
+           generations_[_transform.index] == _transform.generation;
+  }
+
+  EResult TransformSystem::SetParent(TransformId _transform,
+                                     TransformId _parent)
+  {
+    if (not IsAlive(_transform)) return EResult::Failure;
+    if (_parent != Root)
+    {
+      if (not IsAlive(_parent)) return EResult::Failure;
+
+      //  parenting to our own subtree would make a loop
+      for (uint ancestor = _parent.index; ancestor != NoParent;
+           ancestor = parents_[ancestor])
+        if (ancestor == _transform.index) return EResult::Failure;
+    }
+
+    parents_[_transform.index] = _parent.index;
+    markDirty(_transform.index);
+    isOrderDirty_ = true;
+    return EResult::Success;
+  }
+
+  TransformId TransformSystem::GetParent(TransformId _transform) const
+  {
+    uint parent = parents_[indexOf(_transform)];
+    if (parent == NoParent) return Root;
+    return { parent, generations_[parent] };
+  }
+
+  void TransformSystem::SetTranslation(TransformId _transform,
+                                       glm::vec3 const& _translation)
+  {
+    uint index = indexOf(_transform);
+    translationX_[index] = _translation.x;
+    translationY_[index] = _translation.y;
+    translationZ_[index] = _translation.z;
+    markDirty(index);
+  }
+
+  void TransformSystem::SetScale(TransformId _transform,
+                                 glm::vec3 const& _scale)
+  {
+    uint index = indexOf(_transform);
+    scaleX_[index] = _scale.x;
+    scaleY_[index] = _scale.y;
+    scaleZ_[index] = _scale.z;
+    markDirty(index);
+  }
+
+  void TransformSystem::SetRotation(TransformId _transform,
+                                    glm::quat const& _rotation)
+  {
+    uint index = indexOf(_transform);
+    rotationX_[index] = _rotation.x;
+    rotationY_[index] = _rotation.y;
+    rotationZ_[index] = _rotation.z;
+    rotationW_[index] = _rotation.w;
+    markDirty(index);
+  }
+
+  void TransformSystem::SetRotation(TransformId _transform,
+                                    glm::vec3 const& _rotation)
+  {
+    SetRotation(_transform, glm::quat(glm::radians(_rotation)));
+  }
+
+  glm::vec3 TransformSystem::GetTranslation(TransformId _transform) const
+  {
+    uint index = indexOf(_transform);
+    return { translationX_[index], translationY_[index],
+             translationZ_[index] };
+  }
+
+  glm::vec3 TransformSystem::GetScale(TransformId _transform) const
+  {
+    uint index = indexOf(_transform);
+    return { scaleX_[index], scaleY_[index], scaleZ_[index] };
+  }
+
+  glm::quat TransformSystem::GetRotation(TransformId _transform) const
+  {
+    uint index = indexOf(_transform);
+    return { rotationW_[index], rotationX_[index],
+             rotationY_[index], rotationZ_[index] };
+  }
+
+  glm::mat4 const& TransformSystem::GetLocalMatrix(
+    TransformId _transform) const
+  {
+    return localMatrices_[indexOf(_transform)];
+  }
+
+  glm::mat4 const& TransformSystem::GetWorldMatrix(
+    TransformId _transform) const
+  {
+    return worldMatrices_[indexOf(_transform)];
+  }
+
+  void TransformSystem::Update()
+  {
+    //  local matrices don't depend on each other, build any batch with a
+    //  dirty transform in it
+    for (uint first = 0; first < isLocalDirty_.size(); first += BatchWidth)
+    {
+      std::uint32_t isBatchDirty;
+      std::memcpy(&isBatchDirty, &isLocalDirty_[first], sizeof(isBatchDirty));
+      if (isBatchDirty) buildLocalMatrices(first);
+    }
+
+    if (isOrderDirty_) sortByDepth();
+
+    //  parents come first, so a parent's world matrix and dirty flag are
+    //  final by the time its children look at them
+    for (uint transform : order_)
+    {
+      uint parent = parents_[transform];
+      bool isDirty = isLocalDirty_[transform] or
+                     (parent != NoParent and isWorldDirty_[parent]);
+      isWorldDirty_[transform] = isDirty;
+      if (not isDirty) continue;
+
+      worldMatrices_[transform] = (parent == NoParent)
+        ? localMatrices_[transform]
+        : worldMatrices_[parent] * localMatrices_[transform];
+    }
+
+    std::fill(isLocalDirty_.begin(), isLocalDirty_.end(), byte{ 0 });
+  }
+
+  uint TransformSystem::GetCount() const
+  {
+    return count_;
+  }
+
+  uint TransformSystem::indexOf(TransformId _transform) const
+  {
+    assert(IsAlive(_transform) and "Transform id is stale.");
+    return _transform.index;
+  }
+
+  void TransformSystem::markDirty(uint _index)
+  {
+    isLocalDirty_[_index] = 1;
+  }
+
+  void TransformSystem::sortByDepth()
+  {
+    std::vector<uint> depths(parents_.size(), 0);
+    order_.clear();
+    for (uint transform = 0; transform < parents_.size(); ++transform)
+    {
+      if (not isAlive_[transform]) continue;
+
+      uint depth = 0;
+      for (uint ancestor = parents_[transform]; ancestor != NoParent;
+           ancestor = parents_[ancestor])
+        ++depth;
+      depths[transform] = depth;
+      order_.push_back(transform);
+    }
+
+    //  stable, so siblings keep walking memory in order
+    std::stable_sort(order_.begin(), order_.end(),
+      [&depths](uint _lhs, uint _rhs) { return depths[_lhs] < depths[_rhs]; });
+    isOrderDirty_ = false;
+  }
+
+#if defined(TRISKERVILLE_TRANSFORM_SSE)
+  void TransformSystem::buildLocalMatrices(uint _first)
+  {
+    __m128 x = _mm_loadu_ps(&rotationX_[_first]);
+    __m128 y = _mm_loadu_ps(&rotationY_[_first]);
+    __m128 z = _mm_loadu_ps(&rotationZ_[_first]);
+    __m128 w = _mm_loadu_ps(&rotationW_[_first]);
+    __m128 one = _mm_set1_ps(1.f);
+    __m128 two = _mm_set1_ps(2.f);
+
+    __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+    __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+    __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+    //  rotation matrix from the quaternion, the same terms as glm::mat4_cast
+    __m128 columns[3][3] =
+    {
+      { _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))),
+        _mm_mul_ps(two, _mm_add_ps(xy, wz)),
+        _mm_mul_ps(two, _mm_sub_ps(xz, wy)) },
+      { _mm_mul_ps(two, _mm_sub_ps(xy, wz)),
+        _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))),
+        _mm_mul_ps(two, _mm_add_ps(yz, wx)) },
+      { _mm_mul_ps(two, _mm_add_ps(xz, wy)),
+        _mm_mul_ps(two, _mm_sub_ps(yz, wx)),
+        _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))) }
+    };
+
+    //  scale is applied after the rotation, so it scales rows
+    __m128 scales[3] =
+    {
+      _mm_loadu_ps(&scaleX_[_first]),
+      _mm_loadu_ps(&scaleY_[_first]),
+      _mm_loadu_ps(&scaleZ_[_first])
+    };
+    __m128 zero = _mm_setzero_ps();
+    for (uint column = 0; column < 3; ++column)
+    {
+      __m128 r0 = _mm_mul_ps(columns[column][0], scales[0]);
+      __m128 r1 = _mm_mul_ps(columns[column][1], scales[1]);
+      __m128 r2 = _mm_mul_ps(columns[column][2], scales[2]);
+      __m128 r3 = zero;
+      //  one register per row across four transforms, becomes one column
+      //  per transform
+      _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+      _mm_storeu_ps(&localMatrices_[_first + 0][column][0], r0);
+      _mm_storeu_ps(&localMatrices_[_first + 1][column][0], r1);
+      _mm_storeu_ps(&localMatrices_[_first + 2][column][0], r2);
+      _mm_storeu_ps(&localMatrices_[_first + 3][column][0], r3);
+    }
+
+    __m128 t0 = _mm_loadu_ps(&translationX_[_first]);
+    __m128 t1 = _mm_loadu_ps(&translationY_[_first]);
+    __m128 t2 = _mm_loadu_ps(&translationZ_[_first]);
+    __m128 t3 = one;
+    _MM_TRANSPOSE4_PS(t0, t1, t2, t3);
+    _mm_storeu_ps(&localMatrices_[_first + 0][3][0], t0);
+    _mm_storeu_ps(&localMatrices_[_first + 1][3][0], t1);
+    _mm_storeu_ps(&localMatrices_[_first + 2][3][0], t2);
+    _mm_storeu_ps(&localMatrices_[_first + 3][3][0], t3);
+  }
+#else
+  void TransformSystem::buildLocalMatrices(uint _first)
+  {
+    for (uint transform = _first; transform < _first + BatchWidth; ++transform)
+    {
+      //  padding isn't alive, read the arrays rather than the getters
+      glm::vec3 translation{ translationX_[transform],
+                             translationY_[transform],
+                             translationZ_[transform] };
+      glm::vec3 scale{ scaleX_[transform], scaleY_[transform],
+                       scaleZ_[transform] };
+      glm::quat rotation{ rotationW_[transform], rotationX_[transform],
+                          rotationY_[transform], rotationZ_[transform] };
+      localMatrices_[transform] =
+        glm::translate(glm::mat4(1.f), translation) *
+        glm::scale(glm::mat4(1.f), scale) *
+        glm::mat4_cast(rotation);
+    }
+  }
+#endif
+}
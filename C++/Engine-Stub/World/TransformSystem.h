@@ -0,0 +1,120 @@
+// file:    TransformSystem.h
+// author:  Tristan Baskerville
+// brief:   Transform hierarchy stored as structure-of-arrays. Translations,
+//          rotations and scales live in separate float arrays so local
+//          matrices are built four at a time with SSE, and only transforms
+//          that changed, or whose parent changed, are recomputed.
+//
+// Copyright © 2021 DigiPen, All rights reserved.
+
+#pragma once
+
+#include <Interfaces/INoCopy.h>
+#include <Core/EResult.h>
+
+namespace triskerville::World
+{
+  //  same scheme as EntityId, a destroyed transform's id goes stale
+  struct TransformId
+  {
+    uint index{ InvalidIndex };
+    uint generation{ 0 };
+
+    static constexpr uint InvalidIndex = ~0u;
+
+    bool operator==(TransformId const& _other) const
+    {
+      return index == _other.index and generation == _other.generation;
+    }
+    bool operator!=(TransformId const& _other) const
+    {
+      return not (*this == _other);
+    }
+  };
+
+  /// Owns every transform of a scene that opts into batched updates.
+  /// Setters only write the arrays and mark the transform dirty, Update()
+  /// brings every world matrix up to date in one pass, parents first.
+  ///
+  /// Matrices are built the same way as Transform::GetMatrix, that is
+  /// translate * scale * rotate, and a child's world matrix is its parent's
+  /// world matrix times its own local one.
+  ///
+  /// Ids must be alive everywhere but IsAlive, Destroy and SetParent.
+  ///
+  /// \author Tristan Baskerville
+  /// \date 4/20/2022
+  class TransformSystem : public virtual INoCopy
+  {
+  public:
+    //  no parent, never alive
+    static constexpr TransformId Root{};
+    //  transforms built per SIMD batch
+    static constexpr uint BatchWidth = 4;
+
+    /// \returns  Root if _parent isn't alive, nothing is created then.
+    TransformId Create(
+      glm::vec3 const& _translation = glm::vec3(0.f),
+      glm::quat const& _rotation = glm::quat(1.f, 0.f, 0.f, 0.f),
+      glm::vec3 const& _scale = glm::vec3(1.f),
+      TransformId _parent = Root);
+    //  children are moved to the root, keeping their local transform. stale
+    //  ids are ignored
+    void Destroy(TransformId _transform);
+    bool IsAlive(TransformId _transform) const;
+
+    /// \returns  Failure if either id is stale, or _parent is _transform or
+    ///           one of its children.
+    EResult SetParent(TransformId _transform, TransformId _parent);
+    TransformId GetParent(TransformId _transform) const;
+
+    void SetTranslation(TransformId _transform, glm::vec3 const&);
+    void SetScale(TransformId _transform, glm::vec3 const&);
+    void SetRotation(TransformId _transform, glm::quat const&);
+    //  Euler angles in degrees, the same as Transform::SetRotation
+    void SetRotation(TransformId _transform, glm::vec3 const&);
+
+    glm::vec3 GetTranslation(TransformId _transform) const;
+    glm::vec3 GetScale(TransformId _transform) const;
+    glm::quat GetRotation(TransformId _transform) const;
+
+    //  only up to date after Update()
+    glm::mat4 const& GetLocalMatrix(TransformId _transform) const;
+    glm::mat4 const& GetWorldMatrix(TransformId _transform) const;
+
+    void Update();
+
+    uint GetCount() const;
+
+  private:
+    static constexpr uint NoParent = TransformId::InvalidIndex;
+
+    //  asserts the id is alive
+    uint indexOf(TransformId _transform) const;
+    void markDirty(uint _index);
+    void sortByDepth();
+    void buildLocalMatrices(uint _first);
+
+    //  structure-of-arrays, padded to a multiple of BatchWidth so the last
+    //  batch never reads past the end
+    std::vector<float> translationX_{}, translationY_{}, translationZ_{};
+    std::vector<float> rotationX_{}, rotationY_{}, rotationZ_{}, rotationW_{};
+    std::vector<float> scaleX_{}, scaleY_{}, scaleZ_{};
+
+    std::vector<uint> parents_{};
+    std::vector<uint> generations_{};
+    std::vector<byte> isAlive_{};
+    std::vector<byte> isLocalDirty_{};
+    std::vector<byte> isWorldDirty_{};
+    std::vector<uint> freeTransforms_{};
+
+    std::vector<glm::mat4> localMatrices_{};
+    std::vector<glm::mat4> worldMatrices_{};
+
+    //  live transforms, parents before children. rebuilt only when the
+    //  hierarchy changes
+    std::vector<uint> order_{};
+    bool isOrderDirty_{ false };
+    uint count_{ 0 };
+  };
+}
@@ -7,9 +7,12 @@
 #include <stdafx.h>
 
 #include <Application/Application.h>
+#include <Services/JobService.h>
 #include <Services/MessageService.h>
 #include <Services/WindowService.h>
-#include <Services/GUIService.h>
+#if !defined(TRISKERVILLE_HEADLESS)
+  #include <Services/GUIService.h>
+#endif
 #include <Services/RenderingService.h>
 #include <Services/SceneLogic.h>
 
@@ -18,11 +21,16 @@ int main(void)
   using namespace triskerville;
   //  build our application with our desired setup
   Application app = Application::Builder{}
+    .InstallService<JobService>()
     .InstallService<MessageService>()
     .InstallService<WindowService>()
+#if !defined(TRISKERVILLE_HEADLESS)
+    //  the editor needs a real window, headless builds go without
     .InstallService<GUIService>()
+#endif
     .InstallService<RenderingService>()
     .InstallService<SceneLogic>()
+    .WithProfileOutput("triskerville_profile")
     .Build();
   //  start running our application. returns at end of application
   app.Run();
@@ -9,7 +9,9 @@
 
 //  Windows.h defines a macro also found in glfw3.h. due to Windows.h not
 //  having a redefinition guard, it must be included before glfw3.h
-#include <Windows.h>
+#if defined(_WIN32)
+  #include <Windows.h>
+#endif
 
 //>=--- STL Includes ---=<//
 #include <iostream>
@@ -33,6 +35,15 @@
 #include <regex>
 #include <tuple>
 #include <random>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
 
 //>=--- Third Party Includes ---=<//
 #include <fmod/fmod.h>
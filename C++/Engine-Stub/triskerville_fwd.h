@@ -12,8 +12,13 @@ namespace triskerville
   class MessageBus;
 
   class IService;
+  class ThreadPool;
+  class ServiceScheduler;
+  class JobCounter;
+  class JobSystem;
   template <class... T> class IDependencyList;
 
+  class JobService;
   class MessageService;
   class WindowService;
   class GUIService;
@@ -26,9 +31,25 @@ namespace triskerville
     struct Quad3D;
   }
 
+  namespace Graphics
+  {
+    class Mesh;
+    class Shader;
+    class Cubemap;
+    class Texture2D;
+    class Framebuffer;
+    class InstanceBuffer;
+  }
+
   namespace World
   {
     class Entity;
     class Camera;
+    class LocalLight;
+    class Transform;
+    class Registry;
+    class TransformSystem;
+    struct EntityId;
+    struct TransformId;
   }
 }